@@ -17,6 +17,8 @@
 
 #include <metameric/core/fwd.hpp>
 #include <metameric/core/utility.hpp>
+#include <metameric/core/locate.hpp>
+#include <vector>
 
 namespace met {
   // Convex hull helper structure, as we typically need to build both
@@ -31,6 +33,9 @@ namespace met {
     hull_type hull;
     deln_type deln;
 
+    // Point-location structure over deln, rebuilt alongside it
+    TetrahedronLocator locator;
+
     // Data queries for hull data, available per-vertex
     bool has_hull()     const { return !hull.empty(); }
     bool has_delaunay() const { return !deln.empty(); }
@@ -54,8 +59,59 @@ namespace met {
   public: // Helper methods for searching or employing the convex hull
     // Find the best enclosing element in the underlying delaunay structure
     std::pair<eig::Array4f, eig::Array4u> find_enclosing_elem(const Vt &v) const;
+    
+    // Batched variant of find_enclosing_elem(), for many points at once
+    std::vector<std::pair<eig::Array4f, eig::Array4u>> find_enclosing_elem(std::span<const Vt> v) const;
 
     // Clip a exterior point to the closest surface in the underlying convex hull
     Vt find_closest_interior(const Vt &v) const;
   };
+
+  // Convex hull helper structure that is built incrementally, as points are added over time.
+  // Following the beneath-beyond method, each new point is connected to the hull facets it sees,
+  // and the resulting cone of tetrahedra is appended to the interior tesselation; existing
+  // tetrahedra are never modified. Points within the current hull are rejected, by a walk through
+  // the tesselation. The hull and tesselation stay available through the ConvexHullBase members;
+  // deln.verts holds all inserted points, including rejected ones, in order of insertion.
+  template <typename Vt> 
+  class IncrementalConvexHullBase : public ConvexHullBase<Vt> {
+    // Hull facet; vertex indices are ordered s.t. the normal points outwards
+    struct Facet {
+      eig::Array3u      elem;         // Vertex indices
+      eig::Array3u      adjc;         // Adjacent facets, across edges (elem[i], elem[i + 1])
+      uint              tetr;         // Interior tetrahedron on which this facet lies
+      eig::Vector3d     n;            // Plane normal
+      double            d;            // Plane offset
+      std::vector<uint> conflicts;    // Points awaiting insertion which this facet sees
+      bool              is_alive;     // Facet is part of the current hull
+    };
+
+    std::vector<eig::Vector3d> m_verts;     // Inserted points, in double precision
+    std::vector<Facet>         m_facets;    // All facets ever created; dead ones are not reused
+    std::vector<eig::Array4i>  m_adjc;      // Per tetrahedron, adjacent tetrahedron opposite vertex i, or ~facet on hull
+    std::vector<uint>          m_marks;     // Per facet, scratch marks for visibility search
+    uint                       m_mark  = 0; // Current mark value
+    uint                       m_last  = 0; // Last created tetrahedron, as a starting point for walks
+    double                     m_eps   = 0; // Tolerance for visibility tests, scaled to input
+    
+    // Build the initial simplex from the given points; returns false if they are degenerate
+    bool init_simplex(std::span<const uint> points);
+
+    // Find a hull facet visible from the given point, or return -1 if the point is inside
+    int find_visible_facet(const eig::Vector3d &p) const;
+
+    // Insert the given point into the hull, given a facet that it sees; outputs points whose
+    // conflicts must be reassigned, or returns false if the point was rejected as degenerate
+    bool insert_point(uint i, uint facet_i, std::vector<uint> &orphans);
+
+    // Regenerate the exposed hull mesh from live facets
+    void update_hull();
+
+  public:
+    IncrementalConvexHullBase() = default;
+    IncrementalConvexHullBase(std::span<const Vt> data) { insert(data); }
+
+    // Insert a set of points into the hull, in randomized order
+    void insert(std::span<const Vt> data);
+  };
 } // namespace met
\ No newline at end of file
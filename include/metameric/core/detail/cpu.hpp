@@ -0,0 +1,24 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <metameric/core/fwd.hpp>
+
+namespace met::detail {
+  // Query cpu support for AVX2 and FMA, including os support for saving ymm registers; used to
+  // decide whether to call into kernels from translation units compiled with MET_AVX2_OPTIONS
+  bool cpu_supports_avx2();
+} // namespace met::detail
\ No newline at end of file
@@ -0,0 +1,163 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <metameric/core/solver.hpp>
+#include <metameric/core/spectrum.hpp>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Statically typed solver functions used by metamer.cpp, exposed here s.t. tests can evaluate 
+// them directly
+namespace met::detail {
+  // Precomputed blocks for the spectral boundary constraint 0 <= Bx <= 1 over a basis; the float
+  // basis is the block's cache key, the double basis is read column-wise to evaluate Bx, and its
+  // transpose is written out as the constraint's Jacobian. Blocks are aligned for vector loads
+  template <uint Samples, uint Bases>
+  struct BoundaryBlock {
+    alignas(64) typename BasisBase<Samples, Bases>::mat_type B_f;
+    alignas(64) eig::Matrix<double, Samples, Bases>          B;
+    alignas(64) eig::Matrix<double, Bases, Samples>          Bt;
+  };
+
+  // Test whether BoundaryFunc can evaluate through the AVX2 kernel in metamer_avx2.cpp; the 
+  // kernel requires the nr. of samples to be a multiple of 16
+  bool boundary_supports_avx2(uint n_samples = wavelength_samples);
+
+  // Describes f(x) = [Bx - 1, -Bx] with corresponding gradient, i.e. spectral 0 <= Bx <= 1; 
+  // as both halves share Bx and mirror their Jacobian, Bx is evaluated once for a Samples x Bases
+  // instead of a 2*Samples x Bases product, through an AVX2 kernel if the cpu supports it
+  template <uint Samples, uint Bases>
+  struct BoundaryFunc {
+    std::shared_ptr<const BoundaryBlock<Samples, Bases>> block;
+    bool is_avx2 = boundary_supports_avx2(Samples);
+
+    // Evaluate value r and, if g is non-null, Jacobian g at x
+    void eval(double *r, const double *x, double *g) const;
+
+    void operator()(auto r, const auto &x, auto g) const {
+      eval(r.data(), x.data(), g.data());
+    }
+  };
+  template <uint Samples, uint Bases>
+  using BoundaryConstraint = opt::NqConstraintV<BoundaryFunc<Samples, Bases>>;
+
+  // Generate boundary inequality constraints, upholding spectral 0 <= x <= 1; blocks are cached
+  // per thread, as consecutive solves typically share a basis
+  template <uint Samples, uint Bases>
+  BoundaryConstraint<Samples, Bases> boundary_constraint(const BasisBase<Samples, Bases> &basis, double tol);
+
+  // Per-wavelength terms of a truncated power series sum_p A_p r^p, for M output rows
+  template <int M, uint Samples = wavelength_samples>
+  using PowerSeriesTerm = eig::Matrix<double, M, Samples>;
+
+  // Evaluate a truncated power series in r per wavelength through Horner's scheme, alongside 
+  // its derivative with respect to r; returns per-wavelength terms H, D. The series' value is 
+  // then H.rowwise().sum(), and its Jacobian with respect to basis coefficients is D * B
+  template <int M, uint Samples = wavelength_samples>
+  std::pair<PowerSeriesTerm<M, Samples>, PowerSeriesTerm<M, Samples>> 
+  eval_power_series(std::span<const std::type_identity_t<PowerSeriesTerm<M, Samples>>> A, 
+                    const std::type_identity_t<eig::Vector<double, Samples>>            &r) {
+    PowerSeriesTerm<M, Samples> H = A.back(), D = PowerSeriesTerm<M, Samples>::Zero();
+    for (int p = static_cast<int>(A.size()) - 2; p >= 0; --p) {
+      D = (D.array().rowwise() * r.transpose().array()).matrix() + H;
+      H = (H.array().rowwise() * r.transpose().array()).matrix() + A[p];
+    }
+    return { H, D };
+  }
+
+  // Describes f(x) = ||sum_p A_p (Bx)^p - b||, for indirect color system constraints,
+  // with corresponding gradient
+  template <uint Samples = wavelength_samples, uint Bases = wavelength_bases>
+  struct PowerSeriesNormFunc {
+    std::vector<PowerSeriesTerm<3, Samples>> A;
+    eig::Matrix<double, Samples, Bases>      B;
+    eig::Array<double, 3, 1>                 b;
+
+    double operator()(const auto &x, auto g) const {
+      auto [H, D] = eval_power_series<3, Samples>(A, B * x);
+      
+      // shorthands for y - b and ||(y - b)||
+      auto diff = (H.rowwise().sum().array() - b).matrix().eval();
+      auto norm = diff.norm();
+
+      // g(x) = (DB)^T * (y - b) / ||(y - b)||
+      if (g.data())
+        g = ((D * B).transpose() * (diff / norm)).eval();
+
+      // f(x) = ||(y - b)||
+      return norm;
+    }
+  };
+
+  // Describes f(x) = sum_p a_p . (Bx)^p, for indirect color system objectives,
+  // with corresponding gradient
+  template <uint Samples = wavelength_samples, uint Bases = wavelength_bases>
+  struct PowerSeriesDotFunc {
+    std::vector<PowerSeriesTerm<1, Samples>> A;
+    eig::Matrix<double, Samples, Bases>      B;
+
+    double operator()(const auto &x, auto g) const {
+      auto [H, D] = eval_power_series<1, Samples>(A, B * x);
+
+      // g(x) = (DB)^T
+      if (g.data())
+        g = (D * B).transpose();
+
+      // f(x) = y
+      return H.sum();
+    }
+  };
+
+  // Autodiff counterparts of the above; these are slow, but serve as an oracle
+  // for the hand-derived gradients in tests
+  inline auto ad_power_series_norm(const std::vector<PowerSeriesTerm<3>>                           &A,
+                                   const eig::Matrix<double, wavelength_samples, wavelength_bases> &B,
+                                   const eig::Array<double, 3, 1>                                  &b) {
+    using bvec = eig::Vector<ad::real1st, wavelength_bases>;
+    using svec = eig::Vector<ad::real1st, wavelength_samples>;
+    using cvec = eig::Vector<ad::real1st, 3>;
+    return ad::wrap_capture<wavelength_bases>([A, B, b](const bvec &x) {
+      svec r  = B * x;                                   // Compute full reflectance
+      svec rp = svec::Ones();                            // Power of reflectance
+      cvec Ax = A[0].rowwise().sum().cast<ad::real1st>(); // Nonlinear component, 0th part
+      for (uint i = 1; i < A.size(); ++i) {              // Nonlinear component, pth part
+        rp = rp.cwiseProduct(r);
+        Ax += A[i] * rp;
+      }
+      return (Ax.array() - b).matrix().norm();
+    });
+  }
+
+  inline auto ad_power_series_dot(const std::vector<PowerSeriesTerm<1>>                           &A,
+                                  const eig::Matrix<double, wavelength_samples, wavelength_bases> &B) {
+    using bvec = eig::Vector<ad::real1st, wavelength_bases>;
+    using svec = eig::Vector<ad::real1st, wavelength_samples>;
+    return ad::wrap_capture<wavelength_bases>([A, B](const bvec &x) {
+      svec r  = B * x;                      // Compute full reflectance
+      svec rp = svec::Ones();               // Power of reflectance
+      ad::real1st f = A[0].sum();           // Nonlinear objective, 0th part
+      for (uint i = 1; i < A.size(); ++i) { // Nonlinear objective, pth part
+        rp = rp.cwiseProduct(r);
+        f += A[i].transpose().dot(rp);
+      }
+      return f;
+    });
+  }
+} // namespace met::detail
\ No newline at end of file
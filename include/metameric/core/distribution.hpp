@@ -35,6 +35,8 @@ namespace met {
     }
 
   public:
+    using result_type = uint;
+
     // Construct the engine, optionally provide a seed
     constexpr PCGEngine(uint seed = 0)
     : m_state(seed) { }
@@ -35,14 +35,18 @@ namespace met {
   struct MeshBase;
   template <typename Vt> 
   struct ConvexHullBase;
+  template <typename Vt> 
+  class IncrementalConvexHullBase;
   
   // General mesh/delaunay/chull types used throughout the application
-  using Mesh         = MeshBase<eig::Array3f,   eig::Array3u>;
-  using AlMesh       = MeshBase<eig::AlArray3f, eig::Array3u>;
-  using Delaunay     = MeshBase<eig::Array3f,   eig::Array4u>;
-  using AlDelaunay   = MeshBase<eig::AlArray3f, eig::Array4u>;
-  using ConvexHull   = ConvexHullBase<eig::Array3f>;
-  using AlConvexHull = ConvexHullBase<eig::AlArray3f>;
+  using Mesh                    = MeshBase<eig::Array3f,   eig::Array3u>;
+  using AlMesh                  = MeshBase<eig::AlArray3f, eig::Array3u>;
+  using Delaunay                = MeshBase<eig::Array3f,   eig::Array4u>;
+  using AlDelaunay              = MeshBase<eig::AlArray3f, eig::Array4u>;
+  using ConvexHull              = ConvexHullBase<eig::Array3f>;
+  using AlConvexHull            = ConvexHullBase<eig::AlArray3f>;
+  using IncrementalConvexHull   = IncrementalConvexHullBase<eig::Array3f>;
+  using AlIncrementalConvexHull = IncrementalConvexHullBase<eig::AlArray3f>;
 
   // Uplifting constraint vertices
   struct LinearConstraint;
@@ -0,0 +1,86 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <metameric/core/fwd.hpp>
+#include <metameric/core/utility.hpp>
+#include <algorithm>
+#include <execution>
+#include <vector>
+
+namespace met {
+  // Point-location structure over a tetrahedral mesh, e.g. a Delaunay tesselation. Caches
+  // per-element barycentric inverse matrices and element adjacency; queries jump to a seed
+  // element from a uniform grid over element centroids, and then walk towards the query point
+  // across faces with negative barycentric weights. Points outside the mesh fall back
+  // to a linear scan for the closest element. Must be rebuilt whenever the mesh changes, unless
+  // elements are only appended, in which case append() updates the structure in place.
+  class TetrahedronLocator {
+    std::vector<eig::Matrix3f> m_inv;        // Per element, inverse of [a - d, b - d, c - d]
+    std::vector<eig::Vector3f> m_sub;        // Per element, vertex d
+    std::vector<eig::Array4i>  m_adjc;       // Per element, adjacent element opposite vertex i, or -1
+    std::vector<uint>          m_grid;       // Seed element per grid cell
+    eig::Array3u               m_grid_size;  // Nr. of grid cells along each axis
+    eig::Array3f               m_grid_minb;  // Grid origin
+    eig::Array3f               m_grid_scale; // Inverse grid cell size
+    uint                       m_grid_elems = 0; // Nr. of elements when the grid was last built
+
+    // Cache barycentric inverse matrices for elements [begin, end)
+    template <typename Vt>
+    void build_inv(const MeshBase<Vt, eig::Array4u> &mesh, uint begin);
+
+    // Build the uniform seed grid over all current elements
+    template <typename Vt>
+    void build_grid(const MeshBase<Vt, eig::Array4u> &mesh);
+
+    // Barycentric weights of p w.r.t. element i
+    eig::Array4f bary(uint i, const eig::Vector3f &p) const;
+
+    // Scan all elements for the best enclosing element, i.e. with the least 
+    // barycentric error; for exterior points, the closest element is found
+    std::pair<eig::Array4f, uint> scan(const eig::Vector3f &p) const;
+
+  public:
+    TetrahedronLocator() = default;
+    
+    template <typename Vt>
+    TetrahedronLocator(const MeshBase<Vt, eig::Array4u> &mesh);
+
+    // Update the structure after elements were appended to the mesh; existing elements must be
+    // unchanged, but their adjacency may be. The mesh's full adjacency is provided, with negative
+    // values on the boundary, and only appended elements and their neighbours are revisited.
+    // The seed grid is rebuilt once the nr. of elements has doubled since it was last built.
+    template <typename Vt>
+    void append(const MeshBase<Vt, eig::Array4u> &mesh, std::span<const eig::Array4i> adjc);
+
+    // Find the enclosing element for a point, returning barycentric weights and element index;
+    // for exterior points, the closest element is returned instead
+    std::pair<eig::Array4f, uint> locate(const eig::Vector3f &p) const;
+
+    // Batched variant of locate(); queries run in parallel
+    template <typename Vt>
+    std::vector<std::pair<eig::Array4f, uint>> locate(std::span<const Vt> p) const {
+      met_trace();
+      std::vector<std::pair<eig::Array4f, uint>> result(p.size());
+      std::transform(std::execution::par_unseq, range_iter(p), result.begin(), 
+        [&](const Vt &v) { return locate(v.matrix()); });
+      return result;
+    }
+
+    // Query whether the structure was built over a non-empty mesh
+    bool empty() const { return m_inv.empty(); }
+  };
+} // namespace met
\ No newline at end of file
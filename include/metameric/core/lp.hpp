@@ -0,0 +1,97 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <metameric/core/fwd.hpp>
+#include <metameric/core/utility.hpp>
+#include <vector>
+
+namespace met {
+  // Dense solver for linear programs of fixed dimension N over a fixed feasible set, of the form
+  //   minimize   c^T x
+  //   subject to C x == d
+  //              G x <= h
+  // The feasible set is prepared once on construction; the equality block is eliminated through
+  // a null-space basis, and a feasible starting point is found. Subsequent solves for different
+  // objectives c run a primal active-set (simplex-like) method in the reduced space, and can be
+  // warm-started from the active set of a prior solve, as that remains feasible for any c.
+  // Optionally, solves run in single precision first; the resulting active set is then snapped
+  // to and verified in double precision, and refined by a double-precision solve from there.
+  template <uint N>
+  class LPSolver {
+  public:
+    using vec  = eig::Vector<double, N>;
+    using cmat = eig::Matrix<double, eig::Dynamic, N, eig::RowMajor>;
+
+    struct CreateInfo {
+      cmat          C; // Equality constraint normals, one per row
+      eig::VectorXd d; // Equality constraint right-hand side
+      cmat          G; // Inequality constraint normals, one per row
+      eig::VectorXd h; // Inequality constraint right-hand side
+      bool mixed = false; // Solve in single precision first, refined in double precision
+    };
+
+    struct Result {
+      vec               x;               // Solution, or best effort if not successful
+      std::vector<uint> active;          // Active inequalities at x; pass to solve() for warm starts
+      uint              iters   = 0;     // Nr. of active set changes
+      bool              success = false; // Solution is optimal
+    };
+
+  private:
+    // Feasible set in reduced space, in a given precision
+    template <typename T>
+    struct Reduced {
+      eig::Vector<T, N>                          x0; // Particular solution to C x == d
+      eig::Matrix<T, eig::Dynamic, eig::Dynamic> Z;  // Null-space basis of C; x = x0 + Z y
+      eig::Matrix<T, eig::Dynamic, eig::Dynamic> G;  // Inequality normals in reduced space, G Z
+      eig::Vector<T, eig::Dynamic>               h;  // Inequality right-hand side in reduced space, h - G x0
+    };
+
+    Reduced<double> m_d;                // Feasible set in double precision
+    Reduced<float>  m_f;                // Feasible set in single precision, if mixed precision is enabled
+    Result          m_init;             // Feasible starting point for cold starts
+    bool            m_is_valid = false; // Feasible set is non-empty and equality block is of full rank
+    bool            m_is_mixed = false; // Solves run in single precision first
+
+    // Active-set method over the feasible set in the given precision
+    template <typename T>
+    Result solve(const vec &c, const Result &warm, const Reduced<T> &r) const;
+
+    // Refine a single-precision result in double precision; falls back to a 
+    // full double-precision solve if its active set does not verify
+    Result refine(const vec &c, const Result &warm, const Result &approx) const;
+
+  public:
+    LPSolver() = default;
+    LPSolver(CreateInfo &&info);
+
+    // Solve for the given objective, starting from a known feasible point
+    Result solve(const vec &c) const { return solve(c, m_init); }
+
+    // Solve for the given objective, warm-started from the result of a prior solve
+    Result solve(const vec &c, const Result &warm) const;
+
+    // Query whether a feasible point was found; if not, solve() always fails
+    bool is_valid() const { return m_is_valid; }
+
+    // Query whether solves run in single precision first
+    bool is_mixed() const { return m_is_mixed; }
+
+    // Feasible starting point, or prior state for warm starts
+    const Result &init() const { return m_init; }
+  };
+} // namespace met
\ No newline at end of file
@@ -16,103 +16,205 @@
 #pragma once
 
 #include <metameric/core/fwd.hpp>
+#include <functional>
+#include <optional>
+#include <span>
+#include <stop_token>
 
 namespace met {
+  // Argument and return types below are templated over a spectral layout of samples and bases;
+  // solvers are instantiated for the build's layout and the reduced preview layout, and the
+  // non-templated names refer to the build's layout
+
   // Argument struct for generating a closest representation in the basis
   // for a given spectral distribution.
-  struct SpectrumCoeffsInfo {
-    const Spec  &spec;  // Input spectrum to fit
-    const Basis &basis; // Spectral basis functions
+  template <uint Samples, uint Bases>
+  struct SpectrumCoeffsInfoBase {
+    const SpecBase<Samples>         &spec;  // Input spectrum to fit
+    const BasisBase<Samples, Bases> &basis; // Spectral basis functions
   };
 
   // Argument struct for generating a spectral reflectance, given one or more
   // known color signals in corresponding color systems
-  struct DirectSpectrumInfo {
-    using LinearConstraint = std::pair<ColrSystem, Colr>;
+  template <uint Samples, uint Bases>
+  struct DirectSpectrumInfoBase {
+    using LinearConstraint = std::pair<ColrSystemBase<Samples>, Colr>;
+
+    // Solver backend; eQP uses the dedicated active-set solver in qp.hpp,
+    // and falls back to eNLopt if the problem cannot be handled by it
+    enum class Backend { eNLopt, eQP };
+
+  public:
+    std::vector<LinearConstraint> linear_constraints = { };          // Direct metamerism constraints
+    const BasisBase<Samples, Bases> &basis;                          // Spectral basis functions
+    Backend backend                                  = Backend::eQP; // Solver backend
+  };
+
+  // Argument struct for generating spectral reflectances for many colors at once, given a single 
+  // shared color system, e.g. to uplift every texel of a texture; the shared system is factorized
+  // once, and results match the eQP backend of DirectSpectrumInfo per color
+  template <uint Samples, uint Bases>
+  struct DirectSpectrumBatchInfoBase {
+    ColrSystemBase<Samples>          csys;  // Color system shared by all colors
+    std::span<const Colr>            colrs; // Target colors in said color system
+    const BasisBase<Samples, Bases> &basis; // Spectral basis functions
+  };
+
+  // Solver statistics of indirect spectrum generation
+  struct IndirectSpectrumStats {
+    // Termination of Levenberg-Marquardt iterations; converged only if the residual vanishes, 
+    // stalled if the gradient or step vanishes first, or if damping grows without an improving 
+    // step, or out of iterations
+    enum class Status { eConverged, eStalled, eMaxIters };
 
   public:
-    std::vector<LinearConstraint> linear_constraints = { }; // Direct metamerism constraints
-    const Basis &basis;                                     // Spectral basis functions
+    Status status      = Status::eConverged; // Termination status of the eLM backend
+    uint   n_iters     = 0;                  // Nr. of LM iterations, or NLopt evaluations
+    bool   is_fallback = false;              // Result was produced by the eNLopt fallback
   };
 
   // Argument struct for generating a spectral reflectance, given a system of
-  // interreflections expressed as a truncated power series
-  struct IndirectSpectrumInfo {
-    using LinearConstraint  = std::pair<ColrSystem, Colr>;
-    using NLinearConstraint = std::pair<IndirectColrSystem, Colr>;
+  // interreflections expressed as a truncated power series. This is solved as a small nonlinear 
+  // least-squares problem through projected Levenberg-Marquardt iterations
+  template <uint Samples, uint Bases>
+  struct IndirectSpectrumInfoBase {
+    using LinearConstraint  = std::pair<ColrSystemBase<Samples>,         Colr>;
+    using NLinearConstraint = std::pair<IndirectColrSystemBase<Samples>, Colr>;
+
+    // Solver backend; eLM uses projected Levenberg-Marquardt, and falls back to eNLopt's SLSQP,
+    // staying close to the LM result, if the iterations do not converge
+    enum class Backend { eNLopt, eLM };
 
   public:
     std::vector<LinearConstraint>  linear_constraints  = { }; // Direct metamerism constraints
     std::vector<NLinearConstraint> nlinear_constraints = { }; // Indirect metamerism constraints
-    const Basis &basis;                                       // Spectral basis functions
+    const BasisBase<Samples, Bases> &basis;                   // Spectral basis functions
+
+    std::optional<eig::Vector<float, Bases>> coef_init = { }; // Warm start; defaults to the solution of the direct constraints
+    uint                           max_iters = 64;   // Upper limit to nr. of iterations
+    double                         tol       = 1e-6; // Convergence threshold for residual norm and step size
+    Backend                        backend   = Backend::eLM; // Solver backend
+    IndirectSpectrumStats         *stats     = nullptr;      // Optional; receives solver statistics
+  };
+
+  // Solver statistics of sampled mismatch solid generation, e.g. to measure the effect of warm starts
+  struct MismatchSolveStats {
+    uint n_accepted = 0; // Nr. of directions that produced a valid boundary sample
+    uint n_evals    = 0; // Total nr. of nonlinear solver evaluations; exact LP solves are not counted
   };
 
   // Argument struct for generating points on the object color solid of a metameric
   // mismatching between two or more color systems, following the method of Mackiewicz et al., 2019 
   // "Spherical sampling methods for the calculation of metamer mismatch volumes"
-  struct DirectMismatchSolidInfo {
-    using LinearConstraint = std::pair<ColrSystem, Colr>;
+  template <uint Samples, uint Bases>
+  struct DirectMismatchSolidInfoBase {
+    using LinearConstraint = std::pair<ColrSystemBase<Samples>, Colr>;
 
-  public:
-    std::vector<ColrSystem>       linear_objectives  = { }; // Direct objective functions
-    std::vector<LinearConstraint> linear_constraints = { }; // Direct metamerism constraints
+    // Solver backend; eLP uses the dedicated linear program solver in lp.hpp,
+    // and falls back to eNLopt for directions it cannot handle
+    enum class Backend { eNLopt, eLP };
 
-    const Basis &basis;  // Spectral basis functions
-    uint seed      = 4;  // Seed for (pcg) sampler state
-    uint n_samples = 32; // Nr. of samples to solve for
+  public:
+    std::vector<ColrSystemBase<Samples>> linear_objectives  = { }; // Direct objective functions
+    std::vector<LinearConstraint>        linear_constraints = { }; // Direct metamerism constraints
+
+    const BasisBase<Samples, Bases> &basis; // Spectral basis functions
+    uint seed       = 4;            // Start index into low-discrepancy direction sequence
+    uint n_samples  = 32;           // Nr. of samples to solve for
+    Backend backend = Backend::eLP; // Solver backend
+    bool warm_start = true;         // Seed nonlinear solves from the preceding direction along a space-filling curve
+    bool lp_mixed   = false;        // Run eLP solves in single precision first, refined in double precision
+    std::stop_token stop = { };     // Optional; exact enumeration ends without output once a stop is requested
+    MismatchSolveStats *stats = nullptr; // Optional; receives solver statistics
   };
   
   // Argument struct for generating points on the object color solid of a metameric
   // mismatching between signal in a number of base color systems, and a interreflection system
   // expressed as a truncated power series
-  struct IndirectMismatchSolidInfo {
-    using LinearConstraint  = std::pair<ColrSystem,         Colr>;
-    using NLinearConstraint = std::pair<IndirectColrSystem, Colr>;
+  template <uint Samples, uint Bases>
+  struct IndirectMismatchSolidInfoBase {
+    using LinearConstraint  = std::pair<ColrSystemBase<Samples>,         Colr>;
+    using NLinearConstraint = std::pair<IndirectColrSystemBase<Samples>, Colr>;
       
   public:
-    std::vector<IndirectColrSystem> nlinear_objectives  = { }; // Indirect parts of the objective function
-    std::vector<LinearConstraint>   linear_constraints  = { }; // Direct metamerism constraints
-    std::vector<NLinearConstraint>  nlinear_constraints = { }; // Indirect metamerism constraints
-
-    const Basis &basis;  // Spectral basis functions
-    uint seed      = 4;  // Seed for (pcg) sampler state
-    uint n_samples = 32; // Nr. of samples to solve for
+    std::vector<IndirectColrSystemBase<Samples>> nlinear_objectives  = { }; // Indirect parts of the objective function
+    std::vector<LinearConstraint>                linear_constraints  = { }; // Direct metamerism constraints
+    std::vector<NLinearConstraint>               nlinear_constraints = { }; // Indirect metamerism constraints
+
+    const BasisBase<Samples, Bases> &basis; // Spectral basis functions
+    uint seed       = 4;    // Start index into low-discrepancy direction sequence
+    uint n_samples  = 32;   // Nr. of samples to solve for
+    bool warm_start = true; // Seed solves from the preceding direction along a space-filling curve
+    MismatchSolveStats *stats = nullptr; // Optional; receives solver statistics
   };
 
   // Argument struct and method for generating points on the object color solid of a color system,
   // following the method of Mackiewicz et al., 2019, "Spherical sampling methods for the calculation of metamer mismatch volumes".
-  struct ColorSolidInfo {
-    ColrSystem direct_objective; // Color system that builds objective function
-    const Basis &basis;          // Spectral basis functions
-    uint seed      = 4;          // Seed for (pcg) sampler state
-    uint n_samples = 32;         // Nr. of samples to solve for
+  template <uint Samples, uint Bases>
+  struct ColorSolidInfoBase {
+    ColrSystemBase<Samples> direct_objective; // Color system that builds objective function
+    const BasisBase<Samples, Bases> &basis;   // Spectral basis functions
+    uint seed      = 4;                       // Start index into low-discrepancy direction sequence
+    uint n_samples = 32;                      // Nr. of samples to solve for
   };
 
   // Return type shorthands for metamer generation
-  using SpectrumSample = std::pair<Spec, Basis::vec_type>;
-  struct MismatchSample {
-    Colr            colr;
-    Spec            spec;
-    Basis::vec_type coef;
+  template <uint Samples, uint Bases>
+  struct MismatchSampleBase {
+    Colr                      colr;
+    SpecBase<Samples>         spec;
+    eig::Vector<float, Bases> coef;
   };
 
+  // Argument and return types in the build's spectral layout
+  using SpectrumCoeffsInfo        = SpectrumCoeffsInfoBase<wavelength_samples, wavelength_bases>;
+  using DirectSpectrumInfo        = DirectSpectrumInfoBase<wavelength_samples, wavelength_bases>;
+  using DirectSpectrumBatchInfo   = DirectSpectrumBatchInfoBase<wavelength_samples, wavelength_bases>;
+  using IndirectSpectrumInfo      = IndirectSpectrumInfoBase<wavelength_samples, wavelength_bases>;
+  using DirectMismatchSolidInfo   = DirectMismatchSolidInfoBase<wavelength_samples, wavelength_bases>;
+  using IndirectMismatchSolidInfo = IndirectMismatchSolidInfoBase<wavelength_samples, wavelength_bases>;
+  using ColorSolidInfo            = ColorSolidInfoBase<wavelength_samples, wavelength_bases>;
+  using MismatchSample            = MismatchSampleBase<wavelength_samples, wavelength_bases>;
+  using SpectrumSample            = std::pair<Spec, Basis::vec_type>;
+
+  // Deferred generation of mismatch samples; holds copies of all data it requires,
+  // s.t. it can be executed off the main thread, e.g. on a WorkerPool; long-running
+  // jobs may end early, without output, once a stop is requested on the token
+  using MismatchJob = std::function<std::vector<MismatchSample>(std::stop_token)>;
+
   // Function calls corresponding to the above info objects
-  Basis::vec_type              solve_spectrum_coef(const SpectrumCoeffsInfo &info);
-  Basis::vec_type              solve_spectrum_coef(const DirectSpectrumInfo &info);
-  Basis::vec_type              solve_spectrum_coef(const IndirectSpectrumInfo &info);
-  std::vector<Basis::vec_type> solve_color_solid_coef(const ColorSolidInfo &info);
-  std::vector<Basis::vec_type> solve_mismatch_solid_coef(const DirectMismatchSolidInfo &info);
-  std::vector<Basis::vec_type> solve_mismatch_solid_coef(const IndirectMismatchSolidInfo &info);
-  std::vector<MismatchSample>  solve_color_solid(const ColorSolidInfo &info);
-  std::vector<MismatchSample>  solve_mismatch_solid(const DirectMismatchSolidInfo &info);
-  std::vector<MismatchSample>  solve_mismatch_solid(const IndirectMismatchSolidInfo &info);
+  template <uint S, uint B> eig::Vector<float, B>              solve_spectrum_coef(const SpectrumCoeffsInfoBase<S, B> &info);
+  template <uint S, uint B> eig::Vector<float, B>              solve_spectrum_coef(const DirectSpectrumInfoBase<S, B> &info);
+  template <uint S, uint B> eig::Vector<float, B>              solve_spectrum_coef(const IndirectSpectrumInfoBase<S, B> &info);
+  template <uint S, uint B> std::vector<eig::Vector<float, B>> solve_spectrum_coef(const DirectSpectrumBatchInfoBase<S, B> &info);
+  template <uint S, uint B> std::vector<eig::Vector<float, B>> solve_color_solid_coef(const ColorSolidInfoBase<S, B> &info);
+  template <uint S, uint B> std::vector<eig::Vector<float, B>> solve_mismatch_solid_coef(const DirectMismatchSolidInfoBase<S, B> &info);
+  template <uint S, uint B> std::vector<eig::Vector<float, B>> solve_mismatch_solid_coef(const IndirectMismatchSolidInfoBase<S, B> &info);
+  template <uint S, uint B> std::vector<MismatchSampleBase<S, B>> solve_color_solid(const ColorSolidInfoBase<S, B> &info);
+  template <uint S, uint B> std::vector<MismatchSampleBase<S, B>> solve_mismatch_solid(const DirectMismatchSolidInfoBase<S, B> &info);
+  template <uint S, uint B> std::vector<MismatchSampleBase<S, B>> solve_mismatch_solid(const IndirectMismatchSolidInfoBase<S, B> &info);
+
+  // Exact variants for direct mismatch solids, which are the linear image of a convex polytope;
+  // instead of sampling, the volume's vertices are enumerated through support queries along
+  // facet normals, until no new facets appear. Ignores seed and n_samples
+  template <uint S, uint B> std::vector<eig::Vector<float, B>>    solve_mismatch_solid_exact_coef(const DirectMismatchSolidInfoBase<S, B> &info);
+  template <uint S, uint B> std::vector<MismatchSampleBase<S, B>> solve_mismatch_solid_exact(const DirectMismatchSolidInfoBase<S, B> &info);
+
+  // Map mismatch samples to another spectral layout, e.g. from the preview layout back to the 
+  // build's layout; coefficients are refit s.t. the output basis, resampled to the input layout,
+  // reproduces the input basis' spectra in a least-squares sense. For a basis obtained through
+  // resample_basis() this recovers the exact coefficients. Colors are copied as is
+  template <uint S, uint B, uint SIn, uint BIn>
+  std::vector<MismatchSampleBase<S, B>> resample_mismatch_samples(const std::vector<MismatchSampleBase<SIn, BIn>> &samples, 
+                                                                  const BasisBase<SIn, BIn>                        &basis_in,
+                                                                  const BasisBase<S, B>                            &basis);
 
   // Helper; generate coefficients producing a spectrum in a basis, and return said spectrum
   // plus the coefficients 
-  SpectrumSample solve_spectrum(const auto &info) {
+  auto solve_spectrum(const auto &info) {
     met_trace();
     auto c = solve_spectrum_coef(info);
-    return { info.basis(c), c };
+    return std::pair { info.basis(c), c };
   }
 
   // Helpers; generate coefficients, the resulting spectrum, and the mismatched color, assuming
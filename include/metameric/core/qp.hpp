@@ -0,0 +1,72 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <metameric/core/fwd.hpp>
+#include <metameric/core/utility.hpp>
+
+namespace met {
+  // Dense solver for strictly convex quadratic programs of fixed dimension N, of the form
+  //   minimize   1/2 x^T H x + g^T x
+  //   subject to C x == d
+  //              G x <= h
+  // following the dual active-set method of Goldfarb and Idnani, 1983, "A numerically stable
+  // dual method for solving strictly convex quadratic programs". The Cholesky factor of H
+  // and the factorization of the equality block C are computed once on construction;
+  // subsequent solves for different g, d, h only pay for the inequality active set.
+  template <uint N>
+  class QPSolver {
+  public:
+    using vec  = eig::Vector<double, N>;
+    using mat  = eig::Matrix<double, N, N>;
+    using cmat = eig::Matrix<double, eig::Dynamic, N, eig::RowMajor>;
+
+    struct CreateInfo {
+      mat  H; // Hessian of objective; must be positive definite
+      cmat C; // Equality constraint normals, one per row
+      cmat G; // Inequality constraint normals, one per row
+    };
+
+    struct Result {
+      vec  x;               // Solution, or best effort if not successful
+      uint iters   = 0;     // Nr. of active set changes
+      bool success = false; // Problem was feasible, and solution is optimal
+    };
+
+  private:
+    cmat          m_C, m_G;
+    mat           m_J;                // J = L^-T Q after the equality block was added
+    mat           m_R;                // Upper triangular R; first n_eq() columns hold equality block
+    double        m_R_norm;           // Running max. of R's diagonal, for degeneracy tests
+    double        m_trace;            // Trace of H times trace of L^-T, for optimality tests
+    bool          m_is_valid = false; // Equality block is of full rank
+    eig::LLT<mat> m_llt;              // Cholesky factorization of H
+
+  public:
+    QPSolver() = default;
+    QPSolver(CreateInfo &&info);
+
+    // Solve for the given linear objective term and equality/inequality right-hand sides
+    Result solve(const vec &g, const eig::VectorXd &d, const eig::VectorXd &h) const;
+
+    // Query whether the equality block could be factorized; if not, solve() always fails
+    bool is_valid() const { return m_is_valid; }
+
+    // Problem dimensions
+    uint n_eq() const { return static_cast<uint>(m_C.rows()); }
+    uint n_nq() const { return static_cast<uint>(m_G.rows()); }
+  };
+} // namespace met
\ No newline at end of file
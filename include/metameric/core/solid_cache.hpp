@@ -0,0 +1,88 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <metameric/core/fwd.hpp>
+#include <metameric/core/io.hpp>
+#include <metameric/core/mesh.hpp>
+#include <metameric/core/metamer.hpp>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace met {
+  // Process-wide cache of color solid boundary samples, as generated by solve_color_solid(), and
+  // the convex hull over their colors. Entries
+  // are keyed by a content hash over the color system, basis, and sampling parameters, s.t. 
+  // upliftings sharing an (observer, illuminant, basis) triple share a single solve. An optional
+  // on-disk tier persists entries across sessions; it is capped in size by evicting the least
+  // recently used files. The in-memory tier is capped in nr. of entries the same way.
+  class ColorSolidCache {
+  public:
+    // Cached boundary data; samples, and the convex hull over the samples' colors
+    struct Entry {
+      std::vector<MismatchSample> samples;
+      Mesh                        hull;
+
+    public: // Serialization
+      void to_stream(std::ostream &str) const {
+        met_trace();
+        io::to_stream(samples, str);
+        io::to_stream(hull,    str);
+      }
+
+      void from_stream(std::istream &str) {
+        met_trace();
+        io::from_stream(samples, str);
+        io::from_stream(hull,    str);
+      }
+    };
+
+    using entry_type = std::shared_ptr<const Entry>;
+
+    struct CreateInfo {
+      fs::path cache_dir      = { };      // Directory of on-disk tier; disabled if left empty
+      size_t   max_disk_bytes = 64 << 20; // Size cap of on-disk tier
+      uint     max_entries    = 16;       // Size cap of in-memory tier
+    };
+
+  private:
+    using lru_type = std::list<std::pair<size_t, entry_type>>;
+
+    std::mutex                                     m_mutex;
+    CreateInfo                                     m_info;
+    lru_type                                       m_lru; // Most recently used entries at front
+    std::unordered_map<size_t, lru_type::iterator> m_map;
+
+    // In-memory tier access; assume m_mutex is held
+    entry_type load_memory(size_t key);
+    void       store_memory(size_t key, entry_type entry);
+
+  public:
+    // Process-wide instance
+    static ColorSolidCache &instance();
+
+    // (Re)configure cache tiers; the in-memory tier is trimmed if necessary
+    void set_info(CreateInfo &&info);
+
+    // Return cached boundary samples and hull for the given info object, or generate and cache them
+    entry_type solve(const ColorSolidInfo &info);
+
+    // Discard the in-memory tier; the on-disk tier is left as is
+    void clear();
+  };
+} // namespace met
\ No newline at end of file
@@ -21,6 +21,8 @@
 #include <autodiff/forward/real.hpp>
 #include <autodiff/forward/real/eigen.hpp>
 #include <functional>
+#include <optional>
+#include <tuple>
 
 namespace nlopt {
   // NLOpt optimization direction; shorthand for negated objective function
@@ -78,51 +80,263 @@ namespace nlopt {
     nlopt::result             // Optional NLOPT return code; 1 == success
   >;
 
+  // Statically typed constraint kinds for TypedWrapper; Func is any function object with
+  // the signature of Wrapper<N>::Constraint::Capture, or Wrapper<N>::ConstraintV::Capture
+  // for vector constraints, e.g. the output of func_norm() or func_dot_v() below
+  template <typename Func> struct EqConstraint  { Func f; double tol = 0.0; };                  // f(x) == 0
+  template <typename Func> struct NqConstraint  { Func f; double tol = 0.0; };                  // f(x) <= 0
+  template <typename Func> struct EqConstraintV { Func f; met::uint n = 1; double tol = 0.0; }; // f(x) == 0
+  template <typename Func> struct NqConstraintV { Func f; met::uint n = 1; double tol = 0.0; }; // f(x) <= 0
+
+  // NLOpt problem description wrapper; statically typed alternative to Wrapper. The objective
+  // and constraint kinds are compile-time types stored by value, and nlopt calls into these
+  // through per-type trampolines instead of through std::function. Constraints are any of
+  // the kinds above, or a std::vector of one kind for a number of constraints known at runtime
+  template <met::uint N, typename Objective, typename... Constraints>
+  struct TypedWrapper {
+    using vec = Eigen::Vector<double, N>;
+
+  public:
+    algorithm algo = algorithm::LD_SLSQP;  // Employed algorithm
+    direction dirc = direction::eMinimize; // Minimize/maximize?
+
+    // Function arguments
+    Objective                  objective;   // Minimization/maximization objective
+    std::tuple<Constraints...> constraints; // Equality/inequality (vector) constraints
+
+    // Vector arguments
+    vec                x_init; // Initial best guess for x
+    std::optional<vec> upper;  // Upper bounds to solution 
+    std::optional<vec> lower;  // Lower bounds to solution
+    
+    // Miscellany
+    std::optional<double>    stopval;
+    std::optional<met::uint> max_iters;        
+    std::optional<double>    max_time;        
+    std::optional<double>    rel_xpar_tol; // 1e-4
+  };
+
+  namespace detail {
+    // Trampolines; nlopt passes a pointer to a function object of known type, which is then
+    // forwarded data in mapped Eigen objects. The gradient map holds a nullptr if absent, as
+    // not all algorithms require or provide a gradient
+    template <met::uint N, typename Func>
+    double func_trampoline(unsigned, const double *x, double *g, void *data) {
+      using vec = Eigen::Vector<double, N>;
+      return (*static_cast<Func *>(data))(Eigen::Map<const vec>(x), Eigen::Map<vec>(g));
+    }
+
+    template <met::uint N, typename Func>
+    void func_trampoline_v(unsigned m, double *r, unsigned, const double *x, double *g, void *data) {
+      using vec = Eigen::Vector<double, N>;
+      using mat = Eigen::Matrix<double, N, -1>;
+      (*static_cast<Func *>(data))(Eigen::Map<Eigen::VectorXd>(r, m), 
+                                   Eigen::Map<const vec>(x), 
+                                   Eigen::Map<mat>(g, N, m));
+    }
+
+    // Optimization object, cached per thread and per algorithm/dimension s.t. it is not rebuilt
+    // for every solve; also holds scratch space for x, as the library enforces std::vector :S
+    struct OptCache {
+      algorithm           algo;
+      met::uint           n;
+      opt                 desc;
+      std::vector<double> x;
+    };
+
+    // Acquire this thread's cached optimization object for the given algorithm and dimension;
+    // any constraints, bounds, and stopping criteria of a prior solve are cleared
+    OptCache &acquire_opt(algorithm algo, met::uint n);
+
+    // Run the optimization from the current contents of cache.x, failing silently on
+    // nlopt's roundoff/forced stop exceptions
+    nlopt::result optimize(OptCache &cache);
+
+    // Apply vector arguments and miscellany of a Wrapper/TypedWrapper, then optimize
+    template <met::uint N>
+    Result<N> optimize(OptCache &cache, const auto &info) {
+      auto &desc = cache.desc;
+
+      // Specify optional upper/lower bounds
+      if (auto v = info.upper) {
+        cache.x.assign(v->data(), v->data() + N);
+        desc.set_upper_bounds(cache.x);
+      }
+      if (auto v = info.lower) {
+        cache.x.assign(v->data(), v->data() + N);
+        desc.set_lower_bounds(cache.x);
+      }
+
+      // Specify optional stopping criteria and tolerances
+      if (info.rel_xpar_tol) desc.set_xtol_rel(*info.rel_xpar_tol);
+      if (info.max_time)     desc.set_maxtime(*info.max_time);
+      if (info.max_iters)    desc.set_maxeval(*info.max_iters);
+      if (info.stopval)      desc.set_stopval(*info.stopval);
+
+      // Optimize, and copy over potential solution to return value
+      Result<N> result;
+      cache.x.assign(info.x_init.data(), info.x_init.data() + N);
+      result.second = optimize(cache);
+      std::copy(cache.x.begin(), cache.x.end(), result.first.begin());
+      return result;
+    }
+
+    // Register constraints by kind; function objects must outlive the optimization
+    template <met::uint N, typename Func>
+    void add_constraint(opt &desc, EqConstraint<Func> &cstr) {
+      desc.add_equality_constraint(func_trampoline<N, Func>, &cstr.f, cstr.tol);
+    }
+
+    template <met::uint N, typename Func>
+    void add_constraint(opt &desc, NqConstraint<Func> &cstr) {
+      desc.add_inequality_constraint(func_trampoline<N, Func>, &cstr.f, cstr.tol);
+    }
+
+    template <met::uint N, typename Func>
+    void add_constraint(opt &desc, EqConstraintV<Func> &cstr) {
+      desc.add_equality_mconstraint(func_trampoline_v<N, Func>, &cstr.f, std::vector<double>(cstr.n, cstr.tol));
+    }
+
+    template <met::uint N, typename Func>
+    void add_constraint(opt &desc, NqConstraintV<Func> &cstr) {
+      desc.add_inequality_mconstraint(func_trampoline_v<N, Func>, &cstr.f, std::vector<double>(cstr.n, cstr.tol));
+    }
+
+    template <met::uint N, typename Cstr>
+    void add_constraint(opt &desc, std::vector<Cstr> &cstrs) {
+      for (auto &cstr : cstrs)
+        add_constraint<N>(desc, cstr);
+    }
+  } // namespace detail
+
   // Given a problem description, solve and generate a result 
   template <met::uint N>
   Result<N> solve(Wrapper<N> &info);
 
+  // Nr. of objective evaluations performed by this thread's most recent solve, e.g. to 
+  // measure the effect of a warm start through x_init
+  met::uint last_solve_evals();
+
+  // Given a statically typed problem description, solve and generate a result 
+  template <met::uint N, typename Objective, typename... Constraints>
+  Result<N> solve(TypedWrapper<N, Objective, Constraints...> &info) {
+    met_trace();
+
+    auto &cache = detail::acquire_opt(info.algo, N);
+
+    // Specify objective function
+    if (info.dirc == direction::eMinimize) {
+      cache.desc.set_min_objective(detail::func_trampoline<N, Objective>, &info.objective);
+    } else {
+      cache.desc.set_max_objective(detail::func_trampoline<N, Objective>, &info.objective);
+    }
+
+    // Add equality/inequality constraints
+    std::apply([&](auto &...cstrs) { (detail::add_constraint<N>(cache.desc, cstrs), ...); }, info.constraints);
+
+    return detail::optimize<N>(cache, info);
+  }
+
   /* Solver functions follow */
   
   // Describes f(x) = ||(Ax - b)|| with corresponding gradient
-  template <met::uint N>
-  auto func_norm(const auto &Af, const auto &bf) -> Wrapper<N>::Constraint::Capture {
-    using namespace met;
-    using vec = Wrapper<N>::vec;
-    return 
-      [A = Af.template cast<double>().eval(), b = bf.template cast<double>().eval()]
-      (eig::Map<const vec> x, eig::Map<vec> g) {
-        // shorthands for Ax - b and ||(Ax - b)||
-        auto diff = ((A * x).array() - b).matrix().eval();
-        auto norm = diff.norm();
+  template <typename Mat, typename Vec>
+  struct FuncNorm {
+    Mat A;
+    Vec b;
 
-        // g(x) = A^T * (Ax - b) / ||(Ax - b)||
-        if (g.data())
-          g = (A.transpose() * (diff.array() / norm).matrix()).eval();
+    double operator()(const auto &x, auto g) const {
+      // shorthands for Ax - b and ||(Ax - b)||
+      auto diff = ((A * x).array() - b).matrix().eval();
+      auto norm = diff.norm();
 
-        // f(x) = ||(Ax - b)||
-        return norm;
-    };
+      // g(x) = A^T * (Ax - b) / ||(Ax - b)||
+      if (g.data())
+        g = (A.transpose() * (diff.array() / norm).matrix()).eval();
+
+      // f(x) = ||(Ax - b)||
+      return norm;
+    }
   };
 
   // Describes f(x) = ||(Ax - b)||^2 with corresponding gradient
+  template <typename Mat, typename Vec>
+  struct FuncSquaredNorm {
+    Mat A;
+    Vec b;
+
+    double operator()(const auto &x, auto g) const {
+      // shorthand for Ax - b
+      auto diff = ((A * x).array() - b).matrix().eval();
+
+      // g(x) = 2A(Ax - b)
+      if (g.data())
+        g = 2.0 * A.transpose() * diff;
+
+      // f(x) = ||(Ax - b)||^2
+      return diff.squaredNorm();
+    }
+  };
+
+  // Describes f(x) = a * x - b with corresponding gradient
+  template <typename Vec>
+  struct FuncDot {
+    Vec    a;
+    double b;
+
+    double operator()(const auto &x, auto g) const {
+      // g(x) = a
+      if (g.data())
+        g = a;
+
+      // f(x) = ax - b
+      return a.dot(x) - b;
+    }
+  };
+
+  // Describes f(x) = Ax - b with corresponding gradient
+  template <typename Mat, typename Vec>
+  struct FuncDotV {
+    Mat A;
+    Vec b;
+
+    void operator()(auto r, const auto &x, auto g) const {
+      // g(x) = A
+      if (g.data())
+        g = A.transpose();
+
+      // f(x) = Ax - b
+      r = (A * x).array() - b;
+    }
+  };
+
+  // Factory functions for the above, casting input data to double; the results convert 
+  // to Wrapper<N>'s captures, or can be used directly in a TypedWrapper
   template <met::uint N>
-  auto func_squared_norm(const auto &Af, const auto &bf) -> Wrapper<N>::Constraint::Capture {
-    using namespace met;
-    using vec = Wrapper<N>::vec;
-    return 
-      [A = Af.template cast<double>().eval(), b = bf.template cast<double>().eval()]
-      (eig::Map<const vec> x, eig::Map<vec> g) {
-        // shorthand for Ax - b
-        auto diff = ((A * x).array() - b).matrix().eval();
+  auto func_norm(const auto &Af, const auto &bf) {
+    auto A = Af.template cast<double>().eval();
+    auto b = bf.template cast<double>().eval();
+    return FuncNorm<decltype(A), decltype(b)> { A, b };
+  };
 
-        // g(x) = 2A(Ax - b)
-        if (g.data())
-          g = 2.0 * A.transpose() * diff;
+  template <met::uint N>
+  auto func_squared_norm(const auto &Af, const auto &bf) {
+    auto A = Af.template cast<double>().eval();
+    auto b = bf.template cast<double>().eval();
+    return FuncSquaredNorm<decltype(A), decltype(b)> { A, b };
+  };
 
-        // f(x) = ||(Ax - b)||^2
-        return diff.squaredNorm();
-    };
+  template <met::uint N>
+  auto func_dot(const auto &af, const auto &bf) {
+    auto a = af.template cast<double>().eval();
+    return FuncDot<decltype(a)> { a, static_cast<double>(bf) };
+  };
+
+  template <met::uint N>
+  auto func_dot_v(const auto &Af, const auto &bf) {
+    auto A = Af.template cast<double>().eval();
+    auto b = bf.template cast<double>().eval();
+    return FuncDotV<decltype(A), decltype(b)> { A, b };
   };
 
   // Describes f(x) = ||(Ax - b)||^2 with corresponding gradient
@@ -174,46 +388,13 @@ namespace nlopt {
         return ret;
     };
   };
-
-  // Describes f(x) = a * x - b with corresponding gradient
-  template <met::uint N>
-  auto func_dot(const auto &af, const auto &bf) -> Wrapper<N>::Constraint::Capture {
-    using namespace met;
-    using vec = Wrapper<N>::vec;
-    return 
-      [a = af.template cast<double>().eval(), b = static_cast<double>(bf)]
-      (eig::Map<const vec> x, eig::Map<vec> g) {
-        // g(x) = a
-        if (g.data())
-          g = a;
-
-        // f(x) = ax - b
-        return a.dot(x) - b;
-    };
-  };
-  
-  // Describes f(x) = a * x - b with corresponding gradient
-  template <met::uint N>
-  auto func_dot_v(const auto &Af, const auto &bf) -> Wrapper<N>::ConstraintV::Capture {
-    using namespace met;
-    using vec = Wrapper<N>::vec;
-    using mat = Wrapper<N>::mat;
-    return 
-      [A = Af.template cast<double>().eval(), b = bf.template cast<double>().eval()]
-      (eig::Map<eig::VectorXd> r, eig::Map<const vec> x, eig::Map<mat> g) {
-        // g(x) = a
-        if (g.data())
-          g = A.transpose();
-
-        // f(x) = ax - b
-        r = (A * x).array() - b;
-    };
-  };
 } // namespace nlopt
 
 namespace autodiff {
-  template <met::uint N>
-  nlopt::Wrapper<N>::Constraint::Capture wrap_capture(std::function<real1st (const Eigen::Vector<real1st, N> &)> f) {
+  // Wrap a differentiable function of x in a function object that also computes the gradient,
+  // for use as objective or constraint in a Wrapper/TypedWrapper
+  template <met::uint N, typename Func>
+  auto wrap_capture(Func f) {
     using vec    = Eigen::Vector<double, N>;
     using ad_vec = Eigen::Vector<real1st, N>;
     return [f](Eigen::Map<const vec> x_, Eigen::Map<vec> g) -> double {
@@ -28,89 +28,205 @@ namespace met {
   constexpr static float wavelength_max     = MET_WAVELENGTH_MAX;  
   constexpr static uint  wavelength_samples = MET_WAVELENGTH_SAMPLES;
   constexpr static uint  wavelength_bases   = MET_WAVELENGTH_BASES;
+  static_assert(wavelength_bases == 8 || wavelength_bases == 12 || wavelength_bases == 16,
+    "MET_WAVELENGTH_BASES must be one of 8, 12, 16, matching shader-side coefficient packing");
+  static_assert(wavelength_samples > wavelength_bases, 
+    "MET_WAVELENGTH_SAMPLES must exceed MET_WAVELENGTH_BASES");
+
+  /* Define a reduced spectral layout over the same range; CPU-side solvers can run in this layout
+     instead, e.g. for interactive previews, while GPU-side data always uses the above layout */
+  constexpr static uint preview_wavelength_samples = MET_PREVIEW_WAVELENGTH_SAMPLES;
+  constexpr static uint preview_wavelength_bases   = MET_PREVIEW_WAVELENGTH_BASES;
+  static_assert(preview_wavelength_samples > preview_wavelength_bases, 
+    "MET_PREVIEW_WAVELENGTH_SAMPLES must exceed MET_PREVIEW_WAVELENGTH_BASES");
+  static_assert(preview_wavelength_samples <= wavelength_samples && preview_wavelength_bases <= wavelength_bases,
+    "Preview spectral layout must not exceed the build's spectral layout");
 
   /* Define derived variables from metameric's spectral range layout */
   constexpr static float wavelength_range = wavelength_max - wavelength_min;
   constexpr static float wavelength_ssize = wavelength_range / static_cast<float>(wavelength_samples);  
   constexpr static float wavelength_ssinv = static_cast<float>(wavelength_samples) / wavelength_range;
 
-  /* Define program's underlying spectrum/cmfs/color types as renamed Eigen types */
-  using CMFS = eig::Matrix<float, wavelength_samples, 3>; // Color matching function matrix
-  using Spec = eig::Array<float, wavelength_samples, 1>;  // Discrete spectrum matrix
-  using Colr = eig::Array<float, 3, 1>;                   // Color signal matrix
+  /* Define program's underlying spectrum/cmfs/color types as renamed Eigen types; spectral types 
+     are templated over their nr. of samples, and default to the build's layout below */
+  template <uint Samples> using CMFSBase = eig::Matrix<float, Samples, 3>; // Color matching function matrix
+  template <uint Samples> using SpecBase = eig::Array<float, Samples, 1>;  // Discrete spectrum matrix
+  using Colr = eig::Array<float, 3, 1>;                                   // Color signal matrix
 
   /* Basis function object, using a offset around its mean */
-  struct Basis {
-    using mat_type = eig::Matrix<float, wavelength_samples, wavelength_bases>;
-    using vec_type = eig::Vector<float, wavelength_bases>;
+  template <uint Samples, uint Bases>
+  struct BasisBase {
+    using spec_type = SpecBase<Samples>;
+    using mat_type  = eig::Matrix<float, Samples, Bases>;
+    using vec_type  = eig::Vector<float, Bases>;
 
   public:
-    Spec     mean;  // Ignored r.n.
-    float    scale; // Ignored r.n.
-    mat_type func;  // Basis functions around mean offset
+    spec_type mean;  // Ignored r.n.
+    float     scale; // Ignored r.n.
+    mat_type  func;  // Basis functions around mean offset
 
   public: // Boilerplate
-    Spec apply(const vec_type &c) const { 
+    spec_type apply(const vec_type &c) const { 
       return ((func * c).array()).cwiseMax(0.f).cwiseMin(1.f).eval();
     }
-    std::vector<Spec> apply(std::span<const vec_type> cs) const;
+    std::vector<spec_type> apply(std::span<const vec_type> cs) const;
+
+    // Batched variants; coefficient vectors are the columns of cs, and are applied in order through
+    // a single blocked matrix product, writing clamped spectra to the columns of out
+    void apply(eig::Ref<const eig::MatrixXf> cs, eig::Ref<eig::MatrixXf> out) const;
+    void apply(eig::Ref<const eig::MatrixXd> cs, eig::Ref<eig::MatrixXd> out) const;
 
     auto operator()(const vec_type &c) const { return apply(c); }
     auto operator()(std::span<const vec_type> cs) const { return apply(cs); }
-    bool operator==(const Basis &o) const;
+    bool operator==(const BasisBase &o) const;
     void to_stream(std::ostream &str) const;
     void from_stream(std::istream &str);
   };
 
-  // Concept for a color system, which can take a spectral distribution or set of spectra,
-  // and output one or more color signals in response
-  template <typename Ty>
-  concept is_colr_system = requires(Ty t, std::span<const Spec> sds, bool as_rgb) {
-    { t.apply(sds.front(), as_rgb)      } -> std::same_as<Colr>;
-    { t.apply(sds, as_rgb)              } -> std::same_as<std::vector<Colr>>;
-    { t.operator()(sds.front(), as_rgb) } -> std::same_as<Colr>;
-    { t.operator()(sds, as_rgb)         } -> std::same_as<std::vector<Colr>>;
-  };
-
   /* Object defining how a reflectance-to-color conversion is performed */
-  struct ColrSystem {
-    CMFS cmfs;       // Sensor color matching or response functions
-    Spec illuminant; // Illuminant under which observation is performed
+  template <uint Samples>
+  struct ColrSystemBase {
+    using spec_type = SpecBase<Samples>;
+    using cmfs_type = CMFSBase<Samples>;
 
   public:
-    CMFS finalize(bool as_rgb = true) const;                                     // Simplify the CMFS/illuminant into color system spectra
-    Colr apply(const Spec &s, bool as_rgb = true) const;                         // Obtain a color from a reflectance in this color system
-    std::vector<Colr> apply(std::span<const Spec> sd, bool as_rgb = true) const; // Obtain colors from reflectances in this color system
+    cmfs_type cmfs;       // Sensor color matching or response functions
+    spec_type illuminant; // Illuminant under which observation is performed
+
+  public:
+    cmfs_type finalize(bool as_rgb = true) const;                                     // Simplify the CMFS/illuminant into color system spectra
+    Colr apply(const spec_type &s, bool as_rgb = true) const;                         // Obtain a color from a reflectance in this color system
+    std::vector<Colr> apply(std::span<const spec_type> sd, bool as_rgb = true) const; // Obtain colors from reflectances in this color system, in order
+
+    // Batched variants; spectra are the columns of sd, and are transformed in order through
+    // a single blocked matrix product, writing colors to the columns of out
+    void apply(eig::Ref<const eig::MatrixXf> sd, eig::Ref<eig::MatrixXf> out, bool as_rgb = true) const;
+    void apply(eig::Ref<const eig::MatrixXd> sd, eig::Ref<eig::MatrixXd> out, bool as_rgb = true) const;
     
   public: // Boilerplate
-    auto operator()(const Spec &s, bool as_rgb = true) const { return apply(s, as_rgb); }
-    auto operator()(std::span<const Spec> s, bool as_rgb = true) const { return apply(s, as_rgb); }
-    bool operator==(const ColrSystem &o) const;
+    auto operator()(const spec_type &s, bool as_rgb = true) const { return apply(s, as_rgb); }
+    auto operator()(std::span<const spec_type> s, bool as_rgb = true) const { return apply(s, as_rgb); }
+    bool operator==(const ColrSystemBase &o) const;
     void to_stream(std::ostream &str) const;
     void from_stream(std::istream &str);
   };
-  static_assert(is_colr_system<ColrSystem>);
 
   /* Object defining how a reflectance-to-color conversion is performed,
      given a truncated power series describing interreflections */
-  struct IndirectColrSystem {
-    CMFS              cmfs;   // Sensor color matching or response functions
-    std::vector<Spec> powers; // Truncated power series describing partial interreflections
+  template <uint Samples>
+  struct IndirectColrSystemBase {
+    using spec_type = SpecBase<Samples>;
+    using cmfs_type = CMFSBase<Samples>;
+
+  public:
+    cmfs_type              cmfs;   // Sensor color matching or response functions
+    std::vector<spec_type> powers; // Truncated power series describing partial interreflections
   
   public:
-    std::vector<CMFS> finalize(bool as_rgb = true) const;                        // Simplify the recrursive system into color system spectra
-    Colr apply(const Spec &s, bool as_rgb = true) const;                         // Obtain a color from a reflectance in this color system
-    std::vector<Colr> apply(std::span<const Spec> sd, bool as_rgb = true) const; // Obtain colors from reflectances in this color system
+    std::vector<cmfs_type> finalize(bool as_rgb = true) const;                        // Simplify the recrursive system into color system spectra
+    Colr apply(const spec_type &s, bool as_rgb = true) const;                         // Obtain a color from a reflectance in this color system
+    std::vector<Colr> apply(std::span<const spec_type> sd, bool as_rgb = true) const; // Obtain colors from reflectances in this color system, in order
 
   public: // Boilerplate
-    auto operator()(const Spec &s, bool as_rgb = true) const { return apply(s, as_rgb); }
-    auto operator()(std::span<const Spec> s, bool as_rgb = true) const { return apply(s, as_rgb); }
-    bool operator==(const IndirectColrSystem &o) const;
+    auto operator()(const spec_type &s, bool as_rgb = true) const { return apply(s, as_rgb); }
+    auto operator()(std::span<const spec_type> s, bool as_rgb = true) const { return apply(s, as_rgb); }
+    bool operator==(const IndirectColrSystemBase &o) const;
     void to_stream(std::ostream &str) const;
     void from_stream(std::istream &str);
   };
+
+  // General spectral types used throughout the application, in the build's spectral layout
+  using CMFS               = CMFSBase<wavelength_samples>;
+  using Spec               = SpecBase<wavelength_samples>;
+  using Basis              = BasisBase<wavelength_samples, wavelength_bases>;
+  using ColrSystem         = ColrSystemBase<wavelength_samples>;
+  using IndirectColrSystem = IndirectColrSystemBase<wavelength_samples>;
+
+  // Concept for a color system, which can take a spectral distribution or set of spectra,
+  // and output one or more color signals in response
+  template <typename Ty>
+  concept is_colr_system = requires(Ty t, std::span<const typename Ty::spec_type> sds, bool as_rgb) {
+    { t.apply(sds.front(), as_rgb)      } -> std::same_as<Colr>;
+    { t.apply(sds, as_rgb)              } -> std::same_as<std::vector<Colr>>;
+    { t.operator()(sds.front(), as_rgb) } -> std::same_as<Colr>;
+    { t.operator()(sds, as_rgb)         } -> std::same_as<std::vector<Colr>>;
+  };
+  static_assert(is_colr_system<ColrSystem>);
   static_assert(is_colr_system<IndirectColrSystem>);
 
+  /* 
+    Spectral layout conversion
+  */
+
+  namespace detail {
+    // Matrix resampling discrete spectral data over the same range to another nr. of samples; output
+    // bins average the input bins they overlap when reducing the nr. of samples, and are linearly 
+    // interpolated between input bin centers otherwise
+    template <uint Samples, uint SamplesIn>
+    eig::Matrix<float, Samples, SamplesIn> resample_matrix() {
+      eig::Matrix<float, Samples, SamplesIn> R = eig::Matrix<float, Samples, SamplesIn>::Zero();
+      if constexpr (Samples == SamplesIn) {
+        R.setIdentity();
+      } else if constexpr (Samples < SamplesIn) {
+        for (uint i = 0; i < Samples; ++i) {
+          for (uint j = 0; j < SamplesIn; ++j) {
+            float a = std::max(static_cast<float>(i)     / Samples, static_cast<float>(j)     / SamplesIn),
+                  b = std::min(static_cast<float>(i + 1) / Samples, static_cast<float>(j + 1) / SamplesIn);
+            if (b > a)
+              R(i, j) = (b - a) * static_cast<float>(Samples);
+          }
+        }
+      } else {
+        for (uint i = 0; i < Samples; ++i) {
+          float v = std::clamp((static_cast<float>(i) + .5f) * SamplesIn / Samples - .5f, 
+                               0.f, static_cast<float>(SamplesIn - 1));
+          uint  t = static_cast<uint>(v);
+          float a = v - static_cast<float>(t);
+          R(i, t) += 1.f - a;
+          if (a > 0.f)
+            R(i, t + 1) += a;
+        }
+      }
+      return R;
+    }
+  } // namespace detail
+
+  // Resample the rows of a spectrum or cmfs to another nr. of samples over the same range
+  template <uint Samples, typename Ty>
+  auto resample_spectrum(const Ty &s) {
+    constexpr uint SamplesIn = static_cast<uint>(Ty::RowsAtCompileTime);
+    if constexpr (Samples == SamplesIn)
+      return s.eval();
+    else if constexpr (std::is_base_of_v<eig::ArrayBase<Ty>, Ty>)
+      return (detail::resample_matrix<Samples, SamplesIn>() * s.matrix()).array().eval();
+    else
+      return (detail::resample_matrix<Samples, SamplesIn>() * s).eval();
+  }
+
+  // Resample a color system to another nr. of samples over the same range
+  template <uint Samples, uint SamplesIn>
+  ColrSystemBase<Samples> resample_csys(const ColrSystemBase<SamplesIn> &csys) {
+    return { .cmfs = resample_spectrum<Samples>(csys.cmfs), .illuminant = resample_spectrum<Samples>(csys.illuminant) };
+  }
+
+  // Resample an indirect color system to another nr. of samples over the same range
+  template <uint Samples, uint SamplesIn>
+  IndirectColrSystemBase<Samples> resample_csys(const IndirectColrSystemBase<SamplesIn> &csys) {
+    IndirectColrSystemBase<Samples> out = { .cmfs = resample_spectrum<Samples>(csys.cmfs) };
+    for (const auto &pwr : csys.powers)
+      out.powers.push_back(resample_spectrum<Samples>(pwr));
+    return out;
+  }
+
+  // Resample a basis to another layout over the same range; basis functions are resampled, and
+  // reduced to the given nr. of bases along their dominant right singular vectors, s.t. the output
+  // spans the best approximation of the resampled basis' column space
+  template <uint Samples, uint Bases, uint SamplesIn, uint BasesIn>
+  BasisBase<Samples, Bases> resample_basis(const BasisBase<SamplesIn, BasesIn> &basis);
+
+  // Collapse a set of colors to its unique colors, e.g. after ColrSystem::apply(); output order is unspecified
+  std::vector<Colr> unique_colors(std::span<const Colr> colrs);
+
   /* 
     Hardcoded model data.
   */
@@ -0,0 +1,68 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <metameric/core/fwd.hpp>
+#include <metameric/core/utility.hpp>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace met {
+  // Persistent pool of background threads, which run submitted jobs in FIFO order. Used to 
+  // move expensive, GL-independent work (e.g. mismatch volume generation) off the frame loop. 
+  // Jobs should be self-contained, i.e. not reference data that is modified by the caller
+  // while they are in flight, and are responsible for their own cancellation.
+  class WorkerPool {
+  public:
+    using Job = std::function<void()>;
+
+  private:
+    struct Queue {
+      std::mutex                  mutex;
+      std::condition_variable_any cv;
+      std::deque<Job>             jobs;
+    };
+
+    std::unique_ptr<Queue>    m_queue;   // Heap-allocated, so the pool remains movable
+    std::vector<std::jthread> m_threads; // Declared last, so workers are joined before the queue is freed
+
+    // Request all threads to stop, join them, and drop any queued jobs
+    void stop();
+
+  public:
+    // Create a pool with the given nr. of threads; 0 defaults to the available
+    // hardware threads minus one, s.t. the frame loop keeps a core to itself
+    WorkerPool(uint n_threads = 0);
+
+    // Submit a job for execution on any of the pool's threads
+    void submit(Job &&job);
+
+    // Nr. of jobs currently waiting to be picked up by a thread
+    uint n_queued() const;
+
+    // Nr. of threads in the pool
+    uint n_threads() const { return static_cast<uint>(m_threads.size()); }
+
+  public: // Boilerplate
+    ~WorkerPool();
+    WorkerPool(WorkerPool &&o);
+    WorkerPool &operator=(WorkerPool &&o);
+  };
+} // namespace met
\ No newline at end of file
@@ -68,6 +68,25 @@ namespace met {
         detail::push_resource_selector("Viewport", e_scene.components.views, settings.view_i);
 
         ImGui::DragFloat("Render scale", &settings.view_scale, .05f, .05f, 1.f);
+        ImGui::DragFloat("Solver budget (ms)", &settings.solve_budget, .25f, .5f, 100.f);
+
+        // Solver layout name helper
+        std::array<std::string, 2> layout_names = {
+          fmt::format("Full ({}/{})", wavelength_samples, wavelength_bases),
+          fmt::format("Preview ({}/{})", preview_wavelength_samples, preview_wavelength_bases)
+        };
+        uint layout_i = static_cast<uint>(settings.solve_layout);
+
+        // Combobox to select spectral layout of mismatch volume solves
+        if (ImGui::BeginCombo("Solver layout", layout_names[layout_i].c_str())) {
+          for (uint i = 0; i < layout_names.size(); ++i) {
+            if (ImGui::Selectable(layout_names[i].c_str(), layout_i == i)) {
+              layout_i = i;
+            }
+          }
+          ImGui::EndCombo();
+        }
+        settings.solve_layout = static_cast<Settings::SolveLayout>(layout_i);
 
 
         // Test if settings are changed, and apply
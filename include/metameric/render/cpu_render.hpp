@@ -0,0 +1,77 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <metameric/core/fwd.hpp>
+#include <metameric/core/image.hpp>
+#include <metameric/core/record.hpp>
+#include <metameric/scene/scene.hpp>
+#include <metameric/render/sensor.hpp>
+
+namespace met {
+  // Helper struct for creation of CPUPathRenderer
+  struct CPUPathRendererInfo {
+    // The renderer accumulates up to this number of samples per pixel
+    uint spp_max = 64;
+
+    // Number of samples per pixel taken whenever a thread picks up a tile; 
+    // lower values check the time budget at a finer granularity
+    uint spp_per_iter = 4;
+
+    // Wall-clock budget in seconds for a render() call; once exceeded, no new
+    // tiles are picked up and pixels may hold fewer samples. Unused if set to 0
+    float time_budget = 0.f;
+
+    // Maximum path length (unused if 0) and russian roulette start (unused if set to 0)
+    uint max_depth = 0;
+    uint rr_depth  = PathRecord::path_max_depth;
+
+    // Render output to image with an alpha component,
+    // allowing images without a background
+    bool enable_alpha = false;
+
+    // Square tile size in pixels, and nr. of threads (0 defaults to all hardware threads)
+    uint tile_size = 16;
+    uint n_threads = 0;
+  };
+
+  // Headless counterpart of PathRenderPrimitive; a cpu implementation of the same 
+  // unidirectional spectral path tracer with next-event-estimation and four-wavelength 
+  // sampling. Tiles are distributed over threads, which steal work when they run dry.
+  // Reads the cpu-side scene caches (meshes, tessellations, emitter distribution), so 
+  // the scene must have been updated before rendering.
+  class CPUPathRenderer {
+    CPUPathRendererInfo m_info;
+    uint                m_spp_min = 0; // Minimum nr. of samples per pixel after last render()
+    uint                m_spp_max = 0; // Maximum nr. of samples per pixel after last render()
+
+  public:
+    using InfoType = CPUPathRendererInfo;
+
+    CPUPathRenderer() = default;
+    CPUPathRenderer(InfoType info);
+
+    // Render the scene as seen through the sensor; blocks until spp_max samples per pixel 
+    // are taken or the time budget is exceeded. Returns a rgba float image in linear srgb,
+    // following the gpu-side film layout
+    Image render(const Sensor &sensor, const Scene &scene);
+
+    // Range of samples per pixel taken by the last render() call; these only differ
+    // if the time budget was exceeded partway through
+    uint spp_min() const { return m_spp_min; }
+    uint spp_max() const { return m_spp_max; }
+  };
+} // namespace met
\ No newline at end of file
@@ -56,6 +56,9 @@ namespace met {
 
     // The constraint allows for realizing mismatch volume sample points
     { t.realize_mismatch(scene, uplifting, seed, samples) } -> std::same_as<std::vector<MismatchSample>>;
+
+    // The constraint allows for deferring the above, s.t. it can run outside of the scene's lifetime
+    { t.prepare_mismatch(scene, uplifting, seed, samples) } -> std::same_as<MismatchJob>;
   };
 
   // Concept for a constraint on metameric behavior used throughout the application's
@@ -73,10 +76,14 @@ namespace met {
 
   // Concept defining the expected components of linear color-system constraints
   template <typename Ty>
-  concept is_linear_constraint = is_roundtrip_constraint<Ty> && requires(Ty t) {
+  concept is_linear_constraint = is_roundtrip_constraint<Ty> && requires(Ty t, Scene scene, Uplifting uplifting) {
     // The constraint specifies secondary color data, under secondary
     // color systems assembled from scene data
     { t.cstr_j } -> std::convertible_to<std::vector<LinearConstraint>>;
+
+    // The constraint's mismatch volume is a convex polytope, whose vertices can be realized exactly
+    { t.realize_mismatch_exact(scene, uplifting) } -> std::same_as<std::vector<MismatchSample>>;
+    { t.prepare_mismatch_exact(scene, uplifting) } -> std::same_as<MismatchJob>;
   };
 
   // Concept defining the expected components of nonlinear color-system constraints
@@ -100,6 +107,11 @@ namespace met {
       return { };
     }
 
+    // Deferred variant of realize_mismatch(); there is nothing to defer
+    MismatchJob prepare_mismatch(const Scene &scene, const Uplifting &uplifting, uint seed, uint samples) const {
+      return { };
+    }
+
   public:
     bool operator==(const MeasurementConstraint &o) const;
   };
@@ -119,6 +131,14 @@ namespace met {
     // Generate points on the constraint's metamer mismatching volume
     std::vector<MismatchSample> realize_mismatch(const Scene &scene, const Uplifting &uplifting, uint seed, uint samples) const;
 
+    // Generate the vertices of the constraint's metamer mismatching volume
+    std::vector<MismatchSample> realize_mismatch_exact(const Scene &scene, const Uplifting &uplifting) const;
+
+    // Deferred variants of realize_mismatch() and realize_mismatch_exact(); the returned
+    // jobs hold copies of the relevant scene data, and are safe to run on another thread
+    MismatchJob prepare_mismatch(const Scene &scene, const Uplifting &uplifting, uint seed, uint samples) const;
+    MismatchJob prepare_mismatch_exact(const Scene &scene, const Uplifting &uplifting) const;
+
   public:
     bool operator==(const DirectColorConstraint &o) const;
   };
@@ -142,6 +162,14 @@ namespace met {
     // Generate points on the constraint's metamer mismatching volume
     std::vector<MismatchSample> realize_mismatch(const Scene &scene, const Uplifting &uplifting, uint seed, uint samples) const;
 
+    // Generate the vertices of the constraint's metamer mismatching volume
+    std::vector<MismatchSample> realize_mismatch_exact(const Scene &scene, const Uplifting &uplifting) const;
+
+    // Deferred variants of realize_mismatch() and realize_mismatch_exact(); the returned
+    // jobs hold copies of the relevant scene data, and are safe to run on another thread
+    MismatchJob prepare_mismatch(const Scene &scene, const Uplifting &uplifting, uint seed, uint samples) const;
+    MismatchJob prepare_mismatch_exact(const Scene &scene, const Uplifting &uplifting) const;
+
   public:
     bool operator==(const DirectSurfaceConstraint &o) const;
   };
@@ -165,6 +193,10 @@ namespace met {
     // Generate points on the constraint's metamer mismatching volume
     std::vector<MismatchSample> realize_mismatch(const Scene &scene, const Uplifting &uplifting, uint seed, uint samples) const;
 
+    // Deferred variant of realize_mismatch(); the returned job holds copies of the
+    // relevant scene data, and is safe to run on another thread
+    MismatchJob prepare_mismatch(const Scene &scene, const Uplifting &uplifting, uint seed, uint samples) const;
+
   public:
     bool operator==(const IndirectSurfaceConstraint &o) const;
   };
@@ -69,4 +69,23 @@ namespace met::detail {
     BVH(CreateMeshInfo info);
     BVH(CreateAABBInfo info);
   };
+
+  // Packed 8-way BVH node, as uploaded to gpu-side blas/tlas buffers and decoded
+  // in render/blas.glsl; child AABBs are quantized relative to the parent AABB
+  struct NodePack {
+    uint data;                        // type 1b | child mask 8b | size 4b | offs 19b
+    std::array<uint, 3> aabb;         // [lo.x, lo.y], [hi.x, hi.y], [lo.z, hi.z]
+    std::array<uint, 8> child_aabb_0; // per child: lo.x | lo.y | hi.x | hi.y
+    std::array<uint, 4> child_aabb_1; // per child: lo.z | hi.z
+
+  public: // Accessors to data field, following node_get_* in render/blas.glsl
+    uint offs()    const { return  data        & 0x007FFFFu; }
+    uint size()    const { return (data >> 19) & 0x000000Fu; }
+    uint mask()    const { return (data >> 23) & 0x00000FFu; }
+    bool is_leaf() const { return (data >> 31) & 0x0000001u; }
+  };
+  static_assert(sizeof(NodePack) == 64);
+
+  // Helper method to pack BVH node data to NodePack type
+  NodePack pack(const BVH<8>::Node &node);
 } // namespace met::detail
\ No newline at end of file
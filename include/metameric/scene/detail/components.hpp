@@ -93,8 +93,8 @@ namespace met::detail {
 
   public: // State handling
     // Test each internal component for an update and, if component state is changed,
-    // update the gl-side packed data
-    bool update(const met::Scene &scene) {
+    // update the gl-side packed data; or only cpu-side caches, if gl_enabled is false
+    bool update(const met::Scene &scene, bool gl_enabled = true) {
       met_trace();
 
       if (m_data.size() == m_size) {
@@ -112,7 +112,10 @@ namespace met::detail {
       }
 
       // If a gl packing type is specialized for the component type, update gl packing data
-      gl.update(scene);          
+      if (gl_enabled)
+        gl.update(scene);
+      else
+        gl.update_cache(scene);
 
       return m_mutated;
     }
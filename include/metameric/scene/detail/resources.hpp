@@ -105,15 +105,18 @@ namespace met::detail {
 
   public: // State handling
     // Reset each internal resource's state and, if state was changed, updated
-    // the gl-side packed data
-    bool update(const met::Scene &scene) {
+    // the gl-side packed data; or only cpu-side caches, if gl_enabled is false
+    bool update(const met::Scene &scene, bool gl_enabled = true) {
       met_trace();
       
       // Get current state as return value
       bool mutated = is_mutated();
 
       // If a gl packing type is specialized for the component type, update gl packing data
-      gl.update(scene);          
+      if (gl_enabled)
+        gl.update(scene);
+      else
+        gl.update_cache(scene);
 
       // Reset state for next iteration
       set_mutated(false);
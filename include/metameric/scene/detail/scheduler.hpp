@@ -0,0 +1,54 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <metameric/core/fwd.hpp>
+#include <functional>
+#include <span>
+
+namespace met::detail {
+  // Helper object that distributes a per-frame budget of solver time over requests for solver
+  // jobs. Edited requests are served first, and the rest round-robin, least recently served 
+  // first. Job sizes follow from the requests' measured per-sample cost, s.t. the frame cost
+  // stays roughly constant, independent of the nr. of requests
+  class BudgetScheduler {
+    uint  m_frame     = 0;   // Nr. of dispatches so far
+    float m_cost_mean = 1.f; // Running mean of per-sample cost over all requests, for unmeasured requests
+
+  public:
+    // A pending request for a solver job
+    struct Request {
+      float sample_cost = 0.f;   // Measured per-sample cost in ms, or 0 if unmeasured
+      uint  last_served = 0;     // Frame in which the requester was last served
+      bool  is_edited   = false; // Requester is being edited, and must be served this frame
+      std::function<void(uint n, uint frame)> submit; // Submits a job of n samples in the given frame
+    };
+
+    struct DispatchInfo {
+      float budget;   // Frame budget of solver time in ms
+      uint  n_min;    // Lower limit per solver job
+      uint  n_max;    // Upper limit per solver job
+    };
+
+  public:
+    // Call submit() on requests within the frame budget; edited requests, and the first request 
+    // in line, are always served at the minimum job size, s.t. progress is guaranteed
+    void dispatch(std::span<Request> requests, DispatchInfo info);
+
+    // Nr. of dispatches so far
+    uint frame() const { return m_frame; }
+  };
+} // namespace met::detail
\ No newline at end of file
@@ -0,0 +1,61 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <metameric/core/fwd.hpp>
+#include <metameric/core/mesh.hpp>
+#include <metameric/core/record.hpp>
+#include <metameric/core/detail/packing.hpp>
+#include <metameric/scene/detail/bvh.hpp>
+#include <span>
+
+namespace met::detail {
+  // CPU-side traversal of 8-wide BVHs. Follows the traversal order and child box decoding
+  // of render/blas.glsl, s.t. queries find the same hits as the gpu-side renderer does.
+  // Rays are RayRecord objects; ray.t bounds the query on input, and closest-hit queries 
+  // update ray.t and the record's primitive index on a hit.
+  // Child box tests run 8-wide through AVX2 kernels, built separately with AVX2/FMA enabled, 
+  // if the cpu supports these at runtime; equivalent scalar code runs otherwise.
+
+  // Instruction set used for child box tests; eAuto selects AVX2 if supported. An unsupported 
+  // eAVX2 falls back to scalar code, s.t. results can always be compared against eScalar
+  enum class TraversalISA { eAuto, eScalar, eAVX2 };
+
+  // Query whether AVX2 child box tests were built, and are supported by the cpu
+  bool traversal_supports_avx2();
+
+  // View over packed BLAS data of a single mesh, as uploaded by SceneGLHandler<Mesh>;
+  // i.e. the ranges starting at a mesh's nodes_offs/prims_offs in blas_nodes/blas_prims
+  struct PackedBVH {
+    std::span<const NodePack>      nodes; // Compressed 8-way node data
+    std::span<const PrimitivePack> prims; // Packed primitive data, in bvh order
+  };
+
+  // Closest-hit queries; return true and update ray on a hit. The stored primitive index 
+  // refers to mesh elements for BVH<8>, and to the prims range for PackedBVH, as on the gpu
+  bool ray_intersect(RayRecord &ray, const BVH<8> &bvh, const Mesh &mesh, TraversalISA isa = TraversalISA::eAuto);
+  bool ray_intersect(RayRecord &ray, const PackedBVH &bvh,                TraversalISA isa = TraversalISA::eAuto);
+
+  // Any-hit queries; return true on the first hit closer than ray.t
+  bool ray_intersect_any(const RayRecord &ray, const BVH<8> &bvh, const Mesh &mesh, TraversalISA isa = TraversalISA::eAuto);
+  bool ray_intersect_any(const RayRecord &ray, const PackedBVH &bvh,                TraversalISA isa = TraversalISA::eAuto);
+
+  // Child box tests; return a bitmask flagging which of a node's <= 8 children are hit,
+  // following ray_intersect_aabb_mask in render/blas.glsl
+  uint ray_intersect_aabb_mask(const RayRecord &ray, const BVH<8>::Node &node, TraversalISA isa = TraversalISA::eAuto);
+  uint ray_intersect_aabb_mask(const RayRecord &ray, const NodePack &node,     TraversalISA isa = TraversalISA::eAuto);
+} // namespace met::detail
\ No newline at end of file
@@ -31,7 +31,11 @@ namespace met::detail {
   public:
     // Children can implement update(), which pushes cpu-to-gpu operations
     virtual void update(const Scene &) = 0;
-    
+
+    // Children can implement update_cache(), which only rebuilds cpu-side caches that are
+    // otherwise built during update(); this must not touch the GL context, for headless use
+    virtual void update_cache(const Scene &) { /* ... */ }
+
     // Wait for any pending cpu-to-gpu operations in update() to complete
     void wait_for_update() const { m_fence.gpu_wait(); }
   };
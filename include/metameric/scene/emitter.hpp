@@ -16,6 +16,7 @@
 #pragma once
 
 #include <metameric/core/fwd.hpp>
+#include <metameric/core/distribution.hpp>
 #include <metameric/scene/detail/atlas.hpp>
 #include <metameric/scene/detail/utility.hpp>
 #include <small_gl/buffer.hpp>
@@ -97,12 +98,16 @@ namespace met {
       // This ignores spatially varying emitters r.n.
       gl::Buffer emitter_distr_buffer;
 
+      // CPU-side copy of the above sampling distribution, for cpu-side renderers
+      Distribution emitter_distr;
+
       // Alias data goes here
 
     public:
-      // Class constructor and update function handle GL-side data
-      SceneGLHandler();
+      // Update function handles GL-side data, which is allocated on first update;
+      // update_cache() only rebuilds emitter_distr
       void update(const Scene &) override;
+      void update_cache(const Scene &) override;
     };
 
     
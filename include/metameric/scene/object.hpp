@@ -123,8 +123,7 @@ namespace met {
       detail::TextureAtlas2d4f texture_brdf; 
     
     public:
-      // Class constructor and update function handle GL-side data
-      SceneGLHandler();
+      // Update function handles GL-side data, which is allocated on first update
       void update(const Scene &) override;
     };
 
@@ -73,9 +73,10 @@ namespace met::detail {
     std::vector<gl::MultiDrawInfo::DrawCommand> mesh_draw;
     
   public:
-    // Class constructor and update function handle GL-side data
-    SceneGLHandler();
+    // Update function handles GL-side data, which is allocated on first update;
+    // update_cache() only rebuilds mesh_cache
     void update(const Scene &) override;
+    void update_cache(const Scene &) override;
   };
   
   // Template specialization of SceneGLHandler.
@@ -110,8 +111,7 @@ namespace met::detail {
     detail::TextureAtlas2d1f texture_atlas_1f;
   
   public:
-    // Class constructor and update function handle GL-side data
-    SceneGLHandler();
+    // Update function handles GL-side data, which is allocated on first update
     void update(const Scene &) override;
 
     // SceneGLHandler<Uplifting> becomes friend as it bakes some texture data per-object
@@ -134,8 +134,7 @@ namespace met::detail {
     gl::TextureArray1d1f spec_texture;
 
   public:
-    // Class constructor and update function handle GL-side data
-    SceneGLHandler();
+    // Update function handles GL-side data, which is allocated on first update
     void update(const Scene &) override;
   };
   
@@ -153,8 +152,7 @@ namespace met::detail {
     gl::TextureArray1d3f cmfs_texture;
 
   public:
-    // Class constructor and update function handle GL-side data
-    SceneGLHandler();
+    // Update function handles GL-side data, which is allocated on first update
     void update(const Scene &) override;
   };
 
@@ -80,6 +80,10 @@ namespace met {
     // Update state-tracking and gl-side data from newest cpu-side data
     void update();
 
+    // Update state-tracking and cpu-side caches only; i.e. mesh BVHs, uplifting tessellations,
+    // and the emitter distribution. Does not touch the GL context, for headless use
+    void update_headless();
+
     // Wait for any pending cpu-to-gpu operations in update() to complete
     void wait_for_update() const;
     
@@ -131,6 +135,9 @@ namespace met {
   private: 
     // Handle to program shader cache, accessible to gl-side data builders;
     mutable ResourceHandle m_cache_handle;
+
+    // Shared implementation of update() and update_headless()
+    void update(bool gl_enabled);
     friend class detail::SceneGLHandler<Uplifting>::ObjectData;
     friend class detail::SceneGLHandler<Uplifting>::EmitterData;
     friend class detail::SceneGLHandler<Object>::ObjectData;
@@ -39,6 +39,16 @@ namespace met {
     // Render scaling used for scene viewport
     float view_scale   = .5f;
 
+    // Per-frame budget of mismatch volume solver work, in milliseconds, distributed over constraints
+    float solve_budget = 8.f;
+
+    // Spectral layout of cpu-side mismatch volume solves; the preview layout solves in fewer
+    // samples/bases, after which results are mapped back to the full layout
+    enum class SolveLayout {
+      eFull,   // Build layout, i.e. MET_WAVELENGTH_SAMPLES/MET_WAVELENGTH_BASES
+      ePreview // Preview layout, i.e. MET_PREVIEW_WAVELENGTH_SAMPLES/MET_PREVIEW_WAVELENGTH_BASES
+    } solve_layout = SolveLayout::eFull;
+
   public: // Boilerplate  
     auto operator<=>(const Settings &) const = default;
 
@@ -63,6 +73,8 @@ namespace met {
       SceneStateHandler<decltype(Settings::texture_size)>  texture_size;
       SceneStateHandler<decltype(Settings::view_i)>        view_i;
       SceneStateHandler<decltype(Settings::view_scale)>    view_scale;
+      SceneStateHandler<decltype(Settings::solve_budget)>  solve_budget;
+      SceneStateHandler<decltype(Settings::solve_layout)>  solve_layout;
 
     public:
       bool update(const Settings &o) override {
@@ -72,6 +84,8 @@ namespace met {
         | texture_size.update(o.texture_size)
         | view_i.update(o.view_i)
         | view_scale.update(o.view_scale)
+        | solve_budget.update(o.solve_budget)
+        | solve_layout.update(o.solve_layout)
         );
       }
     };
@@ -18,14 +18,21 @@
 #include <metameric/core/fwd.hpp>
 #include <metameric/scene/constraints.hpp>
 #include <metameric/core/convex.hpp>
+#include <metameric/core/solid_cache.hpp>
+#include <metameric/core/worker.hpp>
 #include <metameric/scene/detail/atlas.hpp>
+#include <metameric/scene/detail/scheduler.hpp>
 #include <metameric/scene/detail/utility.hpp>
 #include <small_gl/framebuffer.hpp>
 #include <small_gl/buffer.hpp>
 #include <small_gl/program.hpp>
 #include <small_gl/sampler.hpp>
 #include <small_gl/texture.hpp>
+#include <atomic>
 #include <deque>
+#include <memory>
+#include <mutex>
+#include <span>
 
 namespace met {
   // Forward declaration
@@ -33,9 +40,10 @@ namespace met {
   struct UpliftingVertex;
 
   // Spectral sample rates
-  constexpr static uint n_uplifting_boundary_samples      = 128u; // Color system boundary samples
-  constexpr static uint n_uplifting_mismatch_samples      = 256u; // Metamer mismatch volume samples
-  constexpr static uint n_uplifting_mismatch_samples_iter = 16u;  // Above, but per frame total
+  constexpr static uint n_uplifting_boundary_samples          = 128u; // Color system boundary samples
+  constexpr static uint n_uplifting_mismatch_samples          = 256u; // Metamer mismatch volume samples
+  constexpr static uint n_uplifting_mismatch_samples_iter_min = 4u;   // Above, lower limit per solver job
+  constexpr static uint n_uplifting_mismatch_samples_iter_max = 64u;  // Above, upper limit per solver job
 
   // Spectral uplifting data;
   // Formed by a color system whose spectral boundary is found, and whose interior is
@@ -53,8 +61,9 @@ namespace met {
 
   public: // Public methods
     // Generate N spectral samples on the color system boundary, using the spherical sampling
-    // method of Mackiewicz et al, 2019.
-    std::vector<MismatchSample> sample_color_solid(const Scene &scene, uint seed, uint n) const;
+    // method of Mackiewicz et al, 2019, alongside their convex hull. Output is cached 
+    // process-wide; see ColorSolidCache.
+    ColorSolidCache::entry_type sample_color_solid(const Scene &scene, uint seed, uint n) const;
 
   public: // Boilerplate
     bool operator==(const Uplifting &o) const;
@@ -86,6 +95,15 @@ namespace met {
     // w.r.t. the last internal constraint, which is a "free variable"
     std::vector<MismatchSample> realize_mismatch(const Scene &scene, const Uplifting &uplifting, uint seed, uint n) const;
 
+    // Realize the vertices of the constraint's current mismatch boundary, if said boundary is
+    // a convex polytope, i.e. for linear constraints; returns an empty vector otherwise
+    std::vector<MismatchSample> realize_mismatch_exact(const Scene &scene, const Uplifting &uplifting) const;
+
+    // Deferred variants of the above two methods; the returned jobs hold copies of the relevant
+    // scene data and can run off the main thread, and are empty if there is nothing to realize
+    MismatchJob prepare_mismatch(const Scene &scene, const Uplifting &uplifting, uint seed, uint n) const;
+    MismatchJob prepare_mismatch_exact(const Scene &scene, const Uplifting &uplifting) const;
+
     // Set/get the color value of the last constraint; this is the "free variable"
     // which the mismatch boundary encloses
     void set_mismatch_position(const Colr &c);
@@ -125,27 +143,80 @@ namespace met {
     // of helper classes to generate mismatch data, gl-side data, and bake textures.
     template <>
     struct SceneGLHandler<met::Uplifting> : public SceneGLHandlerBase {
+      class SolveScheduler; // fwd
+      
       // Helper object that
       // - iteratively builds mismatch volumes (MMVs) for constraints, eating the cost over several frames
       // - recovers constraint spectra through linear interpolation of the resulting convex structure
       // - exposes the mismatch volume hull data for the editor
       // which, alltogether, is faster and more stable than solving for constraint spectra directly.
+      // Sampling runs as jobs on a WorkerPool; each job works on a private copy of the builder's
+      // sample set, which is swapped in on a later realize() call. Jobs are tagged with the
+      // generation of the constraint they were submitted for, and discarded once it is replaced.
       class MetamerBuilder {
         using cnstr_type = typename Uplifting::Vertex::cnstr_type;
+        friend class SolveScheduler;
+
+        // Sample set and resulting convex hull; the front copy is held by the builder, 
+        // the back copy is modified by a job and handed over through the mailbox
+        struct State {
+          bool                       is_exact     = false;
+          std::deque<MismatchSample> samples      = { };
+          uint                       samples_curr = 0;
+          uint                       samples_prev = 0;
+          float                      sample_cost  = 0.f; // Measured per-sample cost of the last job, in ms
+          IncrementalConvexHull      hull;
+
+          // Insert newly generated MMV boundary samples, and retire old ones
+          void insert_samples(std::span<const MismatchSample> new_samples);
+        };
+
+        // Shared between builder and in-flight jobs
+        struct Mailbox {
+          std::mutex           mutex;
+          std::optional<State> ready;          // Completed back state, awaiting swap to front
+          std::atomic<uint>    generation = 0; // Bumped when the mismatch volume is invalidated
+          std::stop_source     stop;           // Stopped and replaced alongside generation bumps
+        };
+
+        // Fallback solver output for constraints without mismatching, and the solve's inputs
+        struct SolveCache {
+          cnstr_type     cnstr;
+          eig::Array3u   csys; // basis_i, observer_i, illuminant_i of the uplifting
+          MismatchSample sample;
+        };
 
         bool  	                   m_did_sample   = false;
+        bool                       m_did_solve    = false;
+        bool                       m_is_exact     = false;
+        bool                       m_is_pending   = false; // A job for the current generation is in flight
         std::deque<MismatchSample> m_samples      = { };
         uint                       m_samples_curr = 0;
         uint                       m_samples_prev = 0;
+        uint                       m_sequence_i   = 0;     // Running index into the vertex' direction sequence
+        bool                       m_wants_submit = false; // Builder awaits a job from SolveScheduler
+        float                      m_sample_cost  = 0.f;   // Running mean of per-sample job cost in ms; 0 if unmeasured
+        uint                       m_last_served  = 0;     // SolveScheduler frame in which a job was last submitted
         std::optional<cnstr_type>  m_cnstr_cache;
+        std::shared_ptr<Mailbox>   m_mailbox      = std::make_shared<Mailbox>();
+        std::optional<SolveCache>  m_solve_cache;
 
-        // Insert newly generated MMV boundary samples, and retire old ones
-        void insert_samples(std::span<const MismatchSample> new_samples);
+        // Discard all samples and invalidate in-flight jobs
+        void reset();
+
+        // Invalidate in-flight jobs and their unclaimed results, as the mismatch volume changed
+        void invalidate();
+
+        // Swap in the back state if a job completed; returns whether this happened
+        bool poll();
 
       public:
         // Get a spectral sample for the given uplifting constraint over which this MMV is defined;
-        // also returns whether the sample is equal to the previous sample
-        MismatchSample realize(const Scene &scene, uint uplifting_i, uint vertex_i);
+        // new samples are generated on the pool by jobs from submit(), and become available on later calls
+        MismatchSample realize(WorkerPool &pool, const Scene &scene, uint uplifting_i, uint vertex_i);
+
+        // Submit a job generating n new samples for the given vertex; called by SolveScheduler
+        void submit(WorkerPool &pool, const Scene &scene, const Uplifting &uplifting, const Uplifting::Vertex &vert, uint n);
 
         // Test if the vertex at vertex_i results in the same mismatch region
         // as the current sample set for a cached constraint
@@ -154,19 +225,41 @@ namespace met {
         // Set the cached constraint to produce a mismatch volume for a given vertex
         void set_vertex(const Scene &scene, uint uplifting_i, uint vertex_i);
 
-        // Builder has reached the required sample count and should just regurgitate the current result
+        // Builder has reached the required sample count, or holds the exact volume, 
+        // and should just regurgitate the current result
         bool is_converged() const {
-          return (hull.deln.verts.size() - m_samples_prev) >= n_uplifting_mismatch_samples;
+          return m_is_exact || (hull.deln.verts.size() - m_samples_prev) >= n_uplifting_mismatch_samples;
         }
 
         // Builder generated new samples, meaning the output of realize() also changed
         bool did_sample() const {
           return m_did_sample;
         }
+
+        // Builder fell back to a solver run during the last realize(), as its cached
+        // solver output did not match the constraint
+        bool did_solve() const {
+          return m_did_solve;
+        }
+
+        // Builder is not converged and has no job in flight, as of the last realize()
+        bool wants_submit() const {
+          return m_wants_submit;
+        }
+
+        // Running mean of per-sample solver cost in ms, or 0 if no job has completed yet
+        float sample_cost() const {
+          return m_sample_cost;
+        }
+
+        // Scheduler frame in which this builder last had a job submitted
+        uint last_served() const {
+          return m_last_served;
+        }
         
       public: 
         // Expose generated convex hull structure for editors
-        ConvexHull hull;
+        IncrementalConvexHull hull;
       };
 
       // Helper object that
@@ -209,19 +302,47 @@ namespace met {
         std::vector<MismatchSample> interior;
         std::vector<MismatchSample> boundary_and_interior;
 
+        // Convex hull over boundary colors; shared with other upliftings through ColorSolidCache
+        Mesh boundary_hull;
+
+        // Nr. of fallback solver runs by metamer builders during the last update; in a static
+        // scene, this drops to zero once all constraints are realized
+        uint n_solves = 0;
+
         // R^3 delaunay tessellation resulting from the connected boundary and interior vertices
         AlDelaunay tessellation;
 
+        // Point-location structure over the tessellation, rebuilt alongside it
+        TetrahedronLocator tessellation_locator;
+
         // Buffers made available for use in update_object_texture
         gl::Buffer buffer_bary; // tetrahedron baycentric data
         gl::Buffer buffer_coef; // tetrahedron coefficient data
 
       public:
         UpliftingData(uint uplifting_i);
-        void update(const Scene &scene);
+        void update(const Scene &scene, WorkerPool &pool);
+
+        // Only run the cpu-side part of update(); generate spectral data and tessellation, 
+        // and return whether the gl-side packed data would have to be updated
+        bool update_cache(const Scene &scene, WorkerPool &pool);
 
         // Helper function to find some tetrahedron info, given an input position inside the tesselation
         std::pair<eig::Vector4f, uint> find_enclosing_tetrahedron(const eig::Vector3f &p) const;
+
+        // Batched variant of find_enclosing_tetrahedron(), for many positions at once
+        std::vector<std::pair<eig::Vector4f, uint>> find_enclosing_tetrahedron(std::span<const Colr> p) const;
+      };
+
+      // Helper object that distributes a per-frame budget of solver time, Settings::solve_budget,
+      // over the metamer builders of all upliftings; builders of vertices that are being edited
+      // are served first. Job sizing itself is handled by detail::BudgetScheduler
+      class SolveScheduler {
+        BudgetScheduler m_scheduler;
+
+      public:
+        // Submit jobs for all builders awaiting one, within the frame budget
+        void dispatch(const Scene &scene, std::span<UpliftingData> uplifting_data, WorkerPool &pool);
       };
 
       // Helper object that
@@ -293,10 +414,18 @@ namespace met {
       // Array texture; each layer holds one of 12 basis function spectra
       gl::TextureArray1d1f texture_basis;
 
+      // Background threads on which MetamerBuilder runs mismatch volume sampling, off the frame loop
+      WorkerPool worker_pool;
+
+      // Distributes solver work on worker_pool over metamer builders
+      SolveScheduler solve_scheduler;
+
     public:
-      // Class constructor and update function handle GL-side data
+      // Class constructor and update function handle GL-side data;
+      // update_cache() only generates uplifting_data, without texture bakes
       SceneGLHandler();
       void update(const Scene &) override;
+      void update_cache(const Scene &) override;
     };
 
     // Template specialization of SceneStateHandler that exposes fine-grained
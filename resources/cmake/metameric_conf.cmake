@@ -1,10 +1,29 @@
 cmake_minimum_required(VERSION 3.22)
 
-# Spectral layout; inserted in code/shaders as preprocessor defines
+# Spectral layout; inserted in code/shaders as preprocessor defines. Samples and bases are cache
+# variables, s.t. a build can trade accuracy for speed. Besides Spec/CMFS/Basis, this layout sizes 
+# the compiled shaders, GPU buffer layouts, and coefficient packing, and is fixed per build
 set(MET_WAVELENGTH_MIN     380) # Minimum wavelength of spectral range
 set(MET_WAVELENGTH_MAX     780) # Maximum wavelength of spectral range
-set(MET_WAVELENGTH_SAMPLES  64) # Nr. of bins used in discrete spectral representations
-set(MET_WAVELENGTH_BASES    12) # Maximum nr. of bases used in generative functions
+set(MET_WAVELENGTH_SAMPLES  64 CACHE STRING "Nr. of bins used in discrete spectral representations")
+set(MET_WAVELENGTH_BASES    12 CACHE STRING "Maximum nr. of bases used in generative functions")
+set_property(CACHE MET_WAVELENGTH_BASES PROPERTY STRINGS 8 12 16)
+
+# Reduced spectral layout, in which the CPU-side solvers are also instantiated; selected at runtime
+# through Settings::solve_layout, e.g. for interactive previews. Not used by shaders or GPU buffers
+set(MET_PREVIEW_WAVELENGTH_SAMPLES 16) # Nr. of bins used in preview spectral representations
+set(MET_PREVIEW_WAVELENGTH_BASES    8) # Nr. of bases used in preview generative functions
+
+# Validate spectral layout; shaders only implement coefficient packing for 8, 12, or 16 bases
+if(NOT MET_WAVELENGTH_BASES MATCHES "^(8|12|16)$")
+  message(FATAL_ERROR "Metameric : MET_WAVELENGTH_BASES must be one of 8, 12, 16")
+endif()
+if(NOT MET_WAVELENGTH_SAMPLES GREATER MET_WAVELENGTH_BASES)
+  message(FATAL_ERROR "Metameric : MET_WAVELENGTH_SAMPLES must exceed MET_WAVELENGTH_BASES")
+endif()
+if(MET_PREVIEW_WAVELENGTH_SAMPLES GREATER MET_WAVELENGTH_SAMPLES OR MET_PREVIEW_WAVELENGTH_BASES GREATER MET_WAVELENGTH_BASES)
+  message(FATAL_ERROR "Metameric : preview spectral layout must not exceed the build's spectral layout")
+endif()
 
 # Some object limits for renderer; inserted in code/shaders as preprocessor defines
 set(MET_SUPPORTED_MESHES        32) # Maximum supported scene meshes
@@ -16,10 +35,12 @@ set(MET_SUPPORTED_CONSTRAINTS  512) # Maximum supported boundary + interior spec
 # Print configuration info
 message(STATUS "Metameric : Enabling exceptions = ${MET_ENABLE_EXCEPTIONS}")
 message(STATUS "Metameric : Enabling Tracy      = ${MET_ENABLE_TRACY}")
+message(STATUS "Metameric : Building tests      = ${MET_BUILD_TESTS}")
 message(STATUS "Metameric : Wavelength min.     = ${MET_WAVELENGTH_MIN}")
 message(STATUS "Metameric : Wavelength max.     = ${MET_WAVELENGTH_MAX}")
 message(STATUS "Metameric : Wavelength samples  = ${MET_WAVELENGTH_SAMPLES}")
 message(STATUS "Metameric : Wavelength bases    = ${MET_WAVELENGTH_BASES}")
+message(STATUS "Metameric : Preview layout      = ${MET_PREVIEW_WAVELENGTH_SAMPLES}/${MET_PREVIEW_WAVELENGTH_BASES}")
 
 # Embed the above in a preprocessor define list
 set(MET_PREPROCESSOR_DEFINES
@@ -27,6 +48,8 @@ set(MET_PREPROCESSOR_DEFINES
   -DMET_WAVELENGTH_MAX=${MET_WAVELENGTH_MAX} 
   -DMET_WAVELENGTH_SAMPLES=${MET_WAVELENGTH_SAMPLES} 
   -DMET_WAVELENGTH_BASES=${MET_WAVELENGTH_BASES} 
+  -DMET_PREVIEW_WAVELENGTH_SAMPLES=${MET_PREVIEW_WAVELENGTH_SAMPLES}
+  -DMET_PREVIEW_WAVELENGTH_BASES=${MET_PREVIEW_WAVELENGTH_BASES}
   -DMET_SUPPORTED_MESHES=${MET_SUPPORTED_MESHES}
   -DMET_SUPPORTED_OBJECTS=${MET_SUPPORTED_OBJECTS}
   -DMET_SUPPORTED_EMITTERS=${MET_SUPPORTED_EMITTERS}
@@ -70,4 +93,18 @@ function(met_reuse_pch target_name other_names)
   foreach(other_name ${other_names})
     target_precompile_headers(${target_name} REUSE_FROM ${other_name})
   endforeach()
+endfunction()
+
+# Helper function to add a headless test executable from /tests/<test_name>.cpp, registered with ctest
+function(met_add_test test_name link_names)
+  add_executable(${test_name} 
+    ${CMAKE_CURRENT_SOURCE_DIR}/tests/${test_name}.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/tests/main.cpp)
+  add_dependencies(${test_name} metameric_data_copy)
+  target_include_directories(${test_name} PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests)
+  target_compile_features(${test_name} PUBLIC cxx_std_23)
+  target_link_libraries(${test_name} PRIVATE ${link_names})
+  add_test(NAME ${test_name} 
+           COMMAND ${test_name} 
+           WORKING_DIRECTORY ${CMAKE_RUNTIME_OUTPUT_DIRECTORY})
 endfunction()
\ No newline at end of file
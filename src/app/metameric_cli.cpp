@@ -0,0 +1,304 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <metameric/core/io.hpp>
+#include <metameric/core/math.hpp>
+#include <metameric/core/solid_cache.hpp>
+#include <metameric/core/utility.hpp>
+#include <metameric/scene/scene.hpp>
+#include <metameric/render/cpu_render.hpp>
+#include <metameric/render/sensor.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <numbers>
+#include <string_view>
+#include <thread>
+
+namespace met {
+  // Batch stages; each stage implies the ones before it, e.g. a bake first runs the uplifting
+  enum class MetamericCLIStage { eUplift, eMismatch, eBake, eRender };
+
+  // Application create settings
+  struct MetamericCLIInfo {
+    // Stage to run, and the scenes to run it on
+    MetamericCLIStage     stage       = MetamericCLIStage::eUplift;
+    std::vector<fs::path> scene_paths = { };
+
+    // Output directory; per scene, a subdirectory named after the scene is created
+    fs::path out_path = "output";
+
+    // Uplifting is iterated until all mismatch volumes converge, or until this many passes
+    uint uplift_max_iters = 16384;
+
+    // Samples per pixel for the render stage
+    uint render_spp = 64;
+
+    // On-disk color solid cache, shared between runs; disabled if left empty
+    fs::path solid_cache_path = "";
+
+    // Fail if a static scene still runs fallback solves once the uplifting has converged
+    bool check_static = false;
+
+    // Solve mismatch volumes in the reduced preview layout, overriding the scene's settings
+    bool preview_layout = false;
+  };
+
+  namespace detail {
+    // Run a stage, and print its wall-clock time
+    void run_timed(std::string_view name, auto &&f) {
+      auto t_start = std::chrono::steady_clock::now();
+      f();
+      auto t_end   = std::chrono::steady_clock::now();
+      fmt::print("  {:<8} : {} ms\n", name,
+        std::chrono::duration_cast<std::chrono::milliseconds>(t_end - t_start).count());
+    }
+
+    // Test whether the mismatch volumes of all active, mismatching vertex constraints have converged
+    bool is_uplifting_converged(const Scene &scene) {
+      met_trace();
+      const auto &upliftings = scene.components.upliftings;
+      for (uint i = 0; i < upliftings.size(); ++i) {
+        const auto &uplifting = upliftings[i].value;
+        const auto &data      = upliftings.gl.uplifting_data[i];
+        for (uint j = 0; j < uplifting.verts.size(); ++j) {
+          const auto &vert = uplifting.verts[j];
+          guard_continue(vert.is_active && vert.has_mismatching(scene, uplifting));
+          guard(data.metamer_builders[j].is_converged(), false);
+        }
+      }
+      return true;
+    }
+
+    // Generate uplifting data on the cpu; mismatch volume generation is spread over repeated
+    // update passes, exactly as in the editor, so we keep going until these have converged
+    void run_uplift(Scene &scene, const MetamericCLIInfo &info) {
+      met_trace();
+      uint iter = 0;
+      for (; iter < info.uplift_max_iters; ++iter) {
+        scene.update_headless();
+        guard_break(!is_uplifting_converged(scene));
+
+        // Sampling jobs run on the scene's worker pool; yield for a bit before polling again
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      if (iter == info.uplift_max_iters)
+        fmt::print("  uplifting did not converge after {} passes\n", iter);
+
+      // A static scene should perform no further solver runs after warm-up; run a few more 
+      // passes, and count the fallback solves these perform
+      uint n_solves = 0;
+      for (uint i = 0; i < 4; ++i) {
+        scene.update_headless();
+        for (const auto &data : scene.components.upliftings.gl.uplifting_data)
+          n_solves += data.n_solves;
+      }
+      fmt::print("  uplifting ran {} fallback solves after warm-up\n", n_solves);
+      debug::check_expr(!info.check_static || n_solves == 0,
+        fmt::format("Static scene ran {} fallback solves after warm-up", n_solves));
+    }
+
+    // Write the mismatch volume hulls of each vertex constraint to .obj files
+    void run_mismatch(const Scene &scene, const fs::path &out_path) {
+      met_trace();
+      const auto &upliftings = scene.components.upliftings;
+      for (uint i = 0; i < upliftings.size(); ++i) {
+        const auto &data = upliftings.gl.uplifting_data[i];
+        for (const auto &[j, builder] : enumerate_view(data.metamer_builders)) {
+          const auto &hull = builder.hull.hull;
+          guard_continue(!hull.empty());
+
+          std::string str;
+          for (const auto &v : hull.verts)
+            str += fmt::format("v {} {} {}\n", v.x(), v.y(), v.z());
+          for (const auto &el : hull.elems)
+            str += fmt::format("f {} {} {}\n", el.x() + 1, el.y() + 1, el.z() + 1);
+          io::save_string(out_path / fmt::format("mmv_{}_{}.obj", i, j), str);
+        } // for (j, builder)
+      } // for (uint i)
+    }
+
+    // Bake per-object coefficient textures on the cpu, and write these to .exr files; this follows
+    // the gpu-side bake in SceneGLHandler<Uplifting>::ObjectData, but locates texels through the
+    // uplifting's tessellation instead of a brute-force search. Coefficients are packed as 4 per
+    // rgba image, so there are ceil(bases / 4) images per object
+    void run_bake(const Scene &scene, const fs::path &out_path) {
+      met_trace();
+      const auto &objects  = scene.components.objects;
+      const auto &settings = scene.components.settings;
+      for (uint i = 0; i < objects.size(); ++i) {
+        const auto &object = objects[i].value;
+        const auto &data   = scene.components.upliftings.gl.uplifting_data[object.uplifting_i];
+        guard_continue(object.is_active);
+
+        // Determine bake resolution and gather per-texel albedo; textured albedo follows the
+        // texture size setting, while a specified albedo value gets a small constant patch
+        eig::Array2u      size;
+        std::vector<Colr> colr;
+        if (auto *albedo = std::get_if<uint>(&object.albedo)) {
+          const auto &image = scene.resources.images[*albedo].value();
+          size = settings->apply_texture_size(image.size()).max(2u).eval();
+          colr.resize(size.prod());
+          #pragma omp parallel for
+          for (int j = 0; j < colr.size(); ++j) {
+            eig::Array2u xy = { j % size.x(), j / size.x() };
+            eig::Array2f uv = object.uv_offset
+                            + object.uv_extent * (xy.cast<float>() + .5f) / size.cast<float>();
+            colr[j] = image.sample(uv, Image::ColorFormat::eLRGB).head<3>();
+          }
+        } else {
+          size = settings->apply_texture_size(eig::Array2u(16)).max(2u).eval();
+          colr.resize(size.prod(), std::get<Colr>(object.albedo));
+        }
+
+        // Locate texels in the tessellation, and interpolate vertex coefficients
+        auto tetrs = data.find_enclosing_tetrahedron(colr);
+        std::vector<Basis::vec_type> coef(tetrs.size());
+        #pragma omp parallel for
+        for (int j = 0; j < coef.size(); ++j) {
+          const auto &[bary, tetr] = tetrs[j];
+          const auto &el = data.tessellation.elems[tetr];
+          coef[j] = Basis::vec_type::Zero();
+          for (uint k = 0; k < 4; ++k)
+            coef[j] += bary[k] * data.boundary_and_interior[el[k]].coef;
+        }
+
+        // Pack coefficients into rgba images, and write these out
+        for (uint k = 0; k < ceil_div(wavelength_bases, 4u); ++k) {
+          std::vector<eig::Array4f> pixels(coef.size(), eig::Array4f::Zero());
+          for (uint j = 0; j < coef.size(); ++j)
+            for (uint c = 0; c < 4 && 4 * k + c < wavelength_bases; ++c)
+              pixels[j][c] = coef[j][4 * k + c];
+          Image({ .pixel_frmt = Image::PixelFormat::eRGBA,
+                  .pixel_type = Image::PixelType::eFloat,
+                  .size       = size,
+                  .data       = cnt_span<const std::byte>(pixels) })
+            .save_exr(out_path / fmt::format("coef_{}_{}.exr", i, k));
+        } // for (uint k)
+      } // for (uint i)
+    }
+
+    // Render each scene view through the cpu path tracer, and write the results to .exr files;
+    // camera setup follows the editor's render export
+    void run_render(const Scene &scene, const fs::path &out_path, uint spp) {
+      met_trace();
+      const auto &views = scene.components.views;
+      for (uint i = 0; i < views.size(); ++i) {
+        const auto &view = views[i].value;
+
+        eig::Affine3f trf_rot = eig::Affine3f::Identity();
+        trf_rot *= eig::AngleAxisf(view.camera_trf.rotation.x(), eig::Vector3f::UnitY());
+        trf_rot *= eig::AngleAxisf(view.camera_trf.rotation.y(), eig::Vector3f::UnitX());
+        trf_rot *= eig::AngleAxisf(view.camera_trf.rotation.z(), eig::Vector3f::UnitZ());
+
+        auto dir = (trf_rot * eig::Vector3f(0, 0, 1)).normalized().eval();
+        auto cen = (view.camera_trf.position + dir).eval();
+
+        Sensor sensor;
+        sensor.film_size       = view.film_size;
+        sensor.view_trf        = eig::lookat_rh(view.camera_trf.position, cen, eig::Vector3f::UnitY()).matrix();
+        sensor.proj_trf        = eig::perspective_rh_no(view.camera_fov_y * std::numbers::pi_v<float> / 180.f,
+                                                        static_cast<float>(view.film_size.x()) / static_cast<float>(view.film_size.y()),
+                                                        0.001f, 1000.f).matrix();
+        sensor.aperture_radius = view.camera_aperture_r;
+        sensor.focus_distance  = view.camera_focus_distance;
+
+        CPUPathRenderer renderer({ .spp_max = spp });
+        renderer.render(sensor, scene).save_exr(out_path / fmt::format("{}.exr", views[i].name));
+      } // for (uint i)
+    }
+  } // namespace detail
+
+  // Application create function
+  void metameric_cli(MetamericCLIInfo info) {
+    met_trace();
+
+    fmt::print(
+      "Starting Metameric CLI\n  range   : {}-{} nm\n  samples : {}\n  bases   : {}\n",
+      wavelength_min, wavelength_max, wavelength_samples, wavelength_bases);
+    if (info.preview_layout)
+      fmt::print("  preview : {}/{}\n", preview_wavelength_samples, preview_wavelength_bases);
+
+    // Color system boundaries are shared between scenes in this run, and between runs if requested
+    ColorSolidCache::instance().set_info({ .cache_dir = info.solid_cache_path });
+
+    for (const auto &scene_path : info.scene_paths) {
+      fmt::print("Processing {}\n", scene_path.string());
+
+      // Output goes to a per-scene subdirectory
+      fs::path out_path = info.out_path / scene_path.stem();
+      fs::create_directories(out_path);
+
+      // Scene data is held without a program cache, as no GL context exists
+      Scene scene({ });
+      detail::run_timed("load", [&] { scene.load(scene_path); });
+      if (info.preview_layout)
+        scene.components.settings.value.solve_layout = Settings::SolveLayout::ePreview;
+      detail::run_timed("uplift", [&] { detail::run_uplift(scene, info); });
+
+      if (info.stage == MetamericCLIStage::eMismatch)
+        detail::run_timed("mismatch", [&] { detail::run_mismatch(scene, out_path); });
+      if (info.stage == MetamericCLIStage::eBake)
+        detail::run_timed("bake", [&] { detail::run_bake(scene, out_path); });
+      if (info.stage == MetamericCLIStage::eRender)
+        detail::run_timed("render", [&] { detail::run_render(scene, out_path, info.render_spp); });
+    }
+  }
+} // namespace met
+
+// Application entry point
+int main(int argc, char **argv) {
+  using namespace met;
+  constexpr auto usage = "Usage: metameric_cli <uplift|mmv|bake|render> [--out <dir>] [--spp <n>] [--cache <dir>] [--check-static] [--preview] <scene.json>...\n";
+
+  try {
+    std::vector<std::string_view> args(argv + 1, argv + argc);
+    if (args.empty()) {
+      fmt::print(stderr, usage);
+      return EXIT_FAILURE;
+    }
+
+    // Parse stage, options, and scene paths
+    MetamericCLIInfo info;
+    if      (args[0] == "uplift") info.stage = MetamericCLIStage::eUplift;
+    else if (args[0] == "mmv")    info.stage = MetamericCLIStage::eMismatch;
+    else if (args[0] == "bake")   info.stage = MetamericCLIStage::eBake;
+    else if (args[0] == "render") info.stage = MetamericCLIStage::eRender;
+    else debug::check_expr(false, fmt::format("Unknown stage \"{}\"", args[0]));
+    for (uint i = 1; i < args.size(); ++i) {
+      if (args[i] == "--out" && i + 1 < args.size())
+        info.out_path = args[++i];
+      else if (args[i] == "--spp" && i + 1 < args.size())
+        info.render_spp = std::stoul(std::string(args[++i]));
+      else if (args[i] == "--cache" && i + 1 < args.size())
+        info.solid_cache_path = args[++i];
+      else if (args[i] == "--check-static")
+        info.check_static = true;
+      else if (args[i] == "--preview")
+        info.preview_layout = true;
+      else
+        info.scene_paths.push_back(args[i]);
+    }
+    if (info.scene_paths.empty()) {
+      fmt::print(stderr, usage);
+      return EXIT_FAILURE;
+    }
+
+    met::metameric_cli(info);
+  } catch (const std::exception &e) {
+    fmt::print(stderr, "{}\n", e.what());
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
\ No newline at end of file
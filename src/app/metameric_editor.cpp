@@ -13,6 +13,7 @@
 // You should have received a copy of the GNU General Public License
 // along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
+#include <metameric/core/solid_cache.hpp>
 #include <metameric/core/utility.hpp>
 #include <metameric/scene/scene.hpp>
 #include <metameric/editor/schedule.hpp>
@@ -35,6 +36,9 @@ namespace met {
     // Shader cache path
     fs::path shader_path = "shaders/shaders.bin";
 
+    // Color solid cache path; boundary samples are reused across sessions
+    fs::path solid_cache_path = "cache/solids";
+
     // Window settings
     eig::Array2u app_size  = { 1800, 1024 };
     std::string  app_title = "Metameric Editor";
@@ -77,6 +81,9 @@ namespace met {
     if (!info.shader_path.empty() && fs::exists(info.shader_path))
       scheduler.global("cache").getw<gl::ProgramCache>().load(info.shader_path);
 
+    // Enable on-disk tier of color solid cache, if a path is specified
+    ColorSolidCache::instance().set_info({ .cache_dir = info.solid_cache_path });
+
     // Initialize scene data as resources owned by the scheduler
     // load from file if a path is specified
     scheduler.global("scene").set<Scene>(scheduler.global("cache"));
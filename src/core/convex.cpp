@@ -14,42 +14,33 @@
 // along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include <metameric/core/convex.hpp>
+#include <metameric/core/distribution.hpp>
 #include <metameric/core/mesh.hpp>
 #include <metameric/core/ranges.hpp>
 #include <execution>
+#include <numeric>
+#include <unordered_map>
 
 namespace met {
   template <typename Vt>
   std::pair<eig::Array4f, eig::Array4u> ConvexHullBase<Vt>::find_enclosing_elem(const Vt &v) const {
     met_trace();
-    debug::check_expr(has_delaunay());
+    debug::check_expr(has_delaunay() && !locator.empty());
     
     // We find best closest enclosing simplex through minimized error in barycentric coordinates;
     // if there is no enclosing simplex (as the point is exterior), this finds the closest. Otherwise,
     // error is zero for the correct simplex
-    float        result_err = std::numeric_limits<float>::max();
-    uint         result_i   = 0;
-    eig::Array4f result_bry = 0;
+    auto [bry, i] = locator.locate(v.matrix());
+    return { bry, deln.elems[i] };
+  }
 
-    // Iterate all elements
-    for (const auto &[i, el] : enumerate_view(deln.elems)) {
-      const auto &vts = el | index_into_view(deln.verts);
-      
-      auto xyz = ((eig::Matrix3f() << vts[0] - vts[3], 
-                                      vts[1] - vts[3], 
-                                      vts[2] - vts[3]).finished().inverse()
-                * (v - vts[3]).matrix()).eval();
-      auto bry = (eig::Array4f() << xyz, 1.f - xyz.sum()).finished();
-
-      // Check if this simplex is a better candidate
-      float err = (bry - bry.cwiseMax(0.f).cwiseMin(1.f)).matrix().squaredNorm();
-      guard_continue(err < result_err);
-      result_err = err;
-      result_i   = i;
-      result_bry = bry;
-    }
-    
-    return { result_bry, deln.elems[result_i] };
+  template <typename Vt>
+  std::vector<std::pair<eig::Array4f, eig::Array4u>> ConvexHullBase<Vt>::find_enclosing_elem(std::span<const Vt> v) const {
+    met_trace();
+    debug::check_expr(has_delaunay() && !locator.empty());
+    return locator.locate(v) 
+         | vws::transform([&](const auto &p) { return std::pair { p.first, deln.elems[p.second] }; }) 
+         | view_to<std::vector<std::pair<eig::Array4f, eig::Array4u>>>();
   }
 
   template <typename Vt>
@@ -128,9 +119,306 @@ namespace met {
         deln = generate_delaunay<MeshBase<Vt, typename deln_type::elem_type>, Vt>(info.data);
         break;
     }
+    if (has_delaunay())
+      locator = TetrahedronLocator(deln);
+  }
+
+  template <typename Vt>
+  bool IncrementalConvexHullBase<Vt>::init_simplex(std::span<const uint> points) {
+    met_trace();
+    guard(points.size() >= 4, false);
+
+    // Tolerance is scaled to the extent of the input
+    eig::Vector3d minb = m_verts[points[0]], maxb = minb;
+    for (uint i : points) {
+      minb = minb.cwiseMin(m_verts[i]);
+      maxb = maxb.cwiseMax(m_verts[i]);
+    }
+    m_eps = 1e-6 * (maxb - minb).maxCoeff();
+    guard(m_eps > 0.0, false);
+
+    // Helper; find point maximizing some distance
+    auto argmax = [&](auto f) {
+      return *rng::max_element(points, {}, [&](uint i) { return f(m_verts[i]); });
+    };
+    
+    // Select extremal points forming a non-degenerate simplex; first along the largest axis, 
+    // then farthest from the resulting point, line, and plane
+    uint axis; (maxb - minb).maxCoeff(&axis);
+    uint i0 = argmax([&](const auto &v) { return -v[axis]; });
+    uint i1 = argmax([&](const auto &v) { return (v - m_verts[i0]).squaredNorm(); });
+    eig::Vector3d e = (m_verts[i1] - m_verts[i0]).normalized();
+    uint i2 = argmax([&](const auto &v) { return e.cross(v - m_verts[i0]).squaredNorm(); });
+    eig::Vector3d n = e.cross(m_verts[i2] - m_verts[i0]);
+    guard(n.norm() > m_eps, false);
+    n.normalize();
+    uint i3 = argmax([&](const auto &v) { return std::abs(n.dot(v - m_verts[i0])); });
+    guard(std::abs(n.dot(m_verts[i3] - m_verts[i0])) > m_eps, false);
+
+    // Orient s.t. the normal of (i0, i1, i2) points away from i3
+    if (n.dot(m_verts[i3] - m_verts[i0]) > 0.0)
+      std::swap(i1, i2);
+    
+    // Add tetrahedron and its four outward facets, ordered by opposing vertex
+    eig::Array4u el = { i0, i1, i2, i3 };
+    std::array<eig::Array3u, 4> facets = {
+      eig::Array3u { i1, i3, i2 }, eig::Array3u { i2, i3, i0 }, 
+      eig::Array3u { i0, i3, i1 }, eig::Array3u { i0, i1, i2 }
+    };
+    for (const auto &elem : facets) {
+      eig::Vector3d n = (m_verts[elem[1]] - m_verts[elem[0]])
+                 .cross(m_verts[elem[2]] - m_verts[elem[0]]).normalized();
+      m_facets.push_back({ .elem = elem, .tetr = 0, .n = n, .d = n.dot(m_verts[elem[0]]), .is_alive = true });
+    }
+
+    // Connect facets across shared, oppositely oriented edges
+    for (uint f = 0; f < 4; ++f) {
+      for (uint k = 0; k < 3; ++k) {
+        uint u = facets[f][k], v = facets[f][(k + 1) % 3];
+        for (uint g = 0; g < 4; ++g) {
+          guard_continue(g != f);
+          for (uint j = 0; j < 3; ++j) {
+            guard_continue(facets[g][j] == v && facets[g][(j + 1) % 3] == u);
+            m_facets[f].adjc[k] = g;
+          }
+        }
+      }
+    }
+
+    this->deln.elems.push_back(el);
+    m_adjc.push_back({ ~0, ~1, ~2, ~3 });
+    m_marks.resize(m_facets.size(), 0);
+    m_last = 0;
+    return true;
+  }
+
+  template <typename Vt>
+  int IncrementalConvexHullBase<Vt>::find_visible_facet(const eig::Vector3d &p) const {
+    met_trace();
+
+    // Walk through the tesselation towards p, crossing a face whose plane separates p from the 
+    // tetrahedron. Face order is shuffled per step, as deterministic walks may cycle in 
+    // non-Delaunay tesselations. The walk ends inside a tetrahedron, or on a hull facet p sees
+    constexpr uint max_steps = 1024;
+    PCGEngine engine(m_last);
+    uint t = m_last;
+    for (uint step = 0; step < max_steps; ++step) {
+      const auto &el = this->deln.elems[t];
+      int  next = -1;
+      uint offs = engine() % 4;
+      for (uint j = 0; j < 4; ++j) {
+        uint k = (j + offs) % 4;
+
+        // Test if p lies on the other side of face k than the opposing vertex
+        const auto &a = m_verts[el[(k + 1) % 4]], &b = m_verts[el[(k + 2) % 4]], &c = m_verts[el[(k + 3) % 4]];
+        eig::Vector3d n = (b - a).cross(c - a);
+        guard_continue(n.dot(p - a) * n.dot(m_verts[el[k]] - a) < 0.0);
+        
+        // Continue walk across interior faces, or return hull facets that are visible
+        if (int adjc = m_adjc[t][k]; adjc >= 0) {
+          next = adjc;
+          break;
+        } else if (const auto &f = m_facets[~adjc]; f.n.dot(p) - f.d > m_eps) {
+          return ~adjc;
+        }
+      }
+
+      // Point lies inside this tetrahedron, or within tolerance of the hull
+      guard(next >= 0, -1);
+      t = next;
+    }
+
+    // Walk did not terminate; fall back to testing all facets
+    for (uint f = 0; f < m_facets.size(); ++f)
+      if (m_facets[f].is_alive && m_facets[f].n.dot(p) - m_facets[f].d > m_eps)
+        return f;
+    return -1;
+  }
+
+  template <typename Vt>
+  bool IncrementalConvexHullBase<Vt>::insert_point(uint i, uint facet_i, std::vector<uint> &orphans) {
+    met_trace();
+
+    const auto &p = m_verts[i];
+    auto is_visible = [&](uint f) { return m_facets[f].n.dot(p) - m_facets[f].d > m_eps; };
+
+    // Flood-fill the region of facets visible from p; record horizon edges
+    // as (facet, edge) pairs on the visible side
+    std::vector<uint>                 visible = { facet_i };
+    std::vector<std::pair<uint,uint>> horizon;
+    m_marks[facet_i] = ++m_mark;
+    for (uint j = 0; j < visible.size(); ++j) {
+      for (uint k = 0; k < 3; ++k) {
+        uint g = m_facets[visible[j]].adjc[k];
+        guard_continue(m_marks[g] != m_mark);
+        if (is_visible(g)) {
+          m_marks[g] = m_mark;
+          visible.push_back(g);
+        } else {
+          horizon.push_back({ visible[j], k });
+        }
+      }
+    }
+
+    // The horizon must form a single cycle; otherwise the visible region is not a disk, 
+    // which happens only for nearly coplanar input, in which case we reject the point
+    std::unordered_map<uint, uint> starts, ends; // Horizon vertex -> new facet starting/ending there
+    uint facets_offs = m_facets.size(), tetrs_offs = this->deln.elems.size();
+    for (auto [j, edge] : enumerate_view(horizon)) {
+      const auto &[f, k] = edge;
+      uint u = m_facets[f].elem[k], v = m_facets[f].elem[(k + 1) % 3];
+      guard(starts.emplace(u, facets_offs + j).second && ends.emplace(v, facets_offs + j).second, false);
+    }
+
+    // Tetrahedron index per visible facet, and new facet index per horizon edge
+    std::unordered_map<uint, uint> tetr_of, facet_of;
+    for (auto [j, f] : enumerate_view(visible))
+      tetr_of.emplace(f, tetrs_offs + j);
+    for (auto [j, edge] : enumerate_view(horizon))
+      facet_of.emplace(3 * edge.first + edge.second, facets_offs + j);
+    
+    // Add a new facet per horizon edge, spanning the edge and p; 
+    // it replaces the visible facet as neighbour of the hidden facet across the edge
+    for (const auto &[f, k] : horizon) {
+      uint u = m_facets[f].elem[k], v = m_facets[f].elem[(k + 1) % 3], g = m_facets[f].adjc[k];
+      uint h = m_facets.size();
+      eig::Vector3d n = (m_verts[v] - m_verts[u]).cross(p - m_verts[u]).normalized();
+      m_facets.push_back({ .elem     = { u, v, i }, 
+                           .adjc     = { g, starts.at(v), ends.at(u) },
+                           .tetr     = tetr_of.at(f),
+                           .n        = n,
+                           .d        = n.dot(m_verts[u]),
+                           .is_alive = true });
+      for (auto &adjc : m_facets[g].adjc)
+        if (adjc == f)
+          adjc = h;
+    }
+    m_marks.resize(m_facets.size(), 0);
+
+    // Add a new tetrahedron per visible facet, spanning the facet and p; vertex order keeps the
+    // facet first, s.t. face k < 3 is opposite edge (k + 1) % 3, and face 3 is the facet itself
+    for (uint f : visible) {
+      auto &facet = m_facets[f];
+      uint  t     = tetr_of.at(f);
+      eig::Array4i adjc;
+      for (uint k = 0; k < 3; ++k) {
+        uint e = (k + 1) % 3, g = facet.adjc[e];
+        adjc[k] = m_marks[g] == m_mark ? static_cast<int>(tetr_of.at(g)) : ~static_cast<int>(facet_of.at(3 * f + e));
+      }
+      adjc[3] = facet.tetr;
+      for (auto &a : m_adjc[facet.tetr])
+        if (a == ~static_cast<int>(f))
+          a = t;
+
+      this->deln.elems.push_back({ facet.elem[0], facet.elem[1], facet.elem[2], i });
+      m_adjc.push_back(adjc);
+
+      // Retire facet, handing back its conflicting points
+      rng::copy(facet.conflicts, std::back_inserter(orphans));
+      facet.conflicts.clear();
+      facet.is_alive = false;
+    }
+
+    m_last = this->deln.elems.size() - 1;
+    return true;
+  }
+
+  template <typename Vt>
+  void IncrementalConvexHullBase<Vt>::update_hull() {
+    met_trace();
+
+    // Gather live facets, and compact vertices to those on the hull
+    this->hull = { };
+    std::vector<uint> remap(m_verts.size(), std::numeric_limits<uint>::max());
+    for (const auto &f : m_facets) {
+      guard_continue(f.is_alive);
+      eig::Array3u el;
+      for (uint k = 0; k < 3; ++k) {
+        if (remap[f.elem[k]] == std::numeric_limits<uint>::max()) {
+          remap[f.elem[k]] = this->hull.verts.size();
+          this->hull.verts.push_back(this->deln.verts[f.elem[k]]);
+        }
+        el[k] = remap[f.elem[k]];
+      }
+      this->hull.elems.push_back(el);
+    }
+  }
+
+  template <typename Vt>
+  void IncrementalConvexHullBase<Vt>::insert(std::span<const Vt> data) {
+    met_trace();
+    guard(!data.empty());
+
+    // Append input to vertex data; rejected points remain, but are not referenced
+    uint offs = m_verts.size();
+    for (const auto &v : data) {
+      this->deln.verts.push_back(v);
+      m_verts.push_back(v.template cast<double>().matrix());
+    }
+
+    // Points awaiting insertion; if there is no initial simplex yet, attempt to
+    // build one from all points so far, which then await insertion instead
+    std::vector<uint> points(m_verts.size() - offs);
+    std::iota(range_iter(points), offs);
+    if (m_facets.empty()) {
+      points.resize(m_verts.size());
+      std::iota(range_iter(points), 0);
+      guard(init_simplex(points));
+      std::erase_if(points, [&](uint i) { return i == this->deln.elems[0][0] || i == this->deln.elems[0][1]
+                                              || i == this->deln.elems[0][2] || i == this->deln.elems[0][3]; });
+    }
+
+    // Randomized insertion order
+    rng::shuffle(points, PCGEngine(offs));
+    
+    // Build conflict graph; each point is assigned one visible facet, or rejected
+    std::vector<int> conflict(m_verts.size(), -1);
+    auto assign = [&](uint i, int f) {
+      conflict[i] = f;
+      if (f >= 0)
+        m_facets[f].conflicts.push_back(i);
+    };
+    for (uint i : points)
+      assign(i, find_visible_facet(m_verts[i]));
+
+    // Insert points in order; points seeing retired facets are reassigned to the best
+    // of the newly added facets, or relocated if they see none
+    std::vector<uint> orphans;
+    for (uint i : points) {
+      guard_continue(conflict[i] >= 0);
+      uint f = conflict[i], facets_offs = m_facets.size();
+      conflict[i] = -1;
+
+      orphans.clear();
+      guard_continue(insert_point(i, f, orphans));
+
+      for (uint j : orphans) {
+        guard_continue(conflict[j] >= 0);
+        int    best_f = -1;
+        double best_d = m_eps;
+        for (uint g = facets_offs; g < m_facets.size(); ++g) {
+          double d = m_facets[g].n.dot(m_verts[j]) - m_facets[g].d;
+          guard_continue(d > best_d);
+          best_f = g;
+          best_d = d;
+        }
+        assign(j, best_f >= 0 ? best_f : find_visible_facet(m_verts[j]));
+      }
+    }
+
+    // Conflicts of remaining facets refer to handled points only
+    for (auto &f : m_facets)
+      f.conflicts.clear();
+    
+    // Tetrahedra are only ever appended, so the locator is updated for new ones only
+    update_hull();
+    if (this->has_delaunay())
+      this->locator.append(this->deln, m_adjc);
   }
 
   // Explicit template class instantiations
   template class ConvexHullBase<eig::Array3f>;
   template class ConvexHullBase<eig::AlArray3f>;
+  template class IncrementalConvexHullBase<eig::Array3f>;
+  template class IncrementalConvexHullBase<eig::AlArray3f>;
 } // namespace met
\ No newline at end of file
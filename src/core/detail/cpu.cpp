@@ -0,0 +1,42 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <metameric/core/utility.hpp>
+#include <metameric/core/detail/cpu.hpp>
+#include <array>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace met::detail {
+  bool cpu_supports_avx2() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    std::array<int, 4> r;
+    __cpuid(r.data(), 0);
+    guard(r[0] >= 7, false);
+    __cpuid(r.data(), 1);
+    bool is_fma     = r[2] & (1 << 12),
+         is_osxsave = r[2] & (1 << 27);
+    guard(is_fma && is_osxsave && (_xgetbv(0) & 0x6) == 0x6, false);
+    __cpuidex(r.data(), 7, 0);
+    return r[1] & (1 << 5);
+#else
+    return false;
+#endif
+  }
+} // namespace met::detail
\ No newline at end of file
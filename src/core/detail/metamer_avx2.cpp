@@ -0,0 +1,70 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// AVX2 spectral boundary constraint for metamer.cpp; this file alone is compiled with AVX2/FMA
+// enabled, and is only called into after a runtime cpu check. As in traversal_avx2.cpp, it 
+// includes no project or standard library headers, s.t. no inline functions instantiated here
+// are emitted with AVX2 instructions and picked up by other translation units.
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#include <immintrin.h>
+#define MET_METAMER_AVX2
+#endif
+
+namespace met::detail::avx2 {
+#ifdef MET_METAMER_AVX2
+  bool is_boundary_compiled() {
+    return true;
+  }
+
+  void eval_boundary(const double *B, const double *Bt, const double *x, double *r, double *g,
+                     unsigned n_samples, unsigned n_bases) {
+    const __m256d one  = _mm256_set1_pd(1.0),
+                  sign = _mm256_set1_pd(-0.0);
+
+    // y = Bx for 16 wavelengths at a time, accumulated over B's columns in four registers; 
+    // then f(x) = [Bx - 1, -Bx]
+    for (unsigned w = 0; w < n_samples; w += 16) {
+      __m256d y[4] = { _mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd() };
+      for (unsigned k = 0; k < n_bases; ++k) {
+        const double *col = B + k * n_samples + w;
+        __m256d x_k = _mm256_broadcast_sd(x + k);
+        for (unsigned j = 0; j < 4; ++j)
+          y[j] = _mm256_fmadd_pd(_mm256_load_pd(col + 4 * j), x_k, y[j]);
+      }
+      for (unsigned j = 0; j < 4; ++j) {
+        _mm256_storeu_pd(r + w + 4 * j,             _mm256_sub_pd(y[j], one));
+        _mm256_storeu_pd(r + n_samples + w + 4 * j, _mm256_xor_pd(y[j], sign));
+      }
+    }
+
+    // g(x) = [B, -B]^T, i.e. B^T followed by its negation
+    if (g) {
+      unsigned n = n_samples * n_bases;
+      for (unsigned i = 0; i < n; i += 4) {
+        __m256d v = _mm256_load_pd(Bt + i);
+        _mm256_storeu_pd(g + i,     v);
+        _mm256_storeu_pd(g + n + i, _mm256_xor_pd(v, sign));
+      }
+    }
+  }
+#else
+  // Not compiled with AVX2 support; metamer.cpp never dispatches here
+  bool is_boundary_compiled() {
+    return false;
+  }
+
+  void eval_boundary(const double *, const double *, const double *, double *, double *, unsigned, unsigned) { }
+#endif
+} // namespace met::detail::avx2
\ No newline at end of file
@@ -0,0 +1,223 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <metameric/core/locate.hpp>
+#include <metameric/core/distribution.hpp>
+#include <metameric/core/mesh.hpp>
+#include <metameric/core/ranges.hpp>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+namespace met {
+  namespace detail {
+    // Tolerance on barycentric weights for walk termination
+    constexpr float locate_eps = 1e-5f;
+
+    // Maximum nr. of walk steps before falling back to a scan
+    constexpr uint locate_max_steps = 1024;
+  } // namespace detail
+
+  template <typename Vt>
+  void TetrahedronLocator::build_inv(const MeshBase<Vt, eig::Array4u> &mesh, uint begin) {
+    met_trace();
+    const uint n = mesh.elems.size();
+    m_inv.resize(n);
+    m_sub.resize(n);
+
+    #pragma omp parallel for
+    for (int i = begin; i < n; ++i) {
+      const auto vts = mesh.elems[i] | index_into_view(mesh.verts);
+      m_inv[i] = (eig::Matrix3f() << vts[0] - vts[3], 
+                                     vts[1] - vts[3], 
+                                     vts[2] - vts[3]).finished().inverse();
+      m_sub[i] = vts[3];
+    }
+  }
+
+  template <typename Vt>
+  void TetrahedronLocator::build_grid(const MeshBase<Vt, eig::Array4u> &mesh) {
+    met_trace();
+    const uint n = mesh.elems.size();
+    m_grid_elems = n;
+
+    // Build a uniform grid over the mesh bounds, with roughly one element per cell
+    eig::Array3f minb = mesh.verts[0], maxb = minb;
+    for (const auto &v : mesh.verts) {
+      minb = minb.min(v);
+      maxb = maxb.max(v);
+    }
+    uint res    = std::clamp(static_cast<uint>(std::cbrt(static_cast<float>(n))), 1u, 64u);
+    m_grid_size  = res;
+    m_grid_minb  = minb;
+    m_grid_scale = (eig::Array3f(res) / (maxb - minb).max(std::numeric_limits<float>::epsilon())).eval();
+    m_grid.assign(m_grid_size.prod(), std::numeric_limits<uint>::max());
+
+    // Seed cells with an element whose centroid lies inside
+    auto cell_of = [&](const eig::Array3f &p) {
+      eig::Array3u c = ((p - m_grid_minb) * m_grid_scale).max(0.f).cast<uint>().min(m_grid_size - 1);
+      return c.x() + m_grid_size.x() * (c.y() + m_grid_size.y() * c.z());
+    };
+    std::vector<uint> queue;
+    for (uint i = 0; i < n; ++i) {
+      const auto vts = mesh.elems[i] | index_into_view(mesh.verts);
+      uint c = cell_of((vts[0] + vts[1] + vts[2] + vts[3]) * .25f);
+      guard_continue(m_grid[c] == std::numeric_limits<uint>::max());
+      m_grid[c] = i;
+      queue.push_back(c);
+    }
+
+    // Flood-fill empty cells from seeded neighbours
+    for (uint j = 0; j < queue.size(); ++j) {
+      uint c = queue[j];
+      eig::Array3i xyz = { static_cast<int>(c % m_grid_size.x()), 
+                           static_cast<int>((c / m_grid_size.x()) % m_grid_size.y()),
+                           static_cast<int>(c / (m_grid_size.x() * m_grid_size.y())) };
+      for (uint axis = 0; axis < 3; ++axis) {
+        for (int step : { -1, 1 }) {
+          eig::Array3i xyz_ = xyz;
+          xyz_[axis] += step;
+          guard_continue((xyz_ >= 0).all() && (xyz_ < m_grid_size.cast<int>()).all());
+          uint c_ = xyz_.x() + m_grid_size.x() * (xyz_.y() + m_grid_size.y() * xyz_.z());
+          guard_continue(m_grid[c_] == std::numeric_limits<uint>::max());
+          m_grid[c_] = m_grid[c];
+          queue.push_back(c_);
+        }
+      }
+    }
+  }
+
+  template <typename Vt>
+  TetrahedronLocator::TetrahedronLocator(const MeshBase<Vt, eig::Array4u> &mesh) {
+    met_trace();
+    guard(!mesh.empty());
+
+    const uint n = mesh.elems.size();
+    build_inv(mesh, 0);
+    m_adjc.resize(n, eig::Array4i(-1));
+
+    // Build element adjacency by matching faces; a face's key is its sorted vertex indices
+    {
+      const uint64_t n_verts = mesh.verts.size();
+      std::unordered_map<uint64_t, std::pair<uint, uint>> faces;
+      faces.reserve(2 * n);
+      for (uint i = 0; i < n; ++i) {
+        for (uint k = 0; k < 4; ++k) {
+          std::array<uint64_t, 3> f;
+          for (uint j = 0; j < 3; ++j)
+            f[j] = mesh.elems[i][(k + j + 1) % 4];
+          rng::sort(f);
+          uint64_t key = (f[0] * n_verts + f[1]) * n_verts + f[2];
+
+          if (auto it = faces.find(key); it != faces.end()) {
+            auto [i_, k_] = it->second;
+            m_adjc[i][k]   = i_;
+            m_adjc[i_][k_] = i;
+            faces.erase(it);
+          } else {
+            faces.emplace(key, std::pair { i, k });
+          }
+        }
+      }
+    }
+
+    build_grid(mesh);
+  }
+
+  template <typename Vt>
+  void TetrahedronLocator::append(const MeshBase<Vt, eig::Array4u> &mesh, std::span<const eig::Array4i> adjc) {
+    met_trace();
+    debug::check_expr(adjc.size() == mesh.elems.size() && mesh.elems.size() >= m_inv.size(),
+      "TetrahedronLocator: append() requires adjacency for an appended-to mesh");
+    guard(!mesh.empty());
+
+    // Cache inverse matrices of appended elements only
+    const uint begin = m_inv.size(), n = mesh.elems.size();
+    guard(n > begin);
+    build_inv(mesh, begin);
+
+    // Take over adjacency of appended elements and of the existing elements they attach to
+    m_adjc.resize(n);
+    for (uint i = begin; i < n; ++i) {
+      m_adjc[i] = adjc[i].max(-1);
+      for (int j : adjc[i])
+        if (j >= 0 && j < static_cast<int>(begin))
+          m_adjc[j] = adjc[j].max(-1);
+    }
+
+    // Existing grid seeds remain valid, as walks cross into appended elements; 
+    // the grid itself is rebuilt as the mesh outgrows it
+    if (begin == 0 || n >= 2 * m_grid_elems)
+      build_grid(mesh);
+  }
+
+  eig::Array4f TetrahedronLocator::bary(uint i, const eig::Vector3f &p) const {
+    eig::Vector3f xyz = m_inv[i] * (p - m_sub[i]);
+    return (eig::Array4f() << xyz, 1.f - xyz.sum()).finished();
+  }
+  
+  std::pair<eig::Array4f, uint> TetrahedronLocator::scan(const eig::Vector3f &p) const {
+    met_trace();
+
+    float        result_err = std::numeric_limits<float>::max();
+    uint         result_i   = 0;
+    eig::Array4f result_bry = 0;
+    for (uint i = 0; i < m_inv.size(); ++i) {
+      auto bry = bary(i, p);
+      float err = (bry - bry.cwiseMax(0.f).cwiseMin(1.f)).matrix().squaredNorm();
+      guard_continue(err < result_err);
+      result_err = err;
+      result_i   = i;
+      result_bry = bry;
+    }
+    return { result_bry, result_i };
+  }
+
+  std::pair<eig::Array4f, uint> TetrahedronLocator::locate(const eig::Vector3f &p) const {
+    met_trace();
+    debug::check_expr(!empty(), "TetrahedronLocator: locate() called on empty structure");
+
+    // Jump; find seed element from the grid
+    eig::Array3u c = ((p.array() - m_grid_minb) * m_grid_scale).max(0.f).cast<uint>().min(m_grid_size - 1);
+    uint i = m_grid[c.x() + m_grid_size.x() * (c.y() + m_grid_size.y() * c.z())];
+
+    // Walk; cross a face with negative barycentric weight, selected at random, 
+    // as deterministic walks may cycle in non-Delaunay tesselations
+    PCGEngine engine(i);
+    for (uint step = 0; step < detail::locate_max_steps; ++step) {
+      auto bry = bary(i, p);
+      if ((bry >= -detail::locate_eps).all())
+        return { bry, i };
+
+      // Gather candidate faces; if none remain, p lies outside the mesh
+      std::array<uint, 4> faces;
+      uint n_faces = 0;
+      for (uint k = 0; k < 4; ++k)
+        if (bry[k] < -detail::locate_eps && m_adjc[i][k] >= 0)
+          faces[n_faces++] = k;
+      guard_break(n_faces > 0);
+      i = m_adjc[i][faces[engine() % n_faces]];
+    }
+
+    // Fallback for exterior points or failed walks; scan all elements for the closest
+    return scan(p);
+  }
+
+  // Explicit template instantiations
+  template TetrahedronLocator::TetrahedronLocator(const Delaunay &);
+  template TetrahedronLocator::TetrahedronLocator(const AlDelaunay &);
+  template void TetrahedronLocator::append(const Delaunay &, std::span<const eig::Array4i>);
+  template void TetrahedronLocator::append(const AlDelaunay &, std::span<const eig::Array4i>);
+} // namespace met
\ No newline at end of file
@@ -0,0 +1,218 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <metameric/core/lp.hpp>
+#include <metameric/core/qp.hpp>
+#include <metameric/core/spectrum.hpp>
+#include <limits>
+
+namespace met {
+  namespace detail {
+    // Solver tolerance, per precision
+    template <typename T> constexpr T     lp_tol        = 1e-9;
+    template <>           constexpr float lp_tol<float> = 1e-5f;
+
+    // Maximum constraint violation accepted for single-precision active sets, after snapping 
+    // to them in double precision; above this, a full double-precision solve is run instead
+    constexpr double lp_mixed_tol = 1e-5;
+  } // namespace detail
+
+  template <uint N>
+  LPSolver<N>::LPSolver(CreateInfo &&info) {
+    met_trace();
+
+    const uint n_eq = info.C.rows();
+    guard(n_eq <= N);
+
+    // Eliminate the equality block; for C^T P = Q R, the leading columns of Q span
+    // the row space of C, and the trailing columns form its null space Z
+    if (n_eq > 0) {
+      eig::ColPivHouseholderQR<eig::MatrixXd> qr(info.C.transpose());
+      guard(qr.rank() == n_eq);
+      eig::MatrixXd Q  = qr.householderQ();
+      eig::MatrixXd Q1 = Q.leftCols(n_eq);
+      m_d.Z  = Q.rightCols(N - n_eq);
+      m_d.x0 = Q1 * (info.C * Q1).partialPivLu().solve(info.d);
+    } else {
+      m_d.Z  = eig::MatrixXd::Identity(N, N);
+      m_d.x0 = vec::Zero();
+    }
+
+    // Find a feasible starting point as the minimum-norm point of the feasible set
+    QPSolver<N> qp({ .H = QPSolver<N>::mat::Identity(), .C = info.C, .G = info.G });
+    auto feasible = qp.solve(vec::Zero(), info.d, info.h);
+    guard(feasible.success);
+    m_init = { .x = feasible.x, .success = true };
+
+    // Express inequalities in the reduced space
+    m_d.G = info.G * m_d.Z;
+    m_d.h = info.h - info.G * m_d.x0;
+    m_is_valid = true;
+
+    // Keep a single-precision copy for mixed-precision solves
+    if (info.mixed) {
+      m_f = { .x0 = m_d.x0.template cast<float>(), .Z = m_d.Z.template cast<float>(),
+              .G  = m_d.G.template cast<float>(),  .h = m_d.h.template cast<float>() };
+      m_is_mixed = true;
+    }
+  }
+
+  template <uint N>
+  template <typename T>
+  typename LPSolver<N>::Result LPSolver<N>::solve(const vec &c, const Result &warm, const Reduced<T> &r) const {
+    met_trace();
+
+    using dvec = eig::Matrix<T, eig::Dynamic, 1, eig::ColMajor, N, 1>;
+    using dmat = eig::Matrix<T, eig::Dynamic, eig::Dynamic, eig::ColMajor, N, N>;
+
+    Result result = { .x = warm.x };
+    guard(m_is_valid, result);
+
+    const uint n = r.Z.cols(), m = r.G.rows();
+
+    // Equality block fully determines the solution
+    if (n == 0) {
+      result.x       = m_d.x0;
+      result.success = true;
+      return result;
+    }
+
+    // Objective and starting point in reduced space
+    dvec cz = r.Z.transpose() * c.template cast<T>();
+    dvec y  = r.Z.transpose() * (warm.x.template cast<T>() - r.x0);
+    const T c_tol = detail::lp_tol<T> * std::max<T>(cz.norm(), 1);
+
+    // Restore prior active set for warm starts; it stays feasible, as only c changed
+    std::vector<uint> &active = result.active;
+    std::vector<bool> is_active(m, false);
+    active.reserve(n);
+    for (uint i : warm.active) {
+      guard_continue(i < m && active.size() < n && !is_active[i]);
+      active.push_back(i);
+      is_active[i] = true;
+    }
+
+    // Main loop; step along the projected steepest descent direction until blocked by a
+    // constraint, which is added to the active set. If no descent direction exists, drop
+    // the active constraint with the most negative multiplier, or terminate if none exist.
+    // After too many degenerate steps, fall back to smallest-index selection to avoid cycling.
+    const uint max_iters = 4 * (n + m);
+    uint n_degenerate = 0;
+    while (result.iters < max_iters) {
+      const uint q = active.size();
+
+      // Orthonormal basis Q = [Q1 Q2] for active normals, with Q2 spanning their null space
+      dmat A(n, q), Q;
+      for (uint k = 0; k < q; ++k)
+        A.col(k) = r.G.row(active[k]).transpose();
+      eig::HouseholderQR<dmat> qr(A);
+      if (q > 0)
+        Q = qr.householderQ();
+
+      // Projected steepest descent direction
+      dvec p = q == 0 ? (-cz).eval() : (-Q.rightCols(n - q) * (Q.rightCols(n - q).transpose() * cz)).eval();
+
+      if (p.norm() > c_tol) {
+        // Ratio test; find first blocking inequality along p
+        T   t = std::numeric_limits<T>::infinity();
+        int l = -1;
+        for (uint i = 0; i < m; ++i) {
+          guard_continue(!is_active[i]);
+          T a = r.G.row(i).dot(p);
+          guard_continue(a > detail::lp_tol<T> * p.norm());
+          T t_i = std::max<T>((r.h[i] - r.G.row(i).dot(y)) / a, 0);
+          guard_continue(t_i < t);
+          t = t_i;
+          l = i;
+        }
+
+        // Problem is unbounded
+        guard_break(l >= 0);
+
+        y += t * p;
+        active.push_back(l);
+        is_active[l] = true;
+        n_degenerate = t > 0 ? 0 : n_degenerate + 1;
+      } else {
+        // Multipliers from c + A lambda = 0; optimal if none are negative
+        int l = -1;
+        if (q > 0) {
+          dvec lambda = qr.matrixQR().topLeftCorner(q, q).template triangularView<eig::Upper>()
+                          .solve(-(Q.leftCols(q).transpose() * cz));
+          for (uint k = 0; k < q; ++k) {
+            guard_continue(lambda[k] < -c_tol);
+            bool is_better = l < 0 || (n_degenerate > n ? active[k] < active[l] : lambda[k] < lambda[l]);
+            if (is_better)
+              l = k;
+          }
+        }
+        if (l < 0) {
+          result.success = true;
+          break;
+        }
+
+        is_active[active[l]] = false;
+        active.erase(active.begin() + l);
+      }
+
+      result.iters++;
+    } // while (result.iters < max_iters)
+
+    result.x = (r.x0 + r.Z * y).template cast<double>();
+    return result;
+  }
+
+  template <uint N>
+  typename LPSolver<N>::Result LPSolver<N>::refine(const vec &c, const Result &warm, const Result &approx) const {
+    met_trace();
+    
+    // Snap to the single-precision active set in double precision, through the least-squares
+    // correction of the reduced point onto the active constraints
+    eig::VectorXd y = m_d.Z.transpose() * (approx.x - m_d.x0);
+    if (!approx.active.empty()) {
+      eig::MatrixXd A(approx.active.size(), y.size());
+      eig::VectorXd b(approx.active.size());
+      for (uint k = 0; k < approx.active.size(); ++k) {
+        A.row(k) = m_d.G.row(approx.active[k]);
+        b[k]     = m_d.h[approx.active[k]];
+      }
+      y += A.completeOrthogonalDecomposition().solve(b - A * y);
+    }
+    
+    // Verify the snapped point, or discard the single-precision result entirely
+    guard((m_d.G * y - m_d.h).maxCoeff() <= detail::lp_mixed_tol, solve(c, warm, m_d));
+
+    // Double-precision solve from the snapped point; typically only verifies optimality
+    auto result   = solve(c, { .x = m_d.x0 + m_d.Z * y, .active = approx.active }, m_d);
+    result.iters += approx.iters;
+    return result;
+  }
+
+  template <uint N>
+  typename LPSolver<N>::Result LPSolver<N>::solve(const vec &c, const Result &warm) const {
+    met_trace();
+    guard(m_is_mixed, solve(c, warm, m_d));
+    auto approx = solve(c, warm, m_f);
+    guard(approx.success, solve(c, warm, m_d));
+    return refine(c, warm, approx);
+  }
+
+
+  // Explicit template class instantiations
+  template class LPSolver<wavelength_bases>;
+#if MET_PREVIEW_WAVELENGTH_BASES != MET_WAVELENGTH_BASES
+  template class LPSolver<preview_wavelength_bases>;
+#endif
+} // namespace met
\ No newline at end of file
@@ -24,9 +24,19 @@
 #include <libqhullcpp/QhullPoints.h>
 #include <algorithm>
 #include <execution>
+#include <unordered_map>
 
 namespace met {
   namespace detail {
+    // key_equal for exact lookup of eigen types in std::unordered_map, as opposed to
+    // eig::detail::matrix_equal_t, which is approximate and thus inconsistent with hashing
+    template <typename Ty>
+    struct matrix_exact_equal_t { 
+      bool operator()(const Ty &a, const Ty &b) const {
+        return (a == b).all(); 
+      }
+    };
+
     template <typename MeshTy>
     void grow_mesh(MeshTy &mesh, size_t n_verts) {
       mesh.verts.resize(n_verts);
@@ -216,21 +226,27 @@ namespace met {
     for (int i = 0; i < qh_verts.size(); ++i) 
       qh_verts[i].getVertexT()->id = i;
 
-    // Assemble indexed data from qhull format
-    std::vector<eig::Array3f> verts(qh_verts.size());
-    std::transform(std::execution::par_unseq, range_iter(qh_verts), verts.begin(), 
-    [](const orgQhull::QhullVertex &vt) { 
-      eig::Array3d v(vt.point().constBegin());
-      return v.cast<float>().eval();
-    });
-
-    // Undo QHull's unnecessary scatter-because-screw-you-aaaaaargh
+    // Undo QHull's unnecessary scatter-because-screw-you-aaaaaargh; vertices carry the id of 
+    // their input point, and for the odd vertex that doesn't, we look up its exact coordinates
     std::vector<uint> vertex_idx(qh_verts.size());
-    #pragma omp parallel for
-    for (int i = 0; i < verts.size(); ++i) {
-      auto it = rng::find_if(data, [&](const auto &v) { return v.isApprox(verts[i]); });
-      if (it != data.end())
-        vertex_idx[i] = std::distance(data.begin(), it);
+    std::vector<uint> vertex_missing;
+    for (uint i = 0; i < qh_verts.size(); ++i) {
+      if (int id = qh_verts[i].point().id(); id >= 0 && id < data.size())
+        vertex_idx[i] = id;
+      else
+        vertex_missing.push_back(i);
+    }
+    if (!vertex_missing.empty()) {
+      using key_type = eig::Array3f;
+      std::unordered_map<key_type, uint, eig::detail::matrix_hash_t<key_type>, detail::matrix_exact_equal_t<key_type>> data_idx;
+      data_idx.reserve(data.size());
+      for (uint i = 0; i < data.size(); ++i)
+        data_idx.emplace(data[i], i);
+      for (uint i : vertex_missing) {
+        key_type v = eig::Array3d(qh_verts[i].point().constBegin()).cast<float>();
+        if (auto it = data_idx.find(v); it != data_idx.end())
+          vertex_idx[i] = it->second;
+      }
     }
     
     // Build element data
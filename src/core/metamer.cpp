@@ -13,27 +13,87 @@
 // You should have received a copy of the GNU General Public License
 // along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
+#include <metameric/core/detail/cpu.hpp>
+#include <metameric/core/detail/metamer.hpp>
 #include <metameric/core/distribution.hpp>
 #include <metameric/core/convex.hpp>
 #include <metameric/core/solver.hpp>
+#include <metameric/core/lp.hpp>
 #include <metameric/core/math.hpp>
+#include <metameric/core/qp.hpp>
 #include <metameric/core/metamer.hpp>
 #include <metameric/core/ranges.hpp>
 #include <metameric/core/utility.hpp>
 #include <algorithm>
+#include <array>
 #include <execution>
 #include <numbers>
+#include <numeric>
+#include <optional>
 #include <unordered_set>
 
 namespace met {
-  // Autodiff shorthands for several common eigen types
-  using bvec = eig::Vector<ad::real1st, wavelength_bases>;   // basis coeff vector
-  using svec = eig::Vector<ad::real1st, wavelength_samples>; // spectral coeff vector
-  
   namespace detail {
+    // Statically typed solver functions for opt::TypedWrapper; color system equality 
+    // constraints and linear objectives. Spectral boundary constraints are in detail/metamer.hpp
+    template <uint Bases>
+    using LinearNormFunc = opt::FuncNorm<eig::Matrix<double, 3, Bases>, eig::Array<double, 3, 1>>;
+    template <uint Bases>
+    using LinearDotFunc  = opt::FuncDot<eig::Vector<double, Bases>>;
+
+    // AVX2 boundary kernel, defined in metamer_avx2.cpp; B and Bt are column-major and aligned 
+    // to 32 bytes, and n_samples is a multiple of 16
+    namespace avx2 {
+      bool is_boundary_compiled();
+      void eval_boundary(const double *B, const double *Bt, const double *x, double *r, double *g,
+                         uint n_samples, uint n_bases);
+    } // namespace avx2
+
+    bool boundary_supports_avx2(uint n_samples) {
+      static const bool is_supported = avx2::is_boundary_compiled() && cpu_supports_avx2();
+      return is_supported && n_samples % 16 == 0;
+    }
+
+    template <uint Samples, uint Bases>
+    void BoundaryFunc<Samples, Bases>::eval(double *r, const double *x, double *g) const {
+      if (is_avx2) {
+        avx2::eval_boundary(block->B.data(), block->Bt.data(), x, r, g, Samples, Bases);
+        return;
+      }
+
+      using mat = eig::Matrix<double, Bases, 2 * Samples>;
+      eig::Map<const eig::Vector<double, Bases>> x_(x);
+      eig::Map<eig::Vector<double, 2 * Samples>> r_(r);
+      eig::Vector<double, Samples> y = block->B * x_;
+
+      // g(x) = [B, -B]^T
+      if (g) {
+        eig::Map<mat> g_(g);
+        g_.template leftCols<Samples>()  = block->Bt;
+        g_.template rightCols<Samples>() = -block->Bt;
+      }
+
+      // f(x) = [Bx - 1, -Bx]
+      r_.template head<Samples>() = y.array() - 1.0;
+      r_.template tail<Samples>() = -y;
+    }
+
+    template <uint Samples, uint Bases>
+    BoundaryConstraint<Samples, Bases> boundary_constraint(const BasisBase<Samples, Bases> &basis, double tol) {
+      thread_local std::shared_ptr<BoundaryBlock<Samples, Bases>> cache;
+      if (!cache || cache->B_f != basis.func) {
+        // Replace instead of overwriting, as earlier constraints may still hold the block
+        cache = std::make_shared<BoundaryBlock<Samples, Bases>>();
+        cache->B_f = basis.func;
+        cache->B   = basis.func.template cast<double>();
+        cache->Bt  = cache->B.transpose();
+      }
+      return { .f = { .block = cache }, .n = 2 * Samples, .tol = tol };
+    }
+
     // Given a random vector in RN bounded to [-1, 1], return a vector
     // distributed over a gaussian distribution
-    template <uint N>
+    template <int N>
     inline auto inv_gaussian_cdf(const eig::Array<float, N, 1> &x) {
       auto y = (-(x * x) + 1.f).max(.0001f).log().eval();
       auto z = (0.5f * y + (2.f / std::numbers::pi_v<float>)).eval();
@@ -42,142 +102,732 @@ namespace met {
     
     // Given a random vector in RN bounded to [-1, 1], return a uniformly
     // distributed point on the unit sphere
-    template <uint N>
+    template <int N>
     inline auto inv_unit_sphere_cdf(const eig::Array<float, N, 1> &x) {
       return inv_gaussian_cdf<N>(x).matrix().normalized().eval();
     }
+
+    // Sobol generator matrices for the first 16 dimensions, built from the primitive polynomials
+    // and initial direction numbers of Joe and Kuo, 2008, "Constructing Sobol sequences with 
+    // better two-dimensional projections"; the first dimension is the van der Corput sequence
+    constexpr uint sobol_dims = 16;
+    constexpr auto sobol_matrices = []() {
+      struct Poly { uint s, a; std::array<uint, 6> m; };
+      constexpr std::array<Poly, sobol_dims - 1> polys = {{
+        { 1, 0,  { 1                 } }, { 2, 1,  { 1, 3              } },
+        { 3, 1,  { 1, 3, 1           } }, { 3, 2,  { 1, 1, 1           } },
+        { 4, 1,  { 1, 1, 3, 3        } }, { 4, 4,  { 1, 3, 5, 13       } },
+        { 5, 2,  { 1, 1, 5, 5, 17    } }, { 5, 4,  { 1, 1, 5, 5, 5     } },
+        { 5, 7,  { 1, 1, 7, 11, 19   } }, { 5, 11, { 1, 1, 5, 1, 1     } },
+        { 5, 13, { 1, 1, 1, 3, 11    } }, { 5, 14, { 1, 3, 5, 5, 31    } },
+        { 6, 1,  { 1, 3, 3, 9, 7, 49 } }, { 6, 13, { 1, 1, 1, 15, 21, 21 } },
+        { 6, 16, { 1, 3, 1, 13, 27, 49 } }
+      }};
+
+      std::array<std::array<uint, 32>, sobol_dims> V = {};
+      for (uint k = 0; k < 32; ++k)
+        V[0][k] = 1u << (31 - k);
+      for (uint d = 1; d < sobol_dims; ++d) {
+        const auto &[s, a, m] = polys[d - 1];
+        for (uint k = 0; k < 32; ++k) {
+          if (k < s) {
+            V[d][k] = m[k] << (31 - k);
+          } else {
+            V[d][k] = V[d][k - s] ^ (V[d][k - s] >> s);
+            for (uint l = 1; l < s; ++l)
+              V[d][k] ^= ((a >> (s - 1 - l)) & 1u) * V[d][k - l];
+          }
+        }
+      }
+      return V;
+    }();
+
+    // Random digital shifts per dimension, which scramble the sequence while preserving its
+    // stratification; fixed, s.t. the sequence is reproducible between runs
+    constexpr auto sobol_shifts = []() {
+      std::array<uint, sobol_dims> shifts;
+      PCGEngine engine(4);
+      for (uint &shift : shifts)
+        shift = engine();
+      return shifts;
+    }();
+
+    // Return the i'th point of a scrambled Sobol sequence in [0, 1)^N
+    template <uint N> requires (N <= sobol_dims)
+    inline eig::Array<float, N, 1> sobol_sample(uint i) {
+      eig::Array<float, N, 1> v;
+      for (uint d = 0; d < N; ++d) {
+        uint x = sobol_shifts[d];
+        for (uint k = 0, j = i; j; ++k, j >>= 1)
+          if (j & 1u)
+            x ^= sobol_matrices[d][k];
+        v[d] = static_cast<float>((static_cast<double>(x) + 0.5) * 0x1p-32);
+      }
+      return v;
+    }
+
+    // Return the i'th point of an extensible spherical Fibonacci sequence on the unit sphere;
+    // azimuths follow the golden angle as in the regular Fibonacci lattice, but heights follow
+    // the (shifted) van der Corput sequence instead of i / n, s.t. any prefix is well-distributed
+    inline eig::Vector3f fibonacci_sample(uint i) {
+      constexpr double inv_phi = std::numbers::phi - 1.0;
+      double z   = 1.0 - 2.0 * static_cast<double>(sobol_sample<1>(i)[0]);
+      double r   = std::sqrt(std::max(1.0 - z * z, 0.0));
+      double phi = 2.0 * std::numbers::pi * std::fmod(static_cast<double>(i) * inv_phi, 1.0);
+      return eig::Vector3d(r * std::cos(phi), r * std::sin(phi), z).template cast<float>();
+    }
     
-    // Generate a set of random, uniformly distributed unit vectors in RN
+    // Return the i'th point of a hashed pseudorandom sequence in [0, 1)^n; unlike the Sobol 
+    // sequence above, this extends to any nr. of dimensions, but it is not stratified
+    inline eig::ArrayXf hashed_sample(uint n, uint i) {
+      PCGEngine engine { PCGEngine(i)() };
+      eig::ArrayXf v(n);
+      for (uint d = 0; d < n; ++d)
+        v[d] = (static_cast<float>(engine() >> 8) + 0.5f) * 0x1p-24f;
+      return v;
+    }
+
+    // Generate a set of quasi-random, uniformly distributed unit vectors in RN; these are points
+    // [offset, offset + n_samples) of a low-discrepancy sequence, s.t. subsequent calls with a
+    // running offset fill gaps in prior coverage, instead of forming random clusters. For N = 3, 
+    // this is a spherical Fibonacci sequence; for higher N, a scrambled Sobol sequence is mapped 
+    // through the inverse normal CDF
     template <uint N>
-    inline auto gen_unit_dirs(uint n_samples, uint seed = 4) {
+    inline auto gen_unit_dirs(uint n_samples, uint offset = 4) {
       met_trace();
 
-      std::vector<eig::Vector<float, N>> unit_dirs(n_samples);
+      auto gen_unit_dir = [offset](uint i) -> eig::Vector<float, N> {
+        if constexpr (N == 3)
+          return fibonacci_sample(offset + i);
+        else
+          return inv_unit_sphere_cdf<N>(sobol_sample<N>(offset + i) * 2.f - 1.f);
+      };
 
+      std::vector<eig::Vector<float, N>> unit_dirs(n_samples);
       if (n_samples <= 16) {
-        UniformSampler sampler(-1.f, 1.f, seed);
         for (int i = 0; i < unit_dirs.size(); ++i)
-          unit_dirs[i] = inv_unit_sphere_cdf<N>(sampler.template next_nd<N>());
+          unit_dirs[i] = gen_unit_dir(i);
       } else {
-        UniformSampler sampler(-1.f, 1.f, seed);
-        #pragma omp parallel
-        { // Draw samples for this thread's range with separate sampler per thread
-          UniformSampler sampler(-1.f, 1.f, seed + static_cast<uint>(omp_get_thread_num()));
-          #pragma omp for
-          for (int i = 0; i < unit_dirs.size(); ++i)
-            unit_dirs[i] = inv_unit_sphere_cdf<N>(sampler.template next_nd<N>());
-        }
+        #pragma omp parallel for
+        for (int i = 0; i < unit_dirs.size(); ++i)
+          unit_dirs[i] = gen_unit_dir(i);
       }
 
       return unit_dirs;
     }
 
-    // Mapping from static to dynamic, so we can vary the nr. of objectives for which samples are generated
-    auto gen_unit_dirs(uint n_objectives, uint n_samples, uint seed = 4) {
-      constexpr auto eig_static_to_dynamic = [](const auto &v) { return (eig::VectorXf(v.size()) << v).finished(); };
-      std::vector<eig::VectorXf> X(n_samples);
-      switch (n_objectives) {
-        case 1:  rng::transform(gen_unit_dirs<3>(n_samples, seed),  X.begin(), eig_static_to_dynamic); break;
-        case 2:  rng::transform(gen_unit_dirs<6>(n_samples, seed),  X.begin(), eig_static_to_dynamic); break;
-        case 3:  rng::transform(gen_unit_dirs<9>(n_samples, seed),  X.begin(), eig_static_to_dynamic); break;
-        case 4:  rng::transform(gen_unit_dirs<12>(n_samples, seed), X.begin(), eig_static_to_dynamic); break;
-        case 5:  rng::transform(gen_unit_dirs<15>(n_samples, seed), X.begin(), eig_static_to_dynamic); break;
-        default: debug::check_expr(false, "Not implemented!");
+    // Runtime-sized counterpart of the above, returning unit vectors as the columns of a matrix; 
+    // dimensions with a dedicated sequence above forward to it, while others, e.g. for hundreds
+    // of objective color systems, use a hashed sequence mapped through the inverse normal CDF.
+    // Note that this fallback is not low-discrepancy; beyond the Sobol table's dimensions, its
+    // directions are independent pseudorandom draws, and a running offset does not fill gaps
+    inline eig::MatrixXf gen_unit_dirs(uint n_dims, uint n_samples, uint offset = 4) {
+      met_trace();
+
+      eig::MatrixXf X(n_dims, n_samples);
+      auto gen_static = [&]<uint N>() {
+        auto dirs = gen_unit_dirs<N>(n_samples, offset);
+        for (uint i = 0; i < n_samples; ++i)
+          X.col(i) = dirs[i];
+      };
+
+      switch (n_dims) {
+        case 3:  gen_static.template operator()<3>();  break;
+        case 6:  gen_static.template operator()<6>();  break;
+        case 9:  gen_static.template operator()<9>();  break;
+        case 12: gen_static.template operator()<12>(); break;
+        case 15: gen_static.template operator()<15>(); break;
+        default: {
+          #pragma omp parallel for if (n_samples > 16)
+          for (int i = 0; i < n_samples; ++i)
+            X.col(i) = inv_unit_sphere_cdf<eig::Dynamic>(hashed_sample(n_dims, offset + i) * 2.f - 1.f);
+        }
       }
+
       return X;
     }
+
+    // Directions are generated and solved in chunks, s.t. memory for directions and their
+    // objectives stays bounded for large nr. of objective color systems
+    constexpr size_t solve_chunk_bytes = 16 << 20;
+
+    // Test whether a per-direction solve produced a usable result
+    inline bool is_valid_solve(const auto &c) {
+      return !c.array().isNaN().any() && !c.array().isZero();
+    }
+
+    // Remove failed solves from per-direction output, preserving the order of the remaining solves
+    inline void compact_solve_output(auto &output) {
+      std::erase_if(output, [](const auto &c) { return !is_valid_solve(c); });
+    }
+
+    // Directions are solved in runs along a space-filling curve; within a run, each solve is
+    // warm-started from its predecessor, while runs start cold and are spread over threads. A chunk
+    // is split into solve_run_count runs where possible, enough to occupy common thread counts; as
+    // run sizes only depend on the chunk size, output is independent of the nr. of threads
+    constexpr uint solve_run_count = 64;
+    inline uint solve_run_size(uint n) {
+      return std::max(n / solve_run_count, 1u);
+    }
+
+    // Nr. of directions of the given dimension per chunk
+    inline uint solve_chunk_size(uint n_dims) {
+      size_t n = solve_chunk_bytes / (sizeof(float) * std::max(n_dims, 1u));
+      return static_cast<uint>(std::max<size_t>(n, 1));
+    }
+
+    // Return the index of a point with b-bit coordinates on an N-dimensional Hilbert curve, 
+    // following Skilling, 2004, "Programming the Hilbert curve"; coordinates are first transformed
+    // to the curve's transposed index, whose bits are then interleaved
+    inline uint64_t hilbert_index(std::span<uint> X, uint b) {
+      const uint n = X.size();
+
+      // Inverse undo excess work
+      for (uint Q = 1u << (b - 1); Q > 1; Q >>= 1) {
+        uint P = Q - 1;
+        for (uint i = 0; i < n; ++i) {
+          if (X[i] & Q) {
+            X[0] ^= P;
+          } else {
+            uint t = (X[0] ^ X[i]) & P;
+            X[0] ^= t;
+            X[i] ^= t;
+          }
+        }
+      }
+
+      // Gray encode
+      for (uint i = 1; i < n; ++i)
+        X[i] ^= X[i - 1];
+      uint t = 0;
+      for (uint Q = 1u << (b - 1); Q > 1; Q >>= 1)
+        if (X[n - 1] & Q)
+          t ^= Q - 1;
+      for (uint i = 0; i < n; ++i)
+        X[i] ^= t;
+
+      // Interleave transposed index, most significant bits first
+      uint64_t index = 0;
+      for (int j = b - 1; j >= 0; --j)
+        for (uint i = 0; i < n; ++i)
+          index = (index << 1) | ((X[i] >> j) & 1u);
+      return index;
+    }
+
+    // Order a set of vectors, given as matrix columns, along a Hilbert curve through [-1, 1]^N 
+    // by their normalized directions, and return the resulting permutation; consecutive directions 
+    // are then similar, which lets warm-started solves over a contiguous range converge fast
+    inline std::vector<uint> order_unit_dirs(const eig::MatrixXf &X) {
+      met_trace();
+      
+      std::vector<uint> perm(X.cols());
+      std::iota(range_iter(perm), 0u);
+      guard(X.cols() > 2 && X.rows() > 0 && X.rows() <= 64, perm);
+
+      // Quantize coordinates to as many bits as fit a 64-bit curve index
+      const uint n = X.rows(), b = std::min(64u / n, 16u);
+      std::vector<uint64_t> keys(X.cols());
+      std::vector<uint> coords(n);
+      for (uint i = 0; i < X.cols(); ++i) {
+        eig::VectorXf x = X.col(i).normalized();
+        for (uint j = 0; j < n; ++j)
+          coords[j] = static_cast<uint>(std::clamp(0.5f * (x[j] + 1.f), 0.f, 1.f) * ((1u << b) - 1));
+        keys[i] = hilbert_index(coords, b);
+      }
+
+      // Sort by curve index; ties keep sequence order
+      rng::stable_sort(perm, {}, [&keys](uint i) { return keys[i]; });
+      return perm;
+    }
+
+    // Facet of an incrementally constructed 3d convex polytope; vertices are counter-clockwise
+    // seen from outside, and the plane n^T x = d is final once no support point lies beyond it
+    struct PolytopeFacet {
+      eig::Array3u  elem;
+      eig::Vector3d n;
+      double        d;
+      bool          is_final = false;
+    };
+
+    // Build a facet over three vertices, oriented away from an interior point
+    inline PolytopeFacet init_polytope_facet(std::span<const eig::Vector3d> verts, 
+                                             eig::Array3u                   elem, 
+                                             const eig::Vector3d           &interior) {
+      eig::Vector3d n = (verts[elem[1]] - verts[elem[0]]).cross(verts[elem[2]] - verts[elem[0]]).normalized();
+      if (n.dot(verts[elem[0]] - interior) < 0.0) {
+        std::swap(elem[1], elem[2]);
+        n = -n;
+      }
+      return { .elem = elem, .n = n, .d = n.dot(verts[elem[0]]) };
+    }
+
+    // Insert a point into a convex polytope following the beneath-beyond method; facets visible
+    // from the point are removed, and the horizon is connected to the point. Returns false if
+    // the point is not beyond any facet, i.e. it lies inside the polytope
+    inline bool insert_polytope_vert(std::vector<PolytopeFacet>     &facets, 
+                                     std::span<const eig::Vector3d>  verts, 
+                                     uint                            vert_i, 
+                                     const eig::Vector3d            &interior, 
+                                     double                          eps) {
+      const auto &p = verts[vert_i];
+
+      // Split facets into visible and remaining facets
+      auto is_visible = [&](const auto &f) { return f.n.dot(p) > f.d + eps; };
+      auto visible    = facets | vws::filter(is_visible) | view_to<std::vector<PolytopeFacet>>();
+      guard(!visible.empty(), false);
+      std::erase_if(facets, is_visible);
+
+      // Horizon edges are directed edges of visible facets, whose reverse is not visible
+      auto edge_key = [](uint a, uint b) { return (static_cast<uint64_t>(a) << 32) | b; };
+      std::unordered_set<uint64_t> edges;
+      for (const auto &f : visible)
+        for (uint i = 0; i < 3; ++i)
+          edges.insert(edge_key(f.elem[i], f.elem[(i + 1) % 3]));
+      for (const auto &f : visible) {
+        for (uint i = 0; i < 3; ++i) {
+          uint a = f.elem[i], b = f.elem[(i + 1) % 3];
+          guard_continue(!edges.contains(edge_key(b, a)));
+          facets.push_back(init_polytope_facet(verts, { a, b, vert_i }, interior));
+        }
+      }
+
+      return true;
+    }
+
+    // Build a linear program over the feasible set of coefficients producing valid reflectances,
+    // which uphold the given direct metamerism constraints
+    template <uint Samples, uint Bases>
+    LPSolver<Bases> init_boundary_lp(const BasisBase<Samples, Bases> &basis, 
+                                     std::span<const typename DirectMismatchSolidInfoBase<Samples, Bases>::LinearConstraint> constraints,
+                                     bool mixed = false) {
+      met_trace();
+
+      using LP = LPSolver<Bases>;
+      constexpr uint n_nq = 2 * Samples + 2 * Bases;
+      
+      // Equality block; direct color system constraints
+      typename LP::cmat      C(3 * constraints.size(), Bases);
+      eig::VectorXd d(C.rows());
+      for (const auto &[i, cstr] : enumerate_view(constraints)) {
+        const auto &[csys, colr] = cstr;
+        C.template middleRows<3>(3 * i) = (csys.finalize(false).transpose() * basis.func).template cast<double>();
+        d.template segment<3>(3 * i)    = lrgb_to_xyz(colr).template cast<double>();
+      }
+
+      // Inequality block; 0 <= Bx <= 1, and -1 <= x <= 1 as box bounds
+      auto B = basis.func.template cast<double>().eval();
+      typename LP::cmat      G(n_nq, Bases);
+      eig::VectorXd h(n_nq);
+      G << B, -B, eig::Matrix<double, Bases, Bases>::Identity(), 
+                 -eig::Matrix<double, Bases, Bases>::Identity();
+      h << eig::VectorXd::Ones(Samples), 
+           eig::VectorXd::Zero(Samples),
+           eig::VectorXd::Ones(2 * Bases);
+
+      return LP({ .C = std::move(C), .d = std::move(d), .G = std::move(G), .h = std::move(h), .mixed = mixed });
+    }
+
+    // Solve a direct spectrum problem through the dedicated QP solver; the factorized
+    // equality block is cached per thread, keyed on the basis and color systems, as
+    // these typically stay fixed across many consecutive solves. Returns std::nullopt
+    // if the problem could not be handled, in which case NLopt should be used instead.
+    template <uint Samples, uint Bases>
+    std::optional<eig::Vector<float, Bases>> solve_spectrum_coef_qp(const DirectSpectrumInfoBase<Samples, Bases> &info) {
+      met_trace();
+      
+      using QP = QPSolver<Bases>;
+      constexpr uint n_nq = 2 * Samples + 2 * Bases;
+
+      // Equality block must not exceed the nr. of free variables
+      guard(3 * info.linear_constraints.size() <= Bases, std::nullopt);
+
+      // Assemble equality block; C x == d, with C = [A_0; A_1; ...], d = [b_0; b_1; ...]
+      typename QP::cmat      C(3 * info.linear_constraints.size(), Bases);
+      eig::VectorXd d(C.rows());
+      for (const auto &[i, cstr] : enumerate_view(info.linear_constraints)) {
+        const auto &[csys, colr] = cstr;
+        C.template middleRows<3>(3 * i) = (csys.finalize(false).transpose() * info.basis.func).template cast<double>();
+        d.template segment<3>(3 * i)    = lrgb_to_xyz(colr).template cast<double>();
+      }
+
+      // Rebuild cached solver if basis or color systems changed
+      thread_local eig::Matrix<float, Samples, Bases> cache_func = eig::Matrix<float, Samples, Bases>::Zero();
+      thread_local typename QP::cmat        cache_C;
+      thread_local QP              cache_qp;
+      if (cache_func != info.basis.func || cache_C.rows() != C.rows() || cache_C != C) {
+        auto B = info.basis.func.template cast<double>().eval();
+        auto G = (typename QP::cmat(n_nq, Bases) 
+          << B, -B, QP::mat::Identity(), -QP::mat::Identity()).finished();
+        cache_func = info.basis.func;
+        cache_C    = C;
+        cache_qp   = QP({ .H = B.transpose() * B, .C = C, .G = std::move(G) });
+      }
+      guard(cache_qp.is_valid(), std::nullopt);
+
+      // Objective minimizes ||Bx - mean||^2, matching the NLopt path's l2 norm
+      SpecBase<Samples> mean = SpecBase<Samples>(luminance(info.linear_constraints[0].second)).cwiseMin(1.f);
+      typename QP::vec g = -(info.basis.func.transpose() * mean.matrix()).template cast<double>();
+
+      // Boundary inequalities; 0 <= Bx <= 1, and -1 <= x <= 1 as box bounds
+      eig::VectorXd h(n_nq);
+      h << eig::VectorXd::Ones(Samples), 
+           eig::VectorXd::Zero(Samples),
+           eig::VectorXd::Ones(2 * Bases);
+
+      auto result = cache_qp.solve(g, d, h);
+      guard(result.success, std::nullopt);
+      return result.x.template cast<float>().eval();
+    }
   } // namespace detail
 
-  Basis::vec_type solve_spectrum_coef(const DirectSpectrumInfo &info) {
+  template <uint Samples, uint Bases>
+  eig::Vector<float, Bases> solve_spectrum_coef(const DirectSpectrumInfoBase<Samples, Bases> &info) {
     met_trace();
+
+    // Attempt dedicated QP solver first, if requested
+    if (info.backend == DirectSpectrumInfoBase<Samples, Bases>::Backend::eQP) {
+      if (auto coeffs = detail::solve_spectrum_coef_qp(info))
+        return *coeffs;
+    }
     
     // Take a grayscale spectrum as mean to build around
-    Spec mean = Spec(luminance(info.linear_constraints[0].second)).cwiseMin(1.f);
-    
-    // This object will store settings, constraints, objectives, and is then passed to solver
-    opt::Wrapper<wavelength_bases> solver = {
-      .x_init       = 0.05,
-      .upper        = 1.0,
-      .lower        =-1.0,
-      .max_iters    = 256,
-      .rel_xpar_tol = 1e-3, // Threshold for objective error
-    };
-    
+    SpecBase<Samples> mean = SpecBase<Samples>(luminance(info.linear_constraints[0].second)).cwiseMin(1.f);
+
     // Objective function minimizes l2 norm as a simple way to get relatively smooth coeffs
-    solver.objective = opt::func_norm<wavelength_bases>(info.basis.func, mean);
+    auto objective = opt::func_norm<Bases>(info.basis.func, mean);
 
     // Add color system equality constraints, upholding spectral metamerism
+    std::vector<opt::EqConstraint<detail::LinearNormFunc<Bases>>> eq_constraints;
     for (const auto [csys, colr] : info.linear_constraints) {
       auto A = (csys.finalize(false).transpose() * info.basis.func).eval();
       auto b = lrgb_to_xyz(colr);
-
-      solver.eq_constraints.push_back({ .f   = opt::func_norm<wavelength_bases>(A, b), 
-                                        .tol = 1e-4 });
+      eq_constraints.push_back({ .f   = opt::func_norm<Bases>(A, b), 
+                                 .tol = 1e-4 });
     }
 
-    // Add boundary inequality constraints, upholding spectral 0 <= x <= 1
-    {
-      auto A = (eig::Matrix<float, 2 * wavelength_samples, wavelength_bases>()
-        << info.basis.func, -info.basis.func).finished();
-      auto b = (eig::Array<float, 2 * wavelength_samples, 1>()
-        << Spec(1.f), Spec(0.f)).finished();
-      solver.nq_constraints_v.push_back({ .f   = opt::func_dot_v<wavelength_bases>(A, b), 
-                                          .n   = 2 * wavelength_samples, 
-                                          .tol = 1e-2 });
-    }
+    // This object will store settings, constraints, objectives, and is then passed to solver
+    opt::TypedWrapper<Bases, 
+                      decltype(objective), 
+                      decltype(eq_constraints), 
+                      detail::BoundaryConstraint<Samples, Bases>> solver = {
+      .objective    = objective,
+      .constraints  = { std::move(eq_constraints), detail::boundary_constraint(info.basis, 1e-2) },
+      .x_init       = 0.05,
+      .upper        = 1.0,
+      .lower        =-1.0,
+      .max_iters    = 256,
+      .rel_xpar_tol = 1e-3, // Threshold for objective error
+    };
 
     // Run solver and return recovered coefficients
     auto [coeffs, code] = solve(solver);
-    return coeffs.cast<float>().eval();
+    return coeffs.template cast<float>().eval();
   }
 
-  Basis::vec_type solve_spectrum_coef(const IndirectSpectrumInfo &info) {
+  template <uint Samples, uint Bases>
+  std::vector<eig::Vector<float, Bases>> solve_spectrum_coef(const DirectSpectrumBatchInfoBase<Samples, Bases> &info) {
     met_trace();
-    // Not implemented, not used; we really want to avoid solving this problem
-    // and instead rely on the mmv boundary to interpolate an interior value
-    return Basis::vec_type(0);
+
+    using vec = eig::Vector<double, Bases>;
+
+    constexpr uint batch_size = 8;   // Colors projected together
+    constexpr uint tile_size  = 512; // Colors per parallel work item
+
+    // Helper values; basis functions and color system in double
+    auto B = info.basis.func.template cast<double>().eval();
+    auto C = (info.csys.finalize(false).transpose() * info.basis.func).template cast<double>().eval();
+
+    // The objective ||Bx - m||^2 under C x == d, with m the target's clamped luminance, has a 
+    // solution x = P d + q m that is linear in the target; factorize its KKT system once. The
+    // system is singular if C is rank-deficient, e.g. for an observer with linearly dependent
+    // channels or a vanishing illuminant; the closed form then does not exist, and every
+    // color takes the QP/NLopt path below instead
+    eig::Matrix<double, Bases + 3, Bases + 3> K;
+    K << B.transpose() * B, C.transpose(), 
+         C,                 eig::Matrix3d::Zero();
+    auto lu = K.fullPivLu();
+    bool is_closed_form = lu.isInvertible();
+    vec  b_ones = B.transpose() * eig::Vector<double, Samples>::Ones();
+    vec  q      = vec::Zero();
+    eig::Matrix<double, Bases, 3> P = eig::Matrix<double, Bases, 3>::Zero();
+    if (is_closed_form) {
+      P = lu.solve((eig::Matrix<double, Bases + 3, 3>() 
+        << eig::Matrix<double, Bases, 3>::Zero(), eig::Matrix3d::Identity()).finished()).template topRows<Bases>();
+      q = lu.solve((eig::Vector<double, Bases + 3>() << b_ones, eig::Vector3d::Zero()).finished())
+            .template head<Bases>();
+    }
+
+    // Colors for which the inequalities are active go through a shared QP solver instead;
+    // its inequalities are 0 <= Bx <= 1, and -1 <= x <= 1 as box bounds
+    using QP = QPSolver<Bases>;
+    constexpr uint n_nq = 2 * Samples + 2 * Bases;
+    QP qp({ .H = B.transpose() * B, 
+            .C = C, 
+            .G = (typename QP::cmat(n_nq, Bases) << B, -B, QP::mat::Identity(), -QP::mat::Identity()).finished() });
+    eig::VectorXd h(n_nq);
+    h << eig::VectorXd::Ones(Samples), 
+         eig::VectorXd::Zero(Samples),
+         eig::VectorXd::Ones(2 * Bases);
+    
+    // Parallel solve over tiles; within a tile, project batches of colors at once, and keep 
+    // those whose solution satisfies the inequalities, as these are then inactive. The 
+    // remainder goes through the QP solver, or NLopt if all else fails
+    std::vector<eig::Vector<float, Bases>> output(info.colrs.size());
+    #pragma omp parallel for schedule(dynamic)
+    for (int tile = 0; tile < ceil_div(info.colrs.size(), tile_size); ++tile) {
+      size_t tile_begin = static_cast<size_t>(tile) * tile_size,
+             tile_end   = std::min(tile_begin + tile_size, info.colrs.size());
+      for (size_t i = tile_begin; i < tile_end; i += batch_size) {
+        uint n = static_cast<uint>(std::min<size_t>(batch_size, tile_end - i));
+
+        // Gather targets and luminance terms for this batch
+        eig::Matrix<double, 3, batch_size> D = eig::Matrix<double, 3, batch_size>::Zero();
+        eig::Matrix<double, 1, batch_size> m = eig::Matrix<double, 1, batch_size>::Zero();
+        for (uint j = 0; j < n; ++j) {
+          D.col(j) = lrgb_to_xyz(info.colrs[i + j]).template cast<double>();
+          m[j]     = std::min(luminance(info.colrs[i + j]), 1.f);
+        }
+        
+        // Project batch, and test feasibility of reflectances and coefficients
+        eig::Matrix<double, Bases, batch_size>   X = P * D + q * m;
+        eig::Matrix<double, Samples, batch_size> S = B * X;
+        auto is_feasible = ((S.array() >= 0.0).colwise().all()   && (S.array() <= 1.0).colwise().all()
+                         && (X.array() >= -1.0).colwise().all()  && (X.array() <= 1.0).colwise().all()).eval();
+
+        for (uint j = 0; j < n; ++j) {
+          if (is_closed_form && is_feasible[j]) {
+            output[i + j] = X.col(j).template cast<float>();
+          } else if (auto result = qp.solve(-m[j] * b_ones, D.col(j), h); result.success) {
+            output[i + j] = result.x.template cast<float>();
+          } else {
+            output[i + j] = solve_spectrum_coef(DirectSpectrumInfoBase<Samples, Bases> { 
+              .linear_constraints = {{ info.csys, info.colrs[i + j] }},
+              .basis              = info.basis,
+              .backend            = DirectSpectrumInfoBase<Samples, Bases>::Backend::eNLopt
+            });
+          }
+        } // for (uint j)
+      } // for (size_t i)
+    } // for (int tile)
+
+    return output;
   }
-  
-  std::vector<Basis::vec_type> solve_mismatch_solid_coef(const DirectMismatchSolidInfo &info) {
+
+  template <uint Samples, uint Bases>
+  eig::Vector<float, Bases> solve_spectrum_coef(const IndirectSpectrumInfoBase<Samples, Bases> &info) {
     met_trace();
 
+    using vec = eig::Vector<double, Bases>;
+    using mat = eig::Matrix<double, eig::Dynamic, Bases>;
 
-    // Sample unit vectors in nd
-    auto samples_nd = detail::gen_unit_dirs(info.linear_objectives.size(), info.n_samples, info.seed);
+    // Helper value; basis functions in double
+    auto B = info.basis.func.template cast<double>().eval();
 
-    // Solver settings
-    opt::Wrapper<wavelength_bases> solver = {
-      .x_init       = 0.05,
-      .upper        = 1.0,
-      .lower        =-1.0,
-      .max_iters    = 128,
-      .rel_xpar_tol = 1e-3, // Threshold for objective error
+    // Warm start from the given coefficients, the solution to the direct constraints, 
+    // or a least-squares fit to a gray spectrum
+    vec x;
+    if (info.coef_init)
+      x = info.coef_init->template cast<double>();
+    else if (!info.linear_constraints.empty())
+      x = solve_spectrum_coef(DirectSpectrumInfoBase<Samples, Bases> { .linear_constraints = info.linear_constraints, 
+                                                   .basis              = info.basis }).template cast<double>();
+    else
+      x = B.colPivHouseholderQr().solve(eig::Vector<double, Samples>::Constant(.5));
+    x = x.cwiseMax(-1.0).cwiseMin(1.0);
+
+    // Gather linear constraints as A x = b
+    auto lin = info.linear_constraints 
+             | vws::transform([&](const IndirectSpectrumInfoBase<Samples, Bases>::LinearConstraint &cstr) {
+                auto A = (cstr.first.finalize(false).transpose() * info.basis.func).template cast<double>().eval();
+                auto b = lrgb_to_xyz(cstr.second).template cast<double>().eval();
+                return std::pair { A, b }; })
+             | view_to<std::vector<std::pair<eig::Matrix<double, 3, Bases>, eig::Array<double, 3, 1>>>>();
+
+    // Gather nonlinear constraints as sum_p A_p (Bx)^p = b
+    auto nlin = info.nlinear_constraints 
+              | vws::transform([&](const IndirectSpectrumInfoBase<Samples, Bases>::NLinearConstraint &cstr) {
+                auto A = cstr.first.finalize(false)
+                       | vws::transform([](const CMFSBase<Samples> &cmfs) { return cmfs.transpose().template cast<double>().eval(); })
+                       | view_to<std::vector<detail::PowerSeriesTerm<3, Samples>>>();
+                auto b = lrgb_to_xyz(cstr.second).template cast<double>().eval();
+                return std::pair { A, b }; })
+              | view_to<std::vector<std::pair<std::vector<detail::PowerSeriesTerm<3, Samples>>, eig::Array<double, 3, 1>>>>();
+
+    // Residuals and Jacobian; constraint residuals, followed by penalty residuals 
+    // for spectral values outside 0 <= Bx <= 1, which are zero inside the bounds
+    const uint n_cstr = 3 * (lin.size() + nlin.size()), 
+               n_rows = n_cstr + Samples;
+    auto eval = [&](const vec &x, eig::VectorXd &r, mat &J) {
+      for (uint i = 0; i < lin.size(); ++i) {
+        const auto &[A, b] = lin[i];
+        r.template segment<3>(3 * i)    = (A * x).array() - b;
+        J.template middleRows<3>(3 * i) = A;
+      }
+      for (uint i = 0; i < nlin.size(); ++i) {
+        const auto &[A, b] = nlin[i];
+        auto [H, D] = detail::eval_power_series<3, Samples>(A, B * x);
+        r.template segment<3>(3 * (lin.size() + i))    = H.rowwise().sum().array() - b;
+        J.template middleRows<3>(3 * (lin.size() + i)) = D * B;
+      }
+      eig::Vector<double, Samples> s = B * x;
+      for (uint i = 0; i < Samples; ++i) {
+        double v = s[i] > 1.0 ? s[i] - 1.0 : std::min(s[i], 0.0);
+        r[n_cstr + i] = v;
+        if (v != 0.0)
+          J.row(n_cstr + i) = B.row(i);
+        else
+          J.row(n_cstr + i).setZero();
+      }
     };
 
-    // Add boundary inequality constraints; upholding 0 <= x <= 1 for reflectances
-    {
-      auto A = (eig::Matrix<float, 2 * wavelength_samples, wavelength_bases>()
-        << info.basis.func, -info.basis.func).finished();
-      auto b = (eig::Array<float, 2 * wavelength_samples, 1>()
-        << Spec(1.f), Spec(0.f)).finished();
-      solver.nq_constraints_v.push_back({ .f   = opt::func_dot_v<wavelength_bases>(A, b), 
-                                          .n   = 2 * wavelength_samples, 
-                                          .tol = 1e-2 });
+    // SLSQP over the same constraints; the objective keeps the solution close to the start point,
+    // as the problem is typically underdetermined
+    auto solve_nlopt = [&](const vec &x_init) -> std::pair<vec, uint> {
+      auto objective = opt::func_squared_norm<Bases>(
+        eig::Matrix<double, Bases, Bases>::Identity(), x_init.array());
+
+      std::vector<opt::EqConstraint<detail::LinearNormFunc<Bases>>> eq_constraints;
+      for (const auto &[A, b] : lin)
+        eq_constraints.push_back({ .f = opt::func_norm<Bases>(A, b), .tol = 1e-4 });
+      std::vector<opt::EqConstraint<detail::PowerSeriesNormFunc<Samples, Bases>>> eq_constraints_nl;
+      for (const auto &[A, b] : nlin)
+        eq_constraints_nl.push_back({ .f = { .A = A, .B = B, .b = b }, .tol = 1e-4 });
+
+      opt::TypedWrapper<Bases,
+                        decltype(objective),
+                        decltype(eq_constraints),
+                        decltype(eq_constraints_nl),
+                        detail::BoundaryConstraint<Samples, Bases>> solver = {
+        .objective    = objective,
+        .constraints  = { std::move(eq_constraints), 
+                          std::move(eq_constraints_nl), 
+                          detail::boundary_constraint(info.basis, 1e-2) },
+        .x_init       = x_init,
+        .upper        = 1.0,
+        .lower        =-1.0,
+        .max_iters    = 256,
+        .rel_xpar_tol = 1e-3, // Threshold for objective error
+      };
+      
+      auto [coeffs, code] = solve(solver);
+      return { coeffs, opt::last_solve_evals() };
+    };
+
+    IndirectSpectrumStats stats;
+    if (info.backend == IndirectSpectrumInfoBase<Samples, Bases>::Backend::eNLopt) {
+      auto [x_nlopt, n_evals] = solve_nlopt(x);
+      stats.n_iters = n_evals;
+      if (info.stats)
+        *info.stats = stats;
+      return x_nlopt.template cast<float>().eval();
     }
 
+    eig::VectorXd r(n_rows), r_next(n_rows);
+    mat           J(n_rows, Bases), J_next(n_rows, Bases);
+    eval(x, r, J);
+    double err = r.squaredNorm();
+
+    // Projected Levenberg-Marquardt; take damped Gauss-Newton steps, clamped to the box 
+    // -1 <= x <= 1. The problem is typically underdetermined, and damping keeps steps small, 
+    // so the solution stays close to the warm start
+    using Status = IndirectSpectrumStats::Status;
+    double lambda = 1e-3;
+    stats.status = Status::eMaxIters;
+    for (; stats.n_iters < info.max_iters; ++stats.n_iters) {
+      // Converged if the residual vanishes; stalled in a local minimum if only the gradient does.
+      // As the gradient J^T r shrinks alongside the residual, its threshold is squared as well
+      vec g = J.transpose() * r;
+      if (err <= info.tol * info.tol) {
+        stats.status = Status::eConverged;
+        break;
+      } else if (g.template lpNorm<eig::Infinity>() <= info.tol * info.tol) {
+        stats.status = Status::eStalled;
+        break;
+      }
+
+      // Solve damped normal equations, then project step onto box
+      eig::Matrix<double, Bases, Bases> H = J.transpose() * J;
+      H.diagonal().array() += lambda;
+      vec x_next = (x - H.ldlt().solve(g)).cwiseMax(-1.0).cwiseMin(1.0);
+
+      // Accept step and relax damping if error improves, else increase damping and retry;
+      // stop if the accepted step vanishes, e.g. as it is clamped by the box, and stall if 
+      // damping grows too large
+      eval(x_next, r_next, J_next);
+      if (double err_next = r_next.squaredNorm(); err_next < err) {
+        double step = (x_next - x).norm();
+        std::swap(x, x_next);
+        std::swap(r, r_next);
+        std::swap(J, J_next);
+        err    = err_next;
+        lambda = std::max(lambda / 3.0, 1e-9);
+        if (step <= info.tol) {
+          stats.status = err <= info.tol * info.tol ? Status::eConverged : Status::eStalled;
+          stats.n_iters++;
+          break;
+        }
+      } else {
+        lambda *= 4.0;
+        if (lambda >= 1e8) {
+          stats.status = Status::eStalled;
+          stats.n_iters++;
+          break;
+        }
+      }
+    } // for (uint iter)
+
+    // Fall back to SLSQP if iterations did not converge, starting from the LM result; 
+    // its output is only taken if it reduces the residual
+    if (stats.status != Status::eConverged) {
+      auto [x_nlopt, n_evals] = solve_nlopt(x);
+      eval(x_nlopt, r_next, J_next);
+      if (r_next.squaredNorm() < err) {
+        x = x_nlopt;
+        stats.is_fallback = true;
+      }
+    }
+
+    if (info.stats)
+      *info.stats = stats;
+    return x.template cast<float>().eval();
+  }
+  
+  template <uint Samples, uint Bases>
+  std::vector<eig::Vector<float, Bases>> solve_mismatch_solid_coef(const DirectMismatchSolidInfoBase<Samples, Bases> &info) {
+    met_trace();
+
+    // Exact linear program over the shared feasible set, if requested
+    LPSolver<Bases> lp;
+    if (info.backend == DirectMismatchSolidInfoBase<Samples, Bases>::Backend::eLP)
+      lp = detail::init_boundary_lp(info.basis, info.linear_constraints, info.lp_mixed);
+
     // Add direct color system equality constraints, upholding uplifting roundtrip
+    std::vector<opt::EqConstraint<detail::LinearNormFunc<Bases>>> eq_constraints;
     for (const auto [csys, colr] : info.linear_constraints) {
       auto A = (csys.finalize(false).transpose() * info.basis.func).eval();
       auto b = lrgb_to_xyz(colr);
-      solver.eq_constraints.push_back({ .f   = opt::func_norm<wavelength_bases>(A, b), 
-                                        .tol = 1e-3 });
+      eq_constraints.push_back({ .f   = opt::func_norm<Bases>(A, b), 
+                                 .tol = 1e-3 });
     }
 
+    // Solver settings; the objective is set per sampled direction, and upholds 0 <= x <= 1 for reflectances
+    opt::TypedWrapper<Bases, 
+                      detail::LinearDotFunc<Bases>, 
+                      decltype(eq_constraints), 
+                      detail::BoundaryConstraint<Samples, Bases>> solver = {
+      .constraints  = { std::move(eq_constraints), detail::boundary_constraint(info.basis, 1e-2) },
+      .x_init       = 0.05,
+      .upper        = 1.0,
+      .lower        =-1.0,
+      .max_iters    = 128,
+      .rel_xpar_tol = 1e-3, // Threshold for objective error
+    };
+
     // Construct objective matrix from color system; follow Mackiewicz et al. to acquire
     // more efficient matrix U instead (see listing 9)
-    eig::MatrixXf S(wavelength_samples, 3 * info.linear_objectives.size());
+    eig::MatrixXf S(Samples, 3 * info.linear_objectives.size());
     for (uint i = 0; i < info.linear_objectives.size(); ++i)
-      S.block<wavelength_samples, 3>(0, 3 * i) = info.linear_objectives[i].finalize(false);
+      S.block<Samples, 3>(0, 3 * i) = info.linear_objectives[i].finalize(false);
     
     // Construct orthonormal matrix U instead, following listing 9 of Mackiewicz et al.
     /* {
@@ -187,159 +837,350 @@ namespace met {
       S = U;
     } */
     
-    // Output data structure 
-    std::vector<Basis::vec_type> output;
-    output.reserve(info.n_samples);
+    // Batched objective matrix; maps sampled directions to objectives over basis coefficients,
+    // s.t. for direction k, max (Sk)^T (B x) -> max (B^T S k)^T x -> max dot(a, x)
+    auto M = (info.basis.func.transpose() * S).eval();
+    
+    // Output data structure; one slot per direction, s.t. output order is independent of threads
+    std::vector<eig::Vector<float, Bases>> output(info.n_samples);
+    uint n_evals = 0;
 
-    // Parallel solve for boundary spectra
-    #pragma omp parallel
-    {
-      // Per thread copy of current solver parameter set
-      auto local_solver = solver;
-
-      // Iterate sampled unit vectors over threads
-      #pragma omp for
-      for (int i = 0; i < samples_nd.size(); ++i) {
-        // Define objective function: max (Uk)^T (B x -> max (C^T B) x -> max dot(a, x)
-        Basis::vec_type a = ((S * samples_nd[i]).transpose().eval() * info.basis.func).transpose().eval();
-        local_solver.objective = opt::func_dot<wavelength_bases>(a, 0.f);
-          
-        // Run solver and store recovered spectral distribution if it is safe
-        auto [coeffs, code] = solve(local_solver);
-        guard_continue(!coeffs.array().isNaN().any() && !coeffs.array().isZero());
-        #pragma omp critical
-        {
-          output.push_back(coeffs.cast<float>().eval());
-        }
-      } // for (int i)
-    }
+    // Iterate chunks of sampled unit vectors in nd, bounding memory for large nr. of objectives
+    const uint n_chunk = detail::solve_chunk_size(S.cols());
+    for (uint chunk = 0; chunk < info.n_samples; chunk += n_chunk) {
+      const uint n = std::min(n_chunk, info.n_samples - chunk);
+
+      // Generate chunk's directions and their objectives in one product, then order objectives
+      // to be coherent for warm-started solves
+      eig::MatrixXf     A    = M * detail::gen_unit_dirs(S.cols(), n, info.seed + chunk);
+      std::vector<uint> perm = detail::order_unit_dirs(A);
+
+      // Parallel solve for boundary spectra, over runs of consecutive directions
+      int run_size = detail::solve_run_size(n),
+          n_runs   = ceil_div(n, run_size);
+      #pragma omp parallel reduction(+ : n_evals)
+      {
+        // Per thread copy of current solver parameter set
+        auto local_solver = solver;
 
+        #pragma omp for schedule(dynamic)
+        for (int run = 0; run < n_runs; ++run) {
+          // Each run starts cold, from the default starting point and linear program state
+          auto local_state    = lp.init();
+          local_solver.x_init = solver.x_init;
+
+          int first = run * run_size,
+              last  = std::min<int>(first + run_size, n);
+          for (int i = first; i < last; ++i) {
+            eig::Vector<float, Bases> a = A.col(perm[i]);
+            auto &out = output[chunk + i];
+
+            // Attempt exact solve first, warm-started from the previous solution
+            if (lp.is_valid()) {
+              if (auto result = lp.solve(a.template cast<double>(), local_state); result.success) {
+                local_state = std::move(result);
+                out         = local_state.x.template cast<float>();
+                continue;
+              }
+            }
+
+            local_solver.objective = opt::func_dot<Bases>(a, 0.f);
+              
+            // Run solver and store recovered spectral distribution; unsafe results are removed below
+            auto [coeffs, code] = solve(local_solver);
+            n_evals += opt::last_solve_evals();
+            out      = coeffs.template cast<float>();
+
+            // Seed the next solve in this run from the current one, if it succeeded
+            if (info.warm_start && detail::is_valid_solve(out))
+              local_solver.x_init = coeffs;
+          } // for (int i)
+        } // for (int run)
+      }
+    } // for (uint chunk)
+
+    detail::compact_solve_output(output);
+    if (info.stats)
+      *info.stats = { .n_accepted = static_cast<uint>(output.size()), .n_evals = n_evals };
     return output;
   }
 
-  std::vector<Basis::vec_type> solve_mismatch_solid_coef(const IndirectMismatchSolidInfo &info) {
+  template <uint Samples, uint Bases>
+  std::vector<eig::Vector<float, Bases>> solve_mismatch_solid_exact_coef(const DirectMismatchSolidInfoBase<Samples, Bases> &info) {
     met_trace();
+    
+    using LP = LPSolver<Bases>;
 
-    // Helper value; basis functions in double
-    auto B = info.basis.func.cast<double>().eval();                      
+    // Upper limit to nr. of support queries, in case of numerical trouble
+    constexpr uint max_queries = 8192;
 
-    // This object will store settings, constraints, objectives, and is then passed to solver
-    opt::Wrapper<wavelength_bases> solver = {
-      .x_init       = 0.05,
-      .upper        = 1.0,
-      .lower        =-1.0,
-      .max_iters    = 256,
-      .rel_xpar_tol = 1e-3, // Threshold for objective error
+    // Linear program over the feasible set; if the constraints cannot be met, no volume exists
+    LP lp = detail::init_boundary_lp(info.basis, info.linear_constraints, info.lp_mixed);
+    guard(lp.is_valid(), { });
+
+    // Linear map from basis coefficients to output color, under the differentiating color system
+    auto M = (info.linear_objectives.back().finalize().transpose() * info.basis.func).template cast<double>().eval();
+
+    // Polytope vertices, and the linear program results that produced them; the latter
+    // are used to warm-start support queries near each vertex
+    std::vector<eig::Vector3d> verts;
+    std::vector<typename LP::Result>    states;
+    uint n_queries = 0;
+
+    // Support query; find the point of the mismatch volume furthest along direction n
+    auto query = [&](const eig::Vector3d &n, const typename LP::Result &warm) {
+      return lp.solve(-(M.transpose() * n).eval(), warm);
     };
 
-    // Add boundary inequality constraints; upholding 0 <= x <= 1 for reflectances
+    // Initial support queries along the principal axes; keep only distinct results
+    for (uint i = 0; i < 6; ++i) {
+      eig::Vector3d n = eig::Vector3d::Unit(i / 2) * (i % 2 ? -1.0 : 1.0);
+      auto result = query(n, lp.init());
+      n_queries++;
+      guard_continue(result.success);
+      eig::Vector3d p = M * result.x;
+      guard_continue(rng::none_of(verts, [&](const auto &v) { return v.isApprox(p, 1e-9); }));
+      verts.push_back(p);
+      states.push_back(std::move(result));
+    }
+
+    // Helper; return coefficients of all found points, for degenerate volumes
+    auto states_to_coeffs = [&] {
+      return states | vws::transform([](const auto &s) { return s.x.template cast<float>().eval(); }) 
+                    | view_to<std::vector<eig::Vector<float, Bases>>>();
+    };
+    guard(verts.size() >= 4, states_to_coeffs());
+
+    // Extent of the volume, for relative tolerances
+    eig::Vector3d minb = verts[0], maxb = verts[0];
+    for (const auto &v : verts) {
+      minb = minb.cwiseMin(v);
+      maxb = maxb.cwiseMax(v);
+    }
+
+    // Tolerances; points must lie eps beyond a facet to be inserted, and facet visibility
+    // during insertion uses a much tighter bound to keep the polytope consistently convex
+    double eps     = 1e-6 * std::max((maxb - minb).maxCoeff(), 1e-3);
+    double eps_vis = 1e-6 * eps;
+
+    // Find an initial simplex; p0, then furthest from p0, from line p0-p1, and from plane p0-p1-p2
+    std::array<uint, 4> simplex = { 0, 0, 0, 0 };
     {
-      auto A = (eig::Matrix<float, 2 * wavelength_samples, wavelength_bases>()
-        << info.basis.func, -info.basis.func).finished();
-      auto b = (eig::Array<float, 2 * wavelength_samples, 1>()
-        << Spec(1.f), Spec(0.f)).finished();
-      solver.nq_constraints_v.push_back({ .f   = opt::func_dot_v<wavelength_bases>(A, b), 
-                                          .n   = 2 * wavelength_samples, 
-                                          .tol = 1e-2 });
+      auto argmax = [&](auto f) { 
+        return static_cast<uint>(rng::distance(verts.begin(), rng::max_element(verts, {}, f))); 
+      };
+      const auto &p0 = verts[simplex[0]];
+      simplex[1] = argmax([&](const auto &v) { return (v - p0).squaredNorm(); });
+      eig::Vector3d e = (verts[simplex[1]] - p0).normalized();
+      simplex[2] = argmax([&](const auto &v) { return (v - p0 - e * e.dot(v - p0)).squaredNorm(); });
+      eig::Vector3d n = e.cross(verts[simplex[2]] - p0).normalized();
+      simplex[3] = argmax([&](const auto &v) { return std::abs(n.dot(v - p0)); });
+      
+      // Degenerate volume; no simplex exists, so we return the distinct points as-is
+      guard(std::abs(n.dot(verts[simplex[3]] - p0)) > eps, states_to_coeffs());
     }
+    eig::Vector3d interior = (verts[simplex[0]] + verts[simplex[1]] + verts[simplex[2]] + verts[simplex[3]]) / 4.0;
+
+    // Build initial polytope from the simplex, then insert remaining axis points
+    std::vector<detail::PolytopeFacet> facets;
+    for (uint i = 0; i < 4; ++i) {
+      eig::Array3u elem = { simplex[(i + 1) % 4], simplex[(i + 2) % 4], simplex[(i + 3) % 4] };
+      facets.push_back(detail::init_polytope_facet(verts, elem, interior));
+    }
+    for (uint i = 0; i < verts.size(); ++i) {
+      guard_continue(rng::find(simplex, i) == simplex.end());
+      detail::insert_polytope_vert(facets, verts, i, interior, eps_vis);
+    }
+
+    // Main loop; query the support along each non-final facet normal. If nothing lies beyond
+    // the facet, it is a facet of the mismatch volume; otherwise the support point is inserted.
+    // The loop terminates deterministically once no new facets appear.
+    // A requested stop, e.g. as the job went stale, ends enumeration without output.
+    while (n_queries < max_queries) {
+      guard(!info.stop.stop_requested(), { });
+
+      // Gather indices of non-final facets; these stay valid until insertion below
+      std::vector<uint> open;
+      for (uint i = 0; i < facets.size(); ++i)
+        if (!facets[i].is_final)
+          open.push_back(i);
+      guard_break(!open.empty());
+      n_queries += open.size();
+
+      // Parallel support queries, warm-started from a vertex of each facet
+      std::vector<typename LP::Result> results(open.size());
+      #pragma omp parallel for
+      for (int i = 0; i < open.size(); ++i)
+        results[i] = query(facets[open[i]].n, states[facets[open[i]].elem[0]]);
+
+      // Finalize facets which are supporting planes, and collect points beyond the others
+      std::vector<uint> inserts;
+      for (uint i = 0; i < open.size(); ++i) {
+        auto &f = facets[open[i]];
+        if (!results[i].success || f.n.dot(M * results[i].x) <= f.d + eps) {
+          f.is_final = true;
+          continue;
+        }
+        verts.push_back(M * results[i].x);
+        states.push_back(std::move(results[i]));
+        inserts.push_back(verts.size() - 1);
+      }
+
+      // Insert points sequentially; points that ended up inside are no longer needed
+      for (uint i : inserts)
+        detail::insert_polytope_vert(facets, verts, i, interior, eps_vis);
+    }
+
+    // Return coefficients of vertices that remain on the polytope
+    std::vector<bool> is_vert(verts.size(), false);
+    for (const auto &f : facets)
+      for (uint i : f.elem)
+        is_vert[i] = true;
+    std::vector<eig::Vector<float, Bases>> output;
+    for (uint i = 0; i < verts.size(); ++i) {
+      guard_continue(is_vert[i]);
+      output.push_back(states[i].x.template cast<float>());
+    }
+    return output;
+  }
+
+  template <uint Samples, uint Bases>
+  std::vector<eig::Vector<float, Bases>> solve_mismatch_solid_coef(const IndirectMismatchSolidInfoBase<Samples, Bases> &info) {
+    met_trace();
+
+    // Helper value; basis functions in double
+    auto B = info.basis.func.template cast<double>().eval();                      
 
     // Add direct color system equality constraints, upholding uplifting roundtrip
+    std::vector<opt::EqConstraint<detail::LinearNormFunc<Bases>>> eq_constraints;
     for (const auto [csys, colr] : info.linear_constraints) {
       auto A = (csys.finalize(false).transpose() * info.basis.func).eval();
       auto b = lrgb_to_xyz(colr);
-      solver.eq_constraints.push_back({ .f   = opt::func_norm<wavelength_bases>(A, b), 
-                                        .tol = 1e-3 });
+      eq_constraints.push_back({ .f   = opt::func_norm<Bases>(A, b), 
+                                 .tol = 1e-3 });
     }
 
     // Add indirect color system equality constraints, upholding uplifting roundtrip
+    std::vector<opt::EqConstraint<detail::PowerSeriesNormFunc<Samples, Bases>>> eq_constraints_nl;
     for (const auto [csys, colr] : info.nlinear_constraints) {
-      auto A = csys.finalize(false)
-             | vws::transform([](const CMFS &cmfs) { return cmfs.transpose().cast<double>().eval(); })
-             | view_to<std::vector<eig::Matrix<double, 3, wavelength_samples>>>();
-      auto b = lrgb_to_xyz(colr).cast<double>().eval();
-      
-      // Specify constraint
-      solver.eq_constraints.push_back({ .f = ad::wrap_capture<wavelength_bases>([A, B, b](const bvec &x) {
-        svec r  = B * x;                      // Compute full reflectance
-        auto Ax = (A[0].rowwise().sum()       // Nonlinear component, 0th part
-                +  A[1] * r).eval();          // Nonlinear component, 1st part
-        for (uint i = 2; i < A.size(); ++i) { // Nonlinear component, pth part
-          r = r.cwiseProduct(r);
-          Ax += A[i] * r;
-        }
-        return (Ax.array() - b).matrix().norm();
-      }), .tol = 1e-3 });
+      detail::PowerSeriesNormFunc<Samples, Bases> f = {
+        .A = csys.finalize(false)
+           | vws::transform([](const CMFSBase<Samples> &cmfs) { return cmfs.transpose().template cast<double>().eval(); })
+           | view_to<std::vector<detail::PowerSeriesTerm<3, Samples>>>(),
+        .B = B,
+        .b = lrgb_to_xyz(colr).template cast<double>().eval()
+      };
+      eq_constraints_nl.push_back({ .f = std::move(f), .tol = 1e-3 });
     }
 
+    // This object will store settings, constraints, objectives, and is then passed to solver;
+    // the objective is set per sampled direction, and boundary constraints uphold 0 <= x <= 1
+    opt::TypedWrapper<Bases,
+                      detail::PowerSeriesDotFunc<Samples, Bases>,
+                      decltype(eq_constraints),
+                      decltype(eq_constraints_nl),
+                      detail::BoundaryConstraint<Samples, Bases>> solver = {
+      .constraints  = { std::move(eq_constraints), 
+                        std::move(eq_constraints_nl), 
+                        detail::boundary_constraint(info.basis, 1e-2) },
+      .x_init       = 0.05,
+      .upper        = 1.0,
+      .lower        =-1.0,
+      .max_iters    = 256,
+      .rel_xpar_tol = 1e-3, // Threshold for objective error
+    };
+
     // Construct objective matrices from color system and power series
     std::vector<eig::MatrixXf> S;
     // Helper value; dynamic matrix of specific size set to all zeroes
-    eig::MatrixXf S_zero(wavelength_samples, 3 * info.nlinear_objectives.size());
+    eig::MatrixXf S_zero(Samples, 3 * info.nlinear_objectives.size());
     S_zero.fill(0.f);
     for (uint i = 0; i < info.nlinear_objectives.size(); ++i) {
       auto powers = info.nlinear_objectives[i].finalize(false);
       if (S.size() < powers.size())
         S.resize(powers.size(), S_zero);
       for (uint j = 0; j < powers.size(); ++j)
-        S[j].block<wavelength_samples, 3>(0, 3 * i) = powers[j];
+        S[j].block<Samples, 3>(0, 3 * i) = powers[j];
     }
 
-    // Sample unit vectors in 3*nd; total nr. of nonlinear objectives is counted
-    auto samples = detail::gen_unit_dirs(info.nlinear_objectives.size(), info.n_samples, info.seed);
+    // Output data structure; one slot per direction, s.t. output order is independent of threads
+    std::vector<eig::Vector<float, Bases>> output(info.n_samples);
+    uint n_evals = 0;
 
-    // Output data structure 
-    std::vector<Basis::vec_type> output;
-    output.reserve(info.n_samples);
+    // Iterate chunks of sampled unit vectors in 3*nd, bounding memory for large nr. of objectives;
+    // total nr. of nonlinear objectives is counted
+    const uint n_dims  = S_zero.cols(), 
+               n_chunk = detail::solve_chunk_size(n_dims * std::max<uint>(S.size(), 1));
+    for (uint chunk = 0; chunk < info.n_samples; chunk += n_chunk) {
+      const uint n = std::min(n_chunk, info.n_samples - chunk);
 
-    // Parallel solve for boundary spectra
-    #pragma omp parallel 
-    {
-      // Per thread copy of current solver parameter set
-      auto local_solver = solver;
-
-      // Iterate sampled unit vectors over threads
-      #pragma omp for
-      for (int i = 0; i < samples.size(); ++i) {
-        // Project nonlinear objective matrices along sampled unit vector
-        auto A = S | vws::transform([sample = samples[i]](const eig::MatrixXf &cmfs) {
-          return eig::Vector<double, wavelength_samples>((cmfs * sample).cast<double>());
-        }) | view_to<std::vector<eig::Vector<double, wavelength_samples>>>();
-
-        // Specify objective
-        local_solver.objective = ad::wrap_capture<wavelength_bases>([A, B](const bvec &x) {
-          svec r = B * x;                       // Compute full reflectance
-          auto f = A[0].sum()                   // Nonlinear objective, 0th part
-                 + A[1].dot(r);                 // Nonlinear objective, 1st part
-          for (uint i = 2; i < A.size(); ++i) { // Nonlinear objective, pth part
-            r = r.cwiseProduct(r);
-            f += A[i].dot(r);
-          }
-          return f;
-        });
+      // Batched objective matrices; project each power's objective matrix along all of the 
+      // chunk's directions in one product
+      auto samples = detail::gen_unit_dirs(n_dims, n, info.seed + chunk);
+      auto T = S | vws::transform([&samples](const eig::MatrixXf &cmfs) { return (cmfs * samples).eval(); })
+                 | view_to<std::vector<eig::MatrixXf>>();
 
-        // Run solver and store recovered spectral distribution if it is safe
-        auto [coeffs, code] = solve(local_solver);
-        guard_continue(!coeffs.array().isNaN().any() && !coeffs.array().isZero());
+      // Order directions by the objective's gradient at unit reflectance, sum_p p B^T T_p,
+      // to be coherent for warm-started solves
+      eig::MatrixXf G = eig::MatrixXf::Zero(Samples, n);
+      for (uint p = 1; p < T.size(); ++p)
+        G += static_cast<float>(p) * T[p];
+      std::vector<uint> perm = detail::order_unit_dirs((info.basis.func.transpose() * G).eval());
 
-        #pragma omp critical
-        {
-          output.push_back(coeffs.cast<float>().eval());
-        }
-      } // for (int i)
-    }
+      // Parallel solve for boundary spectra, over runs of consecutive directions
+      int run_size = detail::solve_run_size(n),
+          n_runs   = ceil_div(n, run_size);
+      #pragma omp parallel reduction(+ : n_evals)
+      {
+        // Per thread copy of current solver parameter set
+        auto local_solver = solver;
+
+        #pragma omp for schedule(dynamic)
+        for (int run = 0; run < n_runs; ++run) {
+          // Each run starts cold, from the default starting point
+          local_solver.x_init = solver.x_init;
+
+          int first = run * run_size,
+              last  = std::min<int>(first + run_size, n);
+          for (int i = first; i < last; ++i) {
+            auto &out = output[chunk + i];
+
+            // Specify objective; take projected objective matrices along sampled unit vector
+            local_solver.objective = {
+              .A = T | vws::transform([j = perm[i]](const eig::MatrixXf &t) {
+                return detail::PowerSeriesTerm<1, Samples>(t.col(j).transpose().template cast<double>());
+              }) | view_to<std::vector<detail::PowerSeriesTerm<1, Samples>>>(),
+              .B = B
+            };
+
+            // Run solver and store recovered spectral distribution; unsafe results are removed below
+            auto [coeffs, code] = solve(local_solver);
+            n_evals += opt::last_solve_evals();
+            out      = coeffs.template cast<float>();
+
+            // Seed the next solve in this run from the current one, if it succeeded
+            if (info.warm_start && detail::is_valid_solve(out))
+              local_solver.x_init = coeffs;
+          } // for (int i)
+        } // for (int run)
+      }
+    } // for (uint chunk)
     
+    detail::compact_solve_output(output);
+    if (info.stats)
+      *info.stats = { .n_accepted = static_cast<uint>(output.size()), .n_evals = n_evals };
     return output;
   }
 
-  std::vector<Basis::vec_type> solve_color_solid_coef(const ColorSolidInfo &info) {
+  template <uint Samples, uint Bases>
+  std::vector<eig::Vector<float, Bases>> solve_color_solid_coef(const ColorSolidInfoBase<Samples, Bases> &info) {
     met_trace();
 
     // Sample unit vectors in 3d
     auto samples = detail::gen_unit_dirs<3>(info.n_samples, info.seed);
 
-    // Output for parallel solve
-    std::vector<Basis::vec_type> output;
-    output.reserve(samples.size());
+    // Output for parallel solve; one slot per direction, s.t. output order is independent of threads
+    std::vector<eig::Vector<float, Bases>> output(samples.size());
 
     // Construct objective function
     auto A = info.direct_objective.finalize();
@@ -348,96 +1189,164 @@ namespace met {
     #pragma omp parallel for
     for (int i = 0; i < samples.size(); ++i) {
       // Obtain actual spectrum by projecting sample onto optimal
-      Spec s = (A * samples[i].matrix()).eval();
+      SpecBase<Samples> s = (A * samples[i].matrix()).eval();
       for (auto &f : s)
         f = f >= 0.f ? 1.f : 0.f;
 
       // Find nearest valid spectrum within basis
-      auto c = solve_spectrum_coef(DirectSpectrumInfo {
+      auto c = solve_spectrum_coef(DirectSpectrumInfoBase<Samples, Bases> {
         .linear_constraints = {{ info.direct_objective, info.direct_objective(s) }},
         .basis = info.basis
       });
 
-      // Store valid sample
-      guard_continue(!c.array().isNaN().any() && !c.array().isZero());
-      #pragma omp critical
-      {
-        output.push_back(c);
-      }
+      // Store sample; unsafe results are removed below
+      output[i] = c;
     }
     
+    detail::compact_solve_output(output);
     return output;
   }
 
-  std::vector<MismatchSample> solve_color_solid(const ColorSolidInfo &info) {
+  template <uint Samples, uint Bases>
+  std::vector<MismatchSampleBase<Samples, Bases>> solve_color_solid(const ColorSolidInfoBase<Samples, Bases> &info) {
     met_trace();
     auto coeffs = solve_color_solid_coef(info);
-    std::vector<MismatchSample> s(coeffs.size());
+    std::vector<MismatchSampleBase<Samples, Bases>> s(coeffs.size());
     std::transform(std::execution::par_unseq,
                    range_iter(coeffs),
                    s.begin(),
                    [&](const auto &coef) { 
                     auto spec = info.basis(coef);
                     auto colr = info.direct_objective(spec);
-                    return MismatchSample { colr, spec, coef }; 
+                    return MismatchSampleBase<Samples, Bases> { colr, spec, coef }; 
                   });
     return s;
   }
 
-  Basis::vec_type solve_spectrum_coef(const SpectrumCoeffsInfo &info) {
+  template <uint Samples, uint Bases>
+  eig::Vector<float, Bases> solve_spectrum_coef(const SpectrumCoeffsInfoBase<Samples, Bases> &info) {
     met_trace();
     
-    // This object will store settings, constraints, objectives, and is then passed to solver
-    opt::Wrapper<wavelength_bases> solver = {
+    // Objective function minimizes l2 norm over spectral distribution differences
+    auto objective = opt::func_squared_norm<Bases>(info.basis.func, info.spec);
+
+    // This object will store settings, constraints, objectives, and is then passed to solver;
+    // boundary inequality constraints uphold spectral 0 <= x <= 1
+    opt::TypedWrapper<Bases, decltype(objective), detail::BoundaryConstraint<Samples, Bases>> solver = {
+      .objective    = objective,
+      .constraints  = { detail::boundary_constraint(info.basis, 1e-3) },
       .x_init       = 0.05,
       .upper        = 1.0,
       .lower        =-1.0,
       .max_iters    = 512,   // Failsafe
       .rel_xpar_tol = 1e-5, // Threshold for objective error
     };
-
-    // Add boundary inequality constraints, upholding spectral 0 <= x <= 1
-    {
-      auto A = (eig::Matrix<float, 2 * wavelength_samples, wavelength_bases>()
-        << info.basis.func, -info.basis.func).finished();
-      auto b = (eig::Array<float, 2 * wavelength_samples, 1>()
-        << Spec(1.f), Spec(0.f)).finished();
-      solver.nq_constraints_v.push_back({ .f   = opt::func_dot_v<wavelength_bases>(A, b),
-                                          .n   = 2 * wavelength_samples, 
-                                          .tol = 1e-3 });
-    }
-
-    // Objective function minimizes l2 norm over spectral distribution differences
-    solver.objective = opt::func_squared_norm<wavelength_bases>(info.basis.func, info.spec);
     
     // Run solve and return result
     auto [coeffs, code] = solve(solver);
-    return coeffs.cast<float>().cwiseMax(-1.f).cwiseMin(1.f).eval();
+    return coeffs.template cast<float>().cwiseMax(-1.f).cwiseMin(1.f).eval();
   }
   
-  std::vector<MismatchSample> solve_mismatch_solid(const DirectMismatchSolidInfo &info) {
+  template <uint Samples, uint Bases>
+  std::vector<MismatchSampleBase<Samples, Bases>> solve_mismatch_solid(const DirectMismatchSolidInfoBase<Samples, Bases> &info) {
     met_trace();
     auto c = solve_mismatch_solid_coef(info);
-    std::vector<MismatchSample> v(c.size());
+    std::vector<MismatchSampleBase<Samples, Bases>> v(c.size());
+    std::transform(std::execution::par_unseq,
+                   range_iter(c), v.begin(),
+                   [&info](const auto &c) { 
+                    auto spec = info.basis(c);
+                    auto colr = info.linear_objectives.back()(spec);
+                    return MismatchSampleBase<Samples, Bases> { colr, spec, c }; }); // the differentiating color system generates output
+    return v;
+  }
+  
+  template <uint Samples, uint Bases>
+  std::vector<MismatchSampleBase<Samples, Bases>> solve_mismatch_solid_exact(const DirectMismatchSolidInfoBase<Samples, Bases> &info) {
+    met_trace();
+    auto c = solve_mismatch_solid_exact_coef(info);
+    std::vector<MismatchSampleBase<Samples, Bases>> v(c.size());
     std::transform(std::execution::par_unseq,
                    range_iter(c), v.begin(),
                    [&info](const auto &c) { 
                     auto spec = info.basis(c);
                     auto colr = info.linear_objectives.back()(spec);
-                    return MismatchSample { colr, spec, c }; }); // the differentiating color system generates output
+                    return MismatchSampleBase<Samples, Bases> { colr, spec, c }; }); // the differentiating color system generates output
     return v;
   }
   
-  std::vector<MismatchSample> solve_mismatch_solid(const IndirectMismatchSolidInfo &info) {
+  template <uint Samples, uint Bases>
+  std::vector<MismatchSampleBase<Samples, Bases>> solve_mismatch_solid(const IndirectMismatchSolidInfoBase<Samples, Bases> &info) {
     met_trace();
     auto c = solve_mismatch_solid_coef(info);
-    std::vector<MismatchSample> v(c.size());
+    std::vector<MismatchSampleBase<Samples, Bases>> v(c.size());
     std::transform(std::execution::par_unseq,
                    range_iter(c), v.begin(),
                    [&info](const auto &c) { 
                     auto spec = info.basis(c);
                     auto colr = info.nlinear_objectives.back()(spec);
-                    return MismatchSample { colr, spec, c }; }); // the differentiating color system generates output
+                    return MismatchSampleBase<Samples, Bases> { colr, spec, c }; }); // the differentiating color system generates output
     return v;
   }
+
+  template <uint Samples, uint Bases, uint SamplesIn, uint BasesIn>
+  std::vector<MismatchSampleBase<Samples, Bases>> resample_mismatch_samples(const std::vector<MismatchSampleBase<SamplesIn, BasesIn>> &samples, 
+                                                                            const BasisBase<SamplesIn, BasesIn>                        &basis_in,
+                                                                            const BasisBase<Samples, Bases>                            &basis) {
+    met_trace();
+
+    // Refitting is a single linear map between coefficients; fit the output basis, resampled 
+    // to the input layout, against the input basis
+    eig::Matrix<float, SamplesIn, Bases> func = detail::resample_matrix<SamplesIn, Samples>() * basis.func;
+    eig::Matrix<float, Bases, BasesIn>   M    = func.colPivHouseholderQr().solve(basis_in.func);
+
+    std::vector<MismatchSampleBase<Samples, Bases>> out(samples.size());
+    for (uint i = 0; i < samples.size(); ++i) {
+      out[i].colr = samples[i].colr;
+      out[i].coef = M * samples[i].coef;
+      out[i].spec = basis(out[i].coef);
+    }
+    return out;
+  }
+
+  /* Explicit template instantiations */
+
+  #define declare_function_layout(Samples, Bases)                                                                                   \
+    template                                                                                                                        \
+    eig::Vector<float, Bases> solve_spectrum_coef<Samples, Bases>(const SpectrumCoeffsInfoBase<Samples, Bases> &);                  \
+    template                                                                                                                        \
+    eig::Vector<float, Bases> solve_spectrum_coef<Samples, Bases>(const DirectSpectrumInfoBase<Samples, Bases> &);                  \
+    template                                                                                                                        \
+    eig::Vector<float, Bases> solve_spectrum_coef<Samples, Bases>(const IndirectSpectrumInfoBase<Samples, Bases> &);                \
+    template                                                                                                                        \
+    std::vector<eig::Vector<float, Bases>> solve_spectrum_coef<Samples, Bases>(const DirectSpectrumBatchInfoBase<Samples, Bases> &); \
+    template                                                                                                                        \
+    std::vector<eig::Vector<float, Bases>> solve_color_solid_coef<Samples, Bases>(const ColorSolidInfoBase<Samples, Bases> &);      \
+    template                                                                                                                        \
+    std::vector<eig::Vector<float, Bases>> solve_mismatch_solid_coef<Samples, Bases>(const DirectMismatchSolidInfoBase<Samples, Bases> &);       \
+    template                                                                                                                        \
+    std::vector<eig::Vector<float, Bases>> solve_mismatch_solid_coef<Samples, Bases>(const IndirectMismatchSolidInfoBase<Samples, Bases> &);     \
+    template                                                                                                                        \
+    std::vector<eig::Vector<float, Bases>> solve_mismatch_solid_exact_coef<Samples, Bases>(const DirectMismatchSolidInfoBase<Samples, Bases> &); \
+    template                                                                                                                        \
+    std::vector<MismatchSampleBase<Samples, Bases>> solve_color_solid<Samples, Bases>(const ColorSolidInfoBase<Samples, Bases> &);                \
+    template                                                                                                                        \
+    std::vector<MismatchSampleBase<Samples, Bases>> solve_mismatch_solid<Samples, Bases>(const DirectMismatchSolidInfoBase<Samples, Bases> &);    \
+    template                                                                                                                        \
+    std::vector<MismatchSampleBase<Samples, Bases>> solve_mismatch_solid<Samples, Bases>(const IndirectMismatchSolidInfoBase<Samples, Bases> &);  \
+    template                                                                                                                        \
+    std::vector<MismatchSampleBase<Samples, Bases>> solve_mismatch_solid_exact<Samples, Bases>(const DirectMismatchSolidInfoBase<Samples, Bases> &); \
+    template                                                                                                                        \
+    detail::BoundaryConstraint<Samples, Bases> detail::boundary_constraint<Samples, Bases>(const BasisBase<Samples, Bases> &, double);
+
+  declare_function_layout(wavelength_samples, wavelength_bases)
+#if MET_PREVIEW_WAVELENGTH_SAMPLES != MET_WAVELENGTH_SAMPLES || MET_PREVIEW_WAVELENGTH_BASES != MET_WAVELENGTH_BASES
+  declare_function_layout(preview_wavelength_samples, preview_wavelength_bases)
+#endif
+
+  // Mapping of preview layout samples to the build's layout; an identity refit if both match
+  template 
+  std::vector<MismatchSample> resample_mismatch_samples(const std::vector<MismatchSampleBase<preview_wavelength_samples, preview_wavelength_bases>> &, 
+                                                        const BasisBase<preview_wavelength_samples, preview_wavelength_bases>                      &,
+                                                        const Basis                                                                               &);
 } // namespace met
\ No newline at end of file
@@ -0,0 +1,307 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <metameric/core/qp.hpp>
+#include <metameric/core/spectrum.hpp>
+#include <algorithm>
+#include <limits>
+
+namespace met {
+  namespace detail {
+    constexpr double qp_eps = std::numeric_limits<double>::epsilon();
+    constexpr double qp_inf = std::numeric_limits<double>::infinity();
+
+    // Active set of the dual method; stores constraint indices and multipliers, and
+    // the factorization J = L^-T Q, R s.t. J^T N = [R 0]^T for active constraint normals N
+    template <uint N>
+    struct QPActiveSet {
+      using vec = eig::Vector<double, N>;
+      using mat = eig::Matrix<double, N, N>;
+
+      mat                          J, R;
+      double                       R_norm;
+      uint                         q = 0; // Nr. of active constraints
+      std::array<int,    N + 1>    A;     // Active constraint indices; equalities are negative
+      std::array<double, N + 1>    u;     // Active constraint multipliers
+
+      // Add a constraint, given d = J^T n for its normal n; reduce d[q+1:] to zero
+      // through Givens rotations on J, then append d[:q+1] as column of R
+      bool add(vec &d) {
+        for (int j = N - 1; j >= static_cast<int>(q) + 1; --j) {
+          double cc = d[j - 1], ss = d[j], h = std::hypot(cc, ss);
+          guard_continue(h != 0.0);
+          d[j] = 0.0;
+          cc /= h;
+          ss /= h;
+          if (cc < 0.0) {
+            cc = -cc; ss = -ss; d[j - 1] = -h;
+          } else {
+            d[j - 1] = h;
+          }
+          double xny = ss / (1.0 + cc);
+          for (uint k = 0; k < N; ++k) {
+            double t1 = J(k, j - 1), t2 = J(k, j);
+            J(k, j - 1) = t1 * cc + t2 * ss;
+            J(k, j)     = xny * (t1 + J(k, j - 1)) - t2;
+          }
+        }
+
+        q++;
+        R.col(q - 1).head(q) = d.head(q);
+
+        // Linearly dependent constraint; reject
+        guard(std::abs(d[q - 1]) > qp_eps * R_norm, false);
+        R_norm = std::max(R_norm, std::abs(d[q - 1]));
+        return true;
+      }
+
+      // Remove the active constraint at position i of the active set, and restore
+      // the triangular form of R through Givens rotations
+      void remove(uint i) {
+        for (uint k = i; k + 1 < q; ++k) {
+          A[k] = A[k + 1];
+          u[k] = u[k + 1];
+          R.col(k) = R.col(k + 1);
+        }
+        A[q - 1] = A[q];
+        u[q - 1] = u[q];
+        A[q]     = 0;
+        u[q]     = 0.0;
+        R.col(q - 1).head(q).setZero();
+        q--;
+
+        guard(q > 0);
+        for (uint j = i; j < q; ++j) {
+          double cc = R(j, j), ss = R(j + 1, j), h = std::hypot(cc, ss);
+          guard_continue(h != 0.0);
+          cc /= h;
+          ss /= h;
+          R(j + 1, j) = 0.0;
+          if (cc < 0.0) {
+            R(j, j) = -h; cc = -cc; ss = -ss;
+          } else {
+            R(j, j) = h;
+          }
+          double xny = ss / (1.0 + cc);
+          for (uint k = j + 1; k < q; ++k) {
+            double t1 = R(j, k), t2 = R(j + 1, k);
+            R(j, k)     = t1 * cc + t2 * ss;
+            R(j + 1, k) = xny * (t1 + R(j, k)) - t2;
+          }
+          for (uint k = 0; k < N; ++k) {
+            double t1 = J(k, j), t2 = J(k, j + 1);
+            J(k, j)     = t1 * cc + t2 * ss;
+            J(k, j + 1) = xny * (J(k, j) + t1) - t2;
+          }
+        }
+      }
+
+      // Compute step direction z in primal space, and r in dual space, for a constraint
+      // normal n; also returns d = J^T n for use in add()
+      void step_dirs(const vec &n, vec &d, vec &z, vec &r) const {
+        d = J.transpose() * n;
+        z = J.rightCols(N - q) * d.tail(N - q);
+        r.head(q) = R.topLeftCorner(q, q).template triangularView<eig::Upper>().solve(d.head(q));
+      }
+    };
+  } // namespace detail
+
+  template <uint N>
+  QPSolver<N>::QPSolver(CreateInfo &&info)
+  : m_C(std::move(info.C)),
+    m_G(std::move(info.G)) {
+    met_trace();
+    debug::check_expr(m_C.rows() <= N, "QPSolver: equality block exceeds problem dimension");
+
+    // Factorize H = L L^T, and set J = L^-T
+    m_llt = info.H.llt();
+    guard(m_llt.info() == eig::Success);
+    m_J = m_llt.matrixU().solve(mat::Identity());
+    m_R.setZero();
+    m_R_norm = 1.0;
+    m_trace  = info.H.trace() * m_J.trace();
+
+    // Add equality constraints; the resulting factorization does not depend
+    // on the right-hand side d, so we can keep it around for every solve
+    detail::QPActiveSet<N> active = { .J = m_J, .R = m_R, .R_norm = m_R_norm };
+    for (uint i = 0; i < m_C.rows(); ++i) {
+      vec d = active.J.transpose() * m_C.row(i).transpose();
+      guard(active.add(d));
+    }
+    m_J        = active.J;
+    m_R        = active.R;
+    m_R_norm   = active.R_norm;
+    m_is_valid = true;
+  }
+
+  template <uint N>
+  typename QPSolver<N>::Result QPSolver<N>::solve(const vec &g, const eig::VectorXd &d, const eig::VectorXd &h) const {
+    met_trace();
+    debug::check_expr(d.size() == m_C.rows() && h.size() == m_G.rows(),
+                      "QPSolver: right-hand side does not match constraint sizes");
+
+    Result result = { .x = vec::Zero() };
+    guard(m_is_valid, result);
+
+    const uint n_eq = m_C.rows(), n_nq = m_G.rows();
+
+    // Restore the factorization state with the equality block active
+    detail::QPActiveSet<N> active = { .J = m_J, .R = m_R, .R_norm = m_R_norm, .q = n_eq };
+    for (uint i = 0; i < n_eq; ++i)
+      active.A[i] = -static_cast<int>(i) - 1;
+
+    // Unconstrained minimum x = -H^-1 g, then solve directly for the minimum on the
+    // equality constrained subspace; x += J_1 R^-T (d - C x), with u = R^-1 R^-T (d - C x)
+    vec x = m_llt.solve(-g);
+    if (n_eq > 0) {
+      auto R_eq = m_R.topLeftCorner(n_eq, n_eq);
+      eig::VectorXd y = R_eq.transpose().template triangularView<eig::Lower>().solve(d - m_C * x);
+      x += m_J.leftCols(n_eq) * y;
+      eig::VectorXd u = R_eq.template triangularView<eig::Upper>().solve(y);
+      for (uint i = 0; i < n_eq; ++i)
+        active.u[i] = u[i];
+    }
+
+    // Helper data for the inequality iterations
+    std::vector<double> s(n_nq);          // Constraint slack, h - G x
+    std::vector<bool>   is_active(n_nq);  // Constraint is in active set
+    std::vector<bool>   is_allowed(n_nq); // Constraint can be selected for addition
+    detail::QPActiveSet<N> active_prev;
+    vec x_prev, z, r, dv;
+
+    // Main loop; find the most violated inequality, then add it to the active set
+    // through a sequence of partial and full steps
+    constexpr uint max_iters = 16 * (N + 1);
+    bool is_restored = false;
+    while (result.iters < max_iters) {
+      if (!is_restored) {
+        result.iters++;
+
+        // Step 1; compute constraint violations, exit if x is feasible
+        double psi = 0.0;
+        for (uint i = 0; i < n_nq; ++i) {
+          s[i] = h[i] - m_G.row(i).dot(x);
+          psi += std::min(0.0, s[i]);
+        }
+        if (std::abs(psi) <= n_nq * detail::qp_eps * m_trace * 100.0) {
+          result.success = true;
+          break;
+        }
+
+        // Store current state, in case adding a constraint fails later
+        std::fill(range_iter(is_allowed), true);
+        active_prev = active;
+        x_prev      = x;
+      }
+      is_restored = false;
+
+      // Step 2; select most violated constraint that is not active
+      int    p  = -1;
+      double ss = 0.0;
+      for (uint i = 0; i < n_nq; ++i) {
+        guard_continue(!is_active[i] && is_allowed[i] && s[i] < ss);
+        ss = s[i];
+        p  = i;
+      }
+      if (p < 0) {
+        result.success = true;
+        break;
+      }
+
+      // Constraint normal in >= form, i.e. -G_p x >= -h_p
+      vec n = -m_G.row(p).transpose();
+      active.u[active.q] = 0.0;
+      active.A[active.q] = p;
+
+      bool is_added = false;
+      while (!is_added) {
+        // Step 2a; determine step direction in primal (z) and dual (r) space
+        active.step_dirs(n, dv, z, r);
+
+        // Step 2b; partial step length t1, from the first inequality multiplier to hit zero
+        double t1 = detail::qp_inf;
+        uint   l  = 0;
+        for (uint k = n_eq; k < active.q; ++k) {
+          guard_continue(r[k] > 0.0 && active.u[k] / r[k] < t1);
+          t1 = active.u[k] / r[k];
+          l  = k;
+        }
+
+        // Full step length t2, s.t. the selected constraint becomes satisfied
+        double t2 = detail::qp_inf;
+        if (z.squaredNorm() > detail::qp_eps) {
+          t2 = -s[p] / z.dot(n);
+          if (t2 < 0.0)
+            t2 = detail::qp_inf;
+        }
+
+        // Step 2c; no step possible in primal or dual space, so the problem is infeasible
+        double t = std::min(t1, t2);
+        if (t >= detail::qp_inf) {
+          result.x = x;
+          return result;
+        }
+
+        // Step in dual space only; drop the blocking constraint and retry
+        if (t2 >= detail::qp_inf) {
+          for (uint k = 0; k < active.q; ++k)
+            active.u[k] -= t * r[k];
+          active.u[active.q] += t;
+          is_active[active.A[l]] = false;
+          active.remove(l);
+          continue;
+        }
+
+        // Step in primal and dual space
+        x += t * z;
+        for (uint k = 0; k < active.q; ++k)
+          active.u[k] -= t * r[k];
+        active.u[active.q] += t;
+
+        if (std::abs(t - t2) <= detail::qp_eps) {
+          // Full step; add constraint to the active set
+          if (active.add(dv)) {
+            is_active[p] = true;
+          } else {
+            // Constraint is linearly dependent on the active set; restore the prior
+            // state and select a different constraint without recomputing slack
+            active = active_prev;
+            x      = x_prev;
+            std::fill(range_iter(is_active), false);
+            for (uint k = n_eq; k < active.q; ++k)
+              is_active[active.A[k]] = true;
+            is_allowed[p] = false;
+            is_restored   = true;
+          }
+          is_added = true;
+        } else {
+          // Partial step; drop the blocking constraint, update slack, and retry
+          is_active[active.A[l]] = false;
+          active.remove(l);
+          s[p] = h[p] - m_G.row(p).dot(x);
+        }
+      } // while (!is_added)
+    } // while (result.iters < max_iters)
+
+    result.x = x;
+    return result;
+  }
+
+  // Explicit template class instantiations
+  template class QPSolver<wavelength_bases>;
+#if MET_PREVIEW_WAVELENGTH_BASES != MET_WAVELENGTH_BASES
+  template class QPSolver<preview_wavelength_bases>;
+#endif
+} // namespace met
\ No newline at end of file
@@ -0,0 +1,204 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <metameric/core/solid_cache.hpp>
+#include <metameric/core/ranges.hpp>
+#include <metameric/core/serialization.hpp>
+#include <metameric/core/spectrum.hpp>
+#include <algorithm>
+#include <fstream>
+#include <span>
+#include <thread>
+
+namespace met {
+  namespace detail {
+    // Version tag of on-disk entries; bump if boundary sampling or the file layout changes
+    constexpr uint solid_cache_version = 2;
+
+    // 64-bit FNV-1a hash, accumulated over the raw bytes of trivially copyable data
+    struct SolidCacheHash {
+      size_t h = 0xcbf29ce484222325ull;
+
+      template <typename Ty>
+      SolidCacheHash &operator()(const Ty &ty) {
+        for (std::byte b : std::as_bytes(std::span(&ty, 1)))
+          h = (h ^ std::to_integer<size_t>(b)) * 0x100000001b3ull;
+        return *this;
+      }
+    };
+
+    // Content hash over all inputs that determine the generated boundary samples
+    size_t solid_cache_key(const ColorSolidInfo &info) {
+      met_trace();
+      return SolidCacheHash()
+        (solid_cache_version)(wavelength_samples)(wavelength_bases)
+        (info.direct_objective.cmfs)(info.direct_objective.illuminant)
+        (info.basis.func)(info.seed)(info.n_samples).h;
+    }
+
+    fs::path solid_cache_path(const fs::path &dir, size_t key) {
+      return dir / fmt::format("{:016x}.solid", key);
+    }
+
+    // Attempt to load an entry from disk; on success, the file is touched s.t. its
+    // write time tracks last use for LRU eviction
+    ColorSolidCache::entry_type load_solid_disk(const fs::path &dir, size_t key) {
+      met_trace();
+      guard(!dir.empty(), nullptr);
+
+      auto path = solid_cache_path(dir, key);
+      std::ifstream ifs(path, std::ios::binary);
+      guard(ifs.is_open(), nullptr);
+
+      // Reject entries of a different version, or hash collisions between file names
+      uint   version  = 0;
+      size_t file_key = 0;
+      io::from_stream(version,  ifs);
+      io::from_stream(file_key, ifs);
+      guard(ifs && version == solid_cache_version && file_key == key, nullptr);
+
+      ColorSolidCache::Entry entry;
+      io::from_stream(entry, ifs);
+      guard(ifs, nullptr);
+
+      std::error_code ec;
+      fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+      return std::make_shared<const ColorSolidCache::Entry>(std::move(entry));
+    }
+
+    // Store an entry on disk, then evict least recently used entries until the size cap is met;
+    // failure is not an error, as the cache is only an optimization
+    void store_solid_disk(const fs::path &dir, size_t max_bytes, size_t key, const ColorSolidCache::entry_type &entry) {
+      met_trace();
+      guard(!dir.empty());
+
+      std::error_code ec;
+      fs::create_directories(dir, ec);
+      guard(!ec);
+
+      // Write to a temporary file first, s.t. concurrent readers never observe partial entries
+      auto path = solid_cache_path(dir, key);
+      auto temp = io::path_with_ext(path, fmt::format(".{}.tmp", std::hash<std::thread::id>()(std::this_thread::get_id())));
+      {
+        std::ofstream ofs(temp, std::ios::binary);
+        guard(ofs.is_open());
+        io::to_stream(solid_cache_version, ofs);
+        io::to_stream(key,                 ofs);
+        io::to_stream(*entry,              ofs);
+      }
+      fs::rename(temp, path, ec);
+      if (ec) {
+        fs::remove(temp, ec);
+        return;
+      }
+
+      // Gather existing entries, and evict oldest first
+      struct File { fs::path path; fs::file_time_type time; size_t size; };
+      std::vector<File> files;
+      size_t total = 0;
+      for (const auto &de : fs::directory_iterator(dir, ec)) {
+        guard_continue(de.is_regular_file(ec) && de.path().extension() == ".solid");
+        File f = { de.path(), de.last_write_time(ec), de.file_size(ec) };
+        guard_continue(!ec);
+        total += f.size;
+        files.push_back(std::move(f));
+      }
+      rng::sort(files, {}, &File::time);
+      for (const auto &f : files) {
+        guard_break(total > max_bytes);
+        guard_continue(fs::remove(f.path, ec));
+        total -= f.size;
+      }
+    }
+  } // namespace detail
+
+  ColorSolidCache &ColorSolidCache::instance() {
+    static ColorSolidCache cache;
+    return cache;
+  }
+
+  void ColorSolidCache::set_info(CreateInfo &&info) {
+    met_trace();
+    std::lock_guard lock(m_mutex);
+    m_info = std::move(info);
+    while (m_lru.size() > m_info.max_entries) {
+      m_map.erase(m_lru.back().first);
+      m_lru.pop_back();
+    }
+  }
+
+  void ColorSolidCache::clear() {
+    met_trace();
+    std::lock_guard lock(m_mutex);
+    m_lru.clear();
+    m_map.clear();
+  }
+
+  ColorSolidCache::entry_type ColorSolidCache::load_memory(size_t key) {
+    auto it = m_map.find(key);
+    guard(it != m_map.end(), nullptr);
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    return it->second->second;
+  }
+
+  void ColorSolidCache::store_memory(size_t key, entry_type entry) {
+    guard(m_info.max_entries > 0);
+    if (auto it = m_map.find(key); it != m_map.end()) {
+      it->second->second = std::move(entry);
+      m_lru.splice(m_lru.begin(), m_lru, it->second);
+      return;
+    }
+    m_lru.emplace_front(key, std::move(entry));
+    m_map[key] = m_lru.begin();
+    if (m_lru.size() > m_info.max_entries) {
+      m_map.erase(m_lru.back().first);
+      m_lru.pop_back();
+    }
+  }
+
+  ColorSolidCache::entry_type ColorSolidCache::solve(const ColorSolidInfo &info) {
+    met_trace();
+
+    // Check in-memory tier first; the lock is not held during disk access or solves, 
+    // so concurrent misses on one key may solve twice, which is harmless
+    size_t     key = detail::solid_cache_key(info);
+    CreateInfo cache_info;
+    {
+      std::lock_guard lock(m_mutex);
+      if (auto entry = load_memory(key))
+        return entry;
+      cache_info = m_info;
+    }
+
+    // Check on-disk tier next
+    if (auto entry = detail::load_solid_disk(cache_info.cache_dir, key)) {
+      std::lock_guard lock(m_mutex);
+      store_memory(key, entry);
+      return entry;
+    }
+
+    // Generate samples and their convex hull, and store in both tiers
+    ColorSolidCache::Entry data = { .samples = solve_color_solid(info) };
+    auto colrs = data.samples | vws::transform(&MismatchSample::colr) | view_to<std::vector<Colr>>();
+    data.hull  = generate_convex_hull<Mesh, Colr>(colrs);
+    auto entry = std::make_shared<const Entry>(std::move(data));
+    {
+      std::lock_guard lock(m_mutex);
+      store_memory(key, entry);
+    }
+    detail::store_solid_disk(cache_info.cache_dir, cache_info.max_disk_bytes, key, entry);
+    return entry;
+  }
+} // namespace met
\ No newline at end of file
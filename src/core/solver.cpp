@@ -16,102 +16,102 @@
 #include <metameric/core/solver.hpp>
 #include <metameric/core/ranges.hpp>
 #include <metameric/core/spectrum.hpp>
+#include <cmath>
+#include <deque>
 #include <exception>
 
 namespace nlopt {
   using namespace met;
 
+  namespace detail {
+    // Nr. of objective evaluations of this thread's most recent optimization
+    thread_local uint last_evals = 0;
+
+    OptCache &acquire_opt(algorithm algo, uint n) {
+      met_trace();
+
+      // Per-thread pool; deque keeps references stable as the pool grows
+      thread_local std::deque<OptCache> pool;
+
+      // Find or instantiate optimization object for this algorithm and dimension
+      auto it = rng::find_if(pool, [&](const OptCache &cache) { return cache.algo == algo && cache.n == n; });
+      if (it == pool.end())
+        it = pool.insert(pool.end(), { .algo = algo, .n = n, .desc = opt(algo, n) });
+
+      // Clear state of a prior solve; setting the objective later on corrects stopval's 
+      // default for maximization problems
+      auto &desc = it->desc;
+      desc.remove_equality_constraints();
+      desc.remove_inequality_constraints();
+      desc.set_upper_bounds(HUGE_VAL);
+      desc.set_lower_bounds(-HUGE_VAL);
+      desc.set_xtol_rel(0.0);
+      desc.set_maxtime(0.0);
+      desc.set_maxeval(0);
+      desc.set_stopval(-HUGE_VAL);
+
+      return *it;
+    }
+
+    nlopt::result optimize(OptCache &cache) {
+      met_trace_n("optimize");
+
+      nlopt::result code = nlopt::result::FAILURE;
+      double o;
+      try {
+        code = cache.desc.optimize(cache.x, o);
+      } catch (const nlopt::roundoff_limited &e) {
+        // ... fails silently for now
+      } catch (const nlopt::forced_stop &e) {
+        // ... fails silently for now
+      } catch (const std::exception &e) {
+        fmt::print("{}\n", e.what());
+      }
+      last_evals = static_cast<uint>(cache.desc.get_numevals());
+      return code;
+    }
+  } // namespace detail
+
+  uint last_solve_evals() {
+    return detail::last_evals;
+  }
+
   template <uint N>
   Result<N> solve(Wrapper<N> &info) {
     met_trace();
 
-    // Commonly used types from info object
-    using vec = Wrapper<N>::vec;
-    using mat = Wrapper<N>::mat;
-    
-    // Define function wrapper to encapsulate pointers in mapped eigen vectors, then to pass
-    // these to a constraint or objective function capture
-    constexpr auto func_wrapper = [](uint n, const double *x, double *g, void *data) -> double {
-      // Dereference passed pointer to capture, and forward data in mapped Eigen objects
-      // Only pass on gradient if present, not all algorithms require or provide gradient
-      auto x_ = eig::Map<const vec>(x);
-      auto g_ = g 
-              ? eig::Map<vec>(g) 
-              : eig::Map<vec>(nullptr, 0);
-      return static_cast<Wrapper<N>::Constraint::Capture *>(data)->operator()(x_, g_);
-    };
-
-    // Define function wrapper to encapsulate pointers in mapped eigen vectors, then to pass
-    // these to a vector constraint function capture
-    constexpr auto func_wrapper_v = [](uint m, double *r, uint n, const double *x, double *g, void *data) -> void {
-      // Dereference passed pointer to capture, and forward data in mapped Eigen objects
-      // Only pass on gradient if present, not all algorithms require or provide gradient
-      auto r_ = eig::Map<eig::VectorXd>(r, m);
-      auto x_ = eig::Map<const vec>(x);
-      auto g_ = eig::Map<mat>(g ? g : nullptr, N, m);
-      return static_cast<Wrapper<N>::ConstraintV::Capture *>(data)->operator()(r_, x_, g_);
-    };
-
-    // Optimization object descriptor
-    opt desc(info.algo, N);
+    // Commonly used types from info object; the dynamic wrapper forwards 
+    // to the same trampolines as TypedWrapper, over type-erased captures
+    using Capture  = Wrapper<N>::Constraint::Capture;
+    using CaptureV = Wrapper<N>::ConstraintV::Capture;
+
+    auto &cache = detail::acquire_opt(info.algo, N);
+    auto &desc  = cache.desc;
 
     // Specify objective function
     if (info.dirc == direction::eMinimize) {
-      desc.set_min_objective(func_wrapper, &info.objective);
+      desc.set_min_objective(detail::func_trampoline<N, Capture>, &info.objective);
     } else {
-      desc.set_max_objective(func_wrapper, &info.objective);
+      desc.set_max_objective(detail::func_trampoline<N, Capture>, &info.objective);
     }
     
     // Add equality/inequality constraints
     for (auto &cstr : info.eq_constraints)
-      desc.add_equality_constraint(func_wrapper, &cstr.f, cstr.tol);
+      desc.add_equality_constraint(detail::func_trampoline<N, Capture>, &cstr.f, cstr.tol);
     for (auto &cstr : info.nq_constraints)
-      desc.add_inequality_constraint(func_wrapper, &cstr.f, cstr.tol);
+      desc.add_inequality_constraint(detail::func_trampoline<N, Capture>, &cstr.f, cstr.tol);
     for (auto &cstr : info.eq_constraints_v)
-      desc.add_equality_mconstraint(func_wrapper_v, &cstr.f, std::vector<double>(cstr.n, cstr.tol));
+      desc.add_equality_mconstraint(detail::func_trampoline_v<N, CaptureV>, &cstr.f, std::vector<double>(cstr.n, cstr.tol));
     for (auto &cstr : info.nq_constraints_v)
-      desc.add_inequality_mconstraint(func_wrapper_v, &cstr.f, std::vector<double>(cstr.n, cstr.tol));
-
-    // Specify optional upper/lower bounds
-    if (auto v = info.upper)
-      desc.set_upper_bounds(std::vector<double>(v->data(), v->data() + N));
-    if (auto v = info.lower)
-      desc.set_lower_bounds(std::vector<double>(v->data(), v->data() + N));
-
-    // Specify optional stopping criteria and tolerances
-    if (info.rel_xpar_tol) desc.set_xtol_rel(*info.rel_xpar_tol);
-    if (info.max_time)     desc.set_maxtime(*info.max_time);
-    if (info.max_iters)    desc.set_maxeval(*info.max_iters);
-    if (info.stopval)      desc.set_stopval(*info.stopval);
-
-    // Return value
-    Result<N> result;
-
-    { // optimize
-      met_trace_n("optimize");
-
-      // Placeholder for 'x' because the library enforces std::vector :S
-      std::vector<double> x(range_iter(info.x_init));
-      double o;
-
-      try {
-        result.second = desc.optimize(x, o);
-      } catch (const nlopt::roundoff_limited &e) {
-        // ... fails silently for now
-      } catch (const nlopt::forced_stop &e) {
-        // ... fails silently for now
-      } catch (const std::exception &e) {
-        fmt::print("{}\n", e.what());
-      }
-
-      // Copy over potential solution to return value
-      rng::copy(x, result.first.begin());
-    } // optimize
+      desc.add_inequality_mconstraint(detail::func_trampoline_v<N, CaptureV>, &cstr.f, std::vector<double>(cstr.n, cstr.tol));
 
-    return result;
+    return detail::optimize<N>(cache, info);
   }
 
   // explicit instantiation for some numbers
   template Result<wavelength_bases>   solve<wavelength_bases>(Wrapper<wavelength_bases> &); 
   template Result<wavelength_samples> solve<wavelength_samples>(Wrapper<wavelength_samples> &); 
-} // namespace nlopt
+#if MET_PREVIEW_WAVELENGTH_BASES != MET_WAVELENGTH_BASES && MET_PREVIEW_WAVELENGTH_BASES != MET_WAVELENGTH_SAMPLES
+  template Result<preview_wavelength_bases> solve<preview_wavelength_bases>(Wrapper<preview_wavelength_bases> &); 
+#endif
+} // namespace nlopt
\ No newline at end of file
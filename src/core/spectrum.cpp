@@ -87,66 +87,128 @@ namespace met {
     return v;
   }
 
-  CMFS ColrSystem::finalize(bool as_rgb) const {
+  namespace detail {
+    // Return finalize() of a color system; the last result is cached per thread, as 
+    // consecutive calls typically apply one color system to many spectra
+    template <uint Samples>
+    const CMFSBase<Samples> &finalize_cached(const ColrSystemBase<Samples> &csys, bool as_rgb) {
+      thread_local bool              cache_is_valid = false;
+      thread_local bool              cache_as_rgb   = false;
+      thread_local SpecBase<Samples> cache_illuminant;
+      thread_local CMFSBase<Samples> cache_cmfs, cache_finalized;
+      if (!cache_is_valid 
+       || cache_as_rgb != as_rgb 
+       || cache_cmfs   != csys.cmfs 
+       || (cache_illuminant != csys.illuminant).any()) {
+        cache_is_valid   = true;
+        cache_as_rgb     = as_rgb;
+        cache_cmfs       = csys.cmfs;
+        cache_illuminant = csys.illuminant;
+        cache_finalized  = csys.finalize(as_rgb);
+      }
+      return cache_finalized;
+    }
+
+    // Compute out = A * in over blocks of columns in parallel, s.t. each block's
+    // product stays in cache; optionally, post-process each block in place
+    template <typename Mat, typename In, typename Out, typename Post = std::nullptr_t>
+    void apply_blocked(const Mat &A, const In &in, Out &out, Post post = nullptr) {
+      met_trace();
+      using Scalar = typename Mat::Scalar;
+      using InMap  = eig::Map<const eig::Matrix<Scalar, Mat::ColsAtCompileTime, eig::Dynamic>, 0, eig::OuterStride<>>;
+      using OutMap = eig::Map<eig::Matrix<Scalar, Mat::RowsAtCompileTime, eig::Dynamic>, 0, eig::OuterStride<>>;
+      debug::check_expr(in.rows() == A.cols() && out.rows() == A.rows() && in.cols() == out.cols(),
+                        "Batched apply has mismatched dimensions");
+
+      // Fixed-size rows and a coefficient-based product avoid GEMM packing for these thin products
+      constexpr eig::Index block_size = 4096;
+      int n_blocks = static_cast<int>(ceil_div(in.cols(), block_size));
+      #pragma omp parallel for if (n_blocks > 1)
+      for (int i = 0; i < n_blocks; ++i) {
+        eig::Index first = i * block_size,
+                   n     = std::min(block_size, in.cols() - first);
+        InMap  in_block(in.col(first).data(), A.cols(), n, eig::OuterStride<>(in.outerStride()));
+        OutMap block(out.col(first).data(), A.rows(), n, eig::OuterStride<>(out.outerStride()));
+        block.noalias() = A.lazyProduct(in_block);
+        if constexpr (!std::is_null_pointer_v<Post>)
+          post(block);
+      }
+    }
+  } // namespace detail
+
+  template <uint Samples>
+  CMFSBase<Samples> ColrSystemBase<Samples>::finalize(bool as_rgb) const {
     met_trace();
-    CMFS csys = (cmfs.array().colwise() * illuminant)
+    cmfs_type csys = (cmfs.array().colwise() * illuminant)
               / (cmfs.array().col(1)    * illuminant).sum();
     if (as_rgb)
       csys = (models::xyz_to_srgb_transform * csys.transpose()).transpose().eval();
     return csys;
   }
   
-  Colr ColrSystem::apply(const Spec &s, bool as_rgb) const { 
+  template <uint Samples>
+  Colr ColrSystemBase<Samples>::apply(const spec_type &s, bool as_rgb) const { 
     met_trace();
-    return finalize(as_rgb).transpose() * s.matrix().eval();
+    return detail::finalize_cached(*this, as_rgb).transpose() * s.matrix().eval();
   }
   
-  std::vector<Colr> ColrSystem::apply(std::span<const Spec> sd, bool as_rgb) const { 
+  template <uint Samples>
+  std::vector<Colr> ColrSystemBase<Samples>::apply(std::span<const spec_type> sd, bool as_rgb) const { 
     met_trace();
+    std::vector<Colr> out(sd.size());
+    guard(!sd.empty(), out);
     
-    // Gather color system data into matrix
-    auto csys = finalize(as_rgb);
+    // Map contiguous spectra and colors onto matrix columns
+    eig::Map<const eig::MatrixXf> sd_map(sd.data()->data(), Samples, sd.size());
+    eig::Map<eig::MatrixXf>       out_map(out.data()->data(), 3, out.size());
+    apply(sd_map, out_map, as_rgb);
+    return out;
+  }
 
-    // Transform to non-unique colors
-    std::vector<Colr> out(sd.size());
-    std::transform(std::execution::par_unseq, range_iter(sd), out.begin(),
-      [&csys](const auto &s) -> Colr { return (csys.transpose() * s.matrix()).eval(); });
+  template <uint Samples>
+  void ColrSystemBase<Samples>::apply(eig::Ref<const eig::MatrixXf> sd, eig::Ref<eig::MatrixXf> out, bool as_rgb) const {
+    met_trace();
+    detail::apply_blocked(detail::finalize_cached(*this, as_rgb).transpose(), sd, out);
+  }
 
-    // Collapse return value to unique colors
-    std::unordered_set<
-      Colr, 
-      decltype(Eigen::detail::matrix_hash<float>), 
-      decltype(Eigen::detail::matrix_equal)
-    > out_unique(range_iter(out));
-    return std::vector<Colr>(range_iter(out_unique));
+  template <uint Samples>
+  void ColrSystemBase<Samples>::apply(eig::Ref<const eig::MatrixXd> sd, eig::Ref<eig::MatrixXd> out, bool as_rgb) const {
+    met_trace();
+    auto csys = detail::finalize_cached(*this, as_rgb).transpose().template cast<double>().eval();
+    detail::apply_blocked(csys, sd, out);
   }
 
-  bool ColrSystem::operator==(const ColrSystem &o) const { 
+  template <uint Samples>
+  bool ColrSystemBase<Samples>::operator==(const ColrSystemBase &o) const { 
     return cmfs.isApprox(o.cmfs) && illuminant.isApprox(o.illuminant);
   }
 
-  void ColrSystem::to_stream(std::ostream &str) const {
+  template <uint Samples>
+  void ColrSystemBase<Samples>::to_stream(std::ostream &str) const {
     met_trace();
     io::to_stream(cmfs,       str);
     io::to_stream(illuminant, str);
   }
 
-  void ColrSystem::from_stream(std::istream &str) {
+  template <uint Samples>
+  void ColrSystemBase<Samples>::from_stream(std::istream &str) {
     met_trace();
     io::from_stream(cmfs,       str);
     io::from_stream(illuminant, str);
   }
   
-  std::vector<CMFS> IndirectColrSystem::finalize(bool as_rgb) const {
+  template <uint Samples>
+  std::vector<CMFSBase<Samples>> IndirectColrSystemBase<Samples>::finalize(bool as_rgb) const {
     met_trace();
-    CMFS csys = cmfs.array() / cmfs.col(1).sum();
+    cmfs_type csys = cmfs.array() / cmfs.col(1).sum();
     if (as_rgb)
       csys = (models::xyz_to_srgb_transform * csys.matrix().transpose()).transpose();
-    return powers | vws::transform([&csys](const Spec &pwr) { 
-      return (csys.array().colwise() * pwr).eval(); }) | view_to<std::vector<CMFS>>();
+    return powers | vws::transform([&csys](const spec_type &pwr) { 
+      return (csys.array().colwise() * pwr).matrix().eval(); }) | view_to<std::vector<cmfs_type>>();
   }
 
-  Colr IndirectColrSystem::apply(const Spec &s, bool as_rgb) const {
+  template <uint Samples>
+  Colr IndirectColrSystemBase<Samples>::apply(const spec_type &s, bool as_rgb) const {
     met_trace();
     Colr c = 0.f;
     auto csys = finalize(as_rgb);
@@ -155,13 +217,14 @@ namespace met {
     return c;
   }
 
-  std::vector<Colr> IndirectColrSystem::apply(std::span<const Spec> sd, bool as_rgb) const {
+  template <uint Samples>
+  std::vector<Colr> IndirectColrSystemBase<Samples>::apply(std::span<const spec_type> sd, bool as_rgb) const {
     met_trace();
 
     // Gather color system data into matrices
     auto csys = finalize(as_rgb);
     
-    // Transform to non-unique colors
+    // Transform to colors, in order
     std::vector<Colr> out(sd.size());
     std::transform(std::execution::par_unseq, range_iter(sd), out.begin(),
     [&csys](const auto &s) -> Colr { 
@@ -170,58 +233,124 @@ namespace met {
         c += (csys.transpose() * s.pow(static_cast<float>(i)).matrix()).array().eval();
       return c;
     });
+    return out;
+  }
 
-    // Collapse return value to unique colors
+  std::vector<Colr> unique_colors(std::span<const Colr> colrs) {
+    met_trace();
     std::unordered_set<
       Colr, 
       decltype(Eigen::detail::matrix_hash<float>), 
       decltype(Eigen::detail::matrix_equal)
-    > out_unique(range_iter(out));
+    > out_unique(range_iter(colrs));
     return std::vector<Colr>(range_iter(out_unique));
   }
 
-  bool IndirectColrSystem::operator==(const IndirectColrSystem &o) const {
-    return cmfs.isApprox(o.cmfs) && rng::equal(powers, o.powers, eig::safe_approx_compare<Spec>);
+  template <uint Samples>
+  bool IndirectColrSystemBase<Samples>::operator==(const IndirectColrSystemBase &o) const {
+    return cmfs.isApprox(o.cmfs) && rng::equal(powers, o.powers, eig::safe_approx_compare<spec_type>);
   }
 
-  void IndirectColrSystem::to_stream(std::ostream &str) const {
+  template <uint Samples>
+  void IndirectColrSystemBase<Samples>::to_stream(std::ostream &str) const {
     met_trace();
     io::to_stream(cmfs,   str);
     io::to_stream(powers, str);
   }
 
-  void IndirectColrSystem::from_stream(std::istream &str) {
+  template <uint Samples>
+  void IndirectColrSystemBase<Samples>::from_stream(std::istream &str) {
     met_trace();
     io::from_stream(cmfs,   str);
     io::from_stream(powers, str);
   }
   
-  bool Basis::operator==(const Basis &o) const {
+  template <uint Samples, uint Bases>
+  bool BasisBase<Samples, Bases>::operator==(const BasisBase &o) const {
     return scale == o.scale
            && mean.isApprox(o.mean)
            && func.isApprox(o.func);
   }
 
-  void Basis::to_stream(std::ostream &str) const {
+  template <uint Samples, uint Bases>
+  void BasisBase<Samples, Bases>::to_stream(std::ostream &str) const {
     met_trace();
     io::to_stream(mean, str);
     io::to_stream(scale, str);
     io::to_stream(func, str);
   }
 
-  void Basis::from_stream(std::istream &str) {
+  template <uint Samples, uint Bases>
+  void BasisBase<Samples, Bases>::from_stream(std::istream &str) {
     met_trace();
     io::from_stream(mean,  str);
     io::from_stream(scale, str);
     io::from_stream(func,  str);
   }
   
-  std::vector<Spec> Basis::apply(std::span<const Basis::vec_type> cs) const { 
+  template <uint Samples, uint Bases>
+  std::vector<SpecBase<Samples>> BasisBase<Samples, Bases>::apply(std::span<const vec_type> cs) const { 
     met_trace();
+    std::vector<spec_type> out(cs.size());
+    guard(!cs.empty(), out);
     
-    std::vector<Spec> out(cs.size());
-    std::transform(std::execution::par_unseq, range_iter(cs), out.begin(), 
-      [&](const auto &c) { return apply(c); });
+    // Map contiguous coefficients and spectra onto matrix columns
+    eig::Map<const eig::MatrixXf> cs_map(cs.data()->data(), Bases, cs.size());
+    eig::Map<eig::MatrixXf>       out_map(out.data()->data(), Samples, out.size());
+    apply(cs_map, out_map);
     return out;
   }
-} // namespace met
+
+  template <uint Samples, uint Bases>
+  void BasisBase<Samples, Bases>::apply(eig::Ref<const eig::MatrixXf> cs, eig::Ref<eig::MatrixXf> out) const {
+    met_trace();
+    detail::apply_blocked(func, cs, out, [](auto &&block) { 
+      block = block.cwiseMax(0.f).cwiseMin(1.f); });
+  }
+
+  template <uint Samples, uint Bases>
+  void BasisBase<Samples, Bases>::apply(eig::Ref<const eig::MatrixXd> cs, eig::Ref<eig::MatrixXd> out) const {
+    met_trace();
+    detail::apply_blocked(func.template cast<double>().eval(), cs, out, [](auto &&block) { 
+      block = block.cwiseMax(0.0).cwiseMin(1.0); });
+  }
+
+  template <uint Samples, uint Bases, uint SamplesIn, uint BasesIn>
+  BasisBase<Samples, Bases> resample_basis(const BasisBase<SamplesIn, BasesIn> &basis) {
+    met_trace();
+    static_assert(Bases <= BasesIn, "Resampled basis cannot exceed the input's nr. of bases");
+
+    // Resample basis functions; then, if bases are dropped, keep the dominant directions of
+    // their column space, which reduces to truncation for an already orthogonal basis
+    eig::Matrix<float, Samples, BasesIn> func = detail::resample_matrix<Samples, SamplesIn>() * basis.func;
+    BasisBase<Samples, Bases> out = { .mean  = resample_spectrum<Samples>(basis.mean), 
+                                      .scale = basis.scale };
+    if constexpr (Bases == BasesIn) {
+      out.func = func;
+    } else {
+      eig::JacobiSVD<eig::MatrixXf> svd(func, eig::ComputeThinV);
+      out.func = func * svd.matrixV().leftCols(Bases);
+    }
+    return out;
+  }
+
+  /* Explicit template instantiations */
+
+  #define declare_spectral_samples(Samples)                                                           \
+    template struct ColrSystemBase<Samples>;                                                          \
+    template struct IndirectColrSystemBase<Samples>;
+
+  #define declare_spectral_layout(Samples, Bases)                                                     \
+    template struct BasisBase<Samples, Bases>;                                                        \
+    template                                                                                          \
+    BasisBase<Samples, Bases> resample_basis<Samples, Bases>(const Basis &);
+
+  declare_spectral_samples(wavelength_samples)
+  declare_spectral_layout(wavelength_samples, wavelength_bases)
+#if MET_PREVIEW_WAVELENGTH_SAMPLES != MET_WAVELENGTH_SAMPLES
+  declare_spectral_samples(preview_wavelength_samples)
+#endif
+#if MET_PREVIEW_WAVELENGTH_SAMPLES != MET_WAVELENGTH_SAMPLES || MET_PREVIEW_WAVELENGTH_BASES != MET_WAVELENGTH_BASES
+  declare_spectral_layout(preview_wavelength_samples, preview_wavelength_bases)
+#endif
+} // namespace met
\ No newline at end of file
@@ -0,0 +1,98 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <metameric/core/worker.hpp>
+#include <algorithm>
+#include <exception>
+
+namespace met {
+  WorkerPool::WorkerPool(uint n_threads)
+  : m_queue(std::make_unique<Queue>()) {
+    met_trace();
+
+    if (n_threads == 0)
+      n_threads = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    
+    // Each thread waits for a job or a stop request; queued jobs are dropped on stop
+    m_threads.reserve(n_threads);
+    for (uint i = 0; i < n_threads; ++i) {
+      m_threads.emplace_back([queue = m_queue.get()](std::stop_token stop) {
+        while (true) {
+          Job job;
+          {
+            std::unique_lock lock(queue->mutex);
+            guard(queue->cv.wait(lock, stop, [queue] { return !queue->jobs.empty(); }) && !stop.stop_requested());
+            job = std::move(queue->jobs.front());
+            queue->jobs.pop_front();
+          }
+
+          // An exception escaping a jthread terminates the program; e.g. debug::check_expr
+          // throws on release builds, so failing jobs are reported and dropped instead
+          try {
+            job();
+          } catch (const std::exception &e) {
+            fmt::print(stderr, "{}\n", e.what());
+          }
+        }
+      });
+    }
+  }
+
+  WorkerPool::~WorkerPool() {
+    stop();
+  }
+
+  WorkerPool::WorkerPool(WorkerPool &&o)
+  : m_queue(std::move(o.m_queue)),
+    m_threads(std::move(o.m_threads)) { }
+
+  WorkerPool &WorkerPool::operator=(WorkerPool &&o) {
+    met_trace();
+    guard(this != &o, *this);
+
+    // Own workers must be joined before their queue is released
+    stop();
+    m_queue   = std::move(o.m_queue);
+    m_threads = std::move(o.m_threads);
+    return *this;
+  }
+
+  void WorkerPool::stop() {
+    met_trace();
+    
+    // Signal all threads first, so they wind down concurrently, then join; a running 
+    // job is finished, but queued jobs are never started
+    for (auto &thread : m_threads)
+      thread.request_stop();
+    m_threads.clear();
+    m_queue.reset();
+  }
+
+  void WorkerPool::submit(Job &&job) {
+    met_trace();
+    debug::check_expr(m_queue != nullptr, "WorkerPool::submit() called on moved-from pool");
+    {
+      std::lock_guard lock(m_queue->mutex);
+      m_queue->jobs.push_back(std::move(job));
+    }
+    m_queue->cv.notify_one();
+  }
+
+  uint WorkerPool::n_queued() const {
+    guard(m_queue, 0u);
+    std::lock_guard lock(m_queue->mutex);
+    return static_cast<uint>(m_queue->jobs.size());
+  }
+} // namespace met
\ No newline at end of file
@@ -0,0 +1,1149 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <metameric/core/distribution.hpp>
+#include <metameric/core/ranges.hpp>
+#include <metameric/core/spectrum.hpp>
+#include <metameric/core/utility.hpp>
+#include <metameric/scene/detail/traversal.hpp>
+#include <metameric/render/cpu_render.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <numbers>
+#include <optional>
+#include <thread>
+
+namespace met {
+  namespace detail {
+    // Constants, following math.glsl
+    constexpr float cpu_flt_max = std::numeric_limits<float>::max();
+    constexpr float cpu_pi      = std::numbers::pi_v<float>;
+    constexpr float cpu_pi_inv  = std::numbers::inv_pi_v<float>;
+    constexpr float cpu_eps     = 5.9604645e-8f;
+    constexpr float cpu_ray_eps = 1e4f * cpu_eps;
+
+    // Indices of different lobe values, following render/brdf.glsl
+    enum Lobe : uint { 
+      eLobeSpecReflect = 0, 
+      eLobeSpecRefract = 1, 
+      eLobeDiffReflect = 2, 
+      eLobeCoatReflect = 3 
+    };
+
+    // Small math helpers, following math.glsl and render/frame.glsl
+    inline float         sdot(float f)                                  { return f * f;                         }
+    inline float         mulsign(float a, float b)                      { return b >= 0.f ? a : -a;             }
+    inline eig::Vector3f mulsign(const eig::Vector3f &a, float b)       { return b >= 0.f ? a : (-a).eval();    }
+    inline float         cos_theta(const eig::Vector3f &v)              { return v.z();                         }
+    inline float         abs_cos_theta(const eig::Vector3f &v)          { return std::abs(v.z());               }
+    inline bool          is_upper_hemisphere(const eig::Vector3f &v)    { return v.z() >= 0.f;                  }
+    inline eig::Vector3f to_upper_hemisphere(const eig::Vector3f &v)    { return mulsign(v, v.z());             }
+    inline eig::Vector3f local_reflect(const eig::Vector3f &wi)         { return { -wi.x(), -wi.y(), wi.z() };  }
+    inline float         mis_power(float pdf_a, float pdf_b)            { 
+      pdf_a *= pdf_a;
+      pdf_b *= pdf_b;
+      return pdf_a / (pdf_a + pdf_b); 
+    }
+    inline eig::Vector3f local_refract(const eig::Vector3f &wi, float cos_theta_t, float inv_eta) { 
+      return { -wi.x() * inv_eta, -wi.y() * inv_eta, cos_theta_t }; 
+    }
+
+    // Local shading frame; see get_frame() in render/frame.glsl
+    struct Frame {
+      eig::Vector3f n, s, t;
+
+    public:
+      Frame(const eig::Vector3f &n_)
+      : n(n_) {
+        s = std::abs(n.x() - mulsign(1.f, n.x())) <= cpu_eps
+          ? eig::Vector3f(0, n.x(), 0)
+          : n.cross(eig::Vector3f::UnitX()).normalized().eval();
+        t = n.cross(s).normalized();
+      }
+
+      eig::Vector3f to_local(const eig::Vector3f &v) const { return { v.dot(s), v.dot(t), v.dot(n) }; }
+      eig::Vector3f to_world(const eig::Vector3f &v) const { return s * v.x() + t * v.y() + n * v.z(); }
+    };
+
+    // Sample warps, following render/warp.glsl and render/sensor.glsl
+    eig::Vector2f square_to_unif_disk_concentric(eig::Vector2f sample_2d) {
+      sample_2d = (2.f * sample_2d.array() - 1.f).matrix();
+      
+      bool quad_1_or_3 = std::abs(sample_2d.x()) < std::abs(sample_2d.y());
+      float r  = quad_1_or_3 ? sample_2d.y() : sample_2d.x(),
+            rp = quad_1_or_3 ? sample_2d.x() : sample_2d.y();
+      
+      float phi = .25f * cpu_pi * rp / r;
+      if (quad_1_or_3)
+        phi = .5f * cpu_pi - phi;
+      if (sample_2d.isZero(0.f))
+        phi = 0.f;
+      
+      return { r * std::cos(phi), r * std::sin(phi) };
+    }
+
+    eig::Vector3f square_to_unif_hemisphere(const eig::Vector2f &sample_2d) {
+      eig::Vector2f p = square_to_unif_disk_concentric(sample_2d);
+      float z = 1.f - p.squaredNorm();
+      p *= std::sqrt(z + 1.f);
+      return { p.x(), p.y(), z };
+    }
+
+    eig::Vector3f square_to_cos_hemisphere(const eig::Vector2f &sample_2d) {
+      eig::Vector2f p = square_to_unif_disk_concentric(sample_2d);
+      return { p.x(), p.y(), std::sqrt(std::max(1.f - p.squaredNorm(), 0.f)) };
+    }
+
+    float square_to_cos_hemisphere_pdf(const eig::Vector3f &v) {
+      return cpu_pi_inv * v.z();
+    }
+
+    float square_to_unif_hemisphere_pdf() {
+      return 1.f / (2.f * cpu_pi);
+    }
+
+    eig::Vector2f sample_tent_filter(const eig::Vector2f &sample_2d) {
+      return sample_2d.unaryExpr([](float f) {
+        f *= 2.f;
+        return f < 1.f ? std::sqrt(f) - 1.f : 1.f - std::sqrt(2.f - f);
+      });
+    }
+
+    // GGX microfacet distribution, following render/ggx.glsl
+    float ggx_D(const eig::Vector3f &n, float alpha) {
+      float xyz = sdot(n.x() / alpha) + sdot(n.y() / alpha) + sdot(n.z());
+      float D   = 1.f / (cpu_pi * sdot(alpha) * sdot(xyz));
+      return cos_theta(n) > 1e-20f ? D : 0.f;
+    }
+
+    float ggx_smith_g1(const eig::Vector3f &wi, const eig::Vector3f &n, float alpha) {
+      float xyz = (sdot(alpha * wi.x()) + sdot(alpha * wi.y())) / sdot(wi.z());
+      float g1  = 2.f / (1.f + std::sqrt(1.f + xyz));
+      return wi.dot(n) * cos_theta(wi) <= 0.f ? 0.f : g1;
+    }
+
+    float pdf_ggx(eig::Vector3f wi, const eig::Vector3f &wh, float alpha) {
+      wi = to_upper_hemisphere(wi);
+      return ggx_D(wh, alpha) * ggx_smith_g1(wi, wh, alpha) * std::abs(wi.dot(wh)) / abs_cos_theta(wi);
+    }
+
+    float eval_ggx(eig::Vector3f wi, const eig::Vector3f &wh, eig::Vector3f wo, float alpha) {
+      wi = to_upper_hemisphere(wi);
+      wo = to_upper_hemisphere(wo);
+      return ggx_D(wh, alpha) * ggx_smith_g1(wi, wh, alpha) * ggx_smith_g1(wo, wh, alpha);
+    }
+
+    eig::Vector3f sample_ggx(eig::Vector3f wi, float alpha, const eig::Vector2f &sample_2d) {
+      wi = to_upper_hemisphere(wi);
+
+      // Warp wi to hemisphere, sample visible hemisphere, then warp back to ellipsoid
+      eig::Vector3f wi_p = eig::Vector3f(wi.x() * alpha, wi.y() * alpha, wi.z()).normalized();
+      float phi = 2.f * cpu_pi * sample_2d.x();
+      float z   = std::fma(1.f - sample_2d.y(), 1.f + wi_p.z(), -wi_p.z());
+      float sth = std::sqrt(std::clamp(1.f - z * z, 0.f, 1.f));
+      eig::Vector3f wh_p = eig::Vector3f(sth * std::cos(phi), sth * std::sin(phi), z) + wi_p;
+      eig::Vector3f wh   = eig::Vector3f(wh_p.x() * alpha, wh_p.y() * alpha, wh_p.z()).normalized();
+      
+      // reflect(-wi, wh) + wi
+      return (2.f * wh.dot(wi) * wh).normalized();
+    }
+
+    // Schlick's fresnel approximation, following render/fresnel.glsl
+    float schlick_F0(float eta_a, float eta_b) {
+      return sdot((eta_a - eta_b) / (eta_a + eta_b));
+    }
+
+    float schlick_fresnel(float F0, float cos_theta_i) {
+      float c1 = 1.f - cos_theta_i, c2 = c1 * c1, c5 = c2 * c2 * c1;
+      return std::clamp(F0 + (1.f - F0) * c5, 0.f, 1.f);
+    }
+
+    eig::Array4f schlick_fresnel(const eig::Array4f &F0, float cos_theta_i) {
+      float c1 = 1.f - cos_theta_i, c2 = c1 * c1, c5 = c2 * c2 * c1;
+      return (F0 + (1.f - F0) * c5).cwiseMax(0.f).cwiseMin(1.f);
+    }
+
+    eig::Array4f schlick_fresnel(const eig::Array4f &F0, float cos_theta_i, float &cos_theta_t, float eta) {
+      float scale         = cos_theta_i > 0.f ? 1.f / eta : eta;
+      float cos_theta_t_2 = 1.f - (1.f - sdot(cos_theta_i)) * sdot(scale);
+
+      // Total internal reflection check before computing angle of transmission
+      if (cos_theta_t_2 <= 0.f) {
+        cos_theta_t = 0.f;
+        return 1.f;
+      }
+      cos_theta_t = mulsign(std::sqrt(cos_theta_t_2), -cos_theta_i);
+
+      return schlick_fresnel(F0, std::abs(cos_theta_i));
+    }
+
+    // Surface interaction, following render/interaction.glsl
+    struct Interaction {
+      eig::Vector3f p;      // Surface position in world space
+      eig::Vector2f tx;     // Surface texture coordinates
+      eig::Vector3f n;      // Surface shading normal, defines local frame
+      eig::Vector3f wi;     // Incident direction in local frame
+      float         t;      // Distance traveled along incident direction
+      SurfaceRecord record; // Object/emitter index, primitive index
+
+    public:
+      bool is_valid()   const { return record.is_valid();                       }
+      bool is_object()  const { return record.is_valid() && record.is_object();  }
+      bool is_emitter() const { return record.is_valid() && record.is_emitter(); }
+
+      eig::Vector3f to_local(const eig::Vector3f &v) const { return Frame(n).to_local(v); }
+      eig::Vector3f to_world(const eig::Vector3f &v) const { return Frame(n).to_world(v); }
+
+      // Offset above/below surface depending on the incidence of the ray direction
+      eig::Vector3f surface_offset(const eig::Vector3f &d) const {
+        return n.dot(d) >= 0.f ? (p + n * cpu_ray_eps).eval() : (p - n * cpu_ray_eps).eval();
+      }
+
+      RayRecord ray_towards_direction(const eig::Vector3f &d) const {
+        return { .o = surface_offset(d), .t = cpu_flt_max, .d = d, .record = SurfaceRecord::invalid() };
+      }
+
+      RayRecord ray_towards_point(const eig::Vector3f &q) const {
+        RayRecord ray = { .o = surface_offset(q - p), .record = SurfaceRecord::invalid() };
+        ray.d  = q - ray.o;
+        ray.t  = ray.d.norm();
+        ray.d /= ray.t;
+        ray.t *= (1.f - cpu_ray_eps * 10.f);
+        return ray;
+      }
+    };
+
+    // Sample objects, following render/sample.glsl
+    struct SensorSample {
+      RayRecord    ray;  // Sensor ray
+      eig::Array4f wvls; // Packet of wavelengths along ray
+      eig::Array4f pdfs; // Packet of pdfs for each ray/wavelength pair
+    };
+
+    struct EmitterSample {
+      RayRecord ray;              // Ray towards sample position on surface of emitter
+      bool      is_delta = false; // Is the sample a dirac delta
+      float     pdf      = 0.f;   // Sample density
+    };
+
+    struct BRDFSample {
+      eig::Vector3f wo;                 // Exitant sampled direction, local space
+      float         eta         = 1.f;   // Relative index of refraction
+      float         pdf         = 0.f;   // Sampling density
+      bool          is_delta    = false; // Is the sample a dirac delta
+      bool          is_spectral = false; // Is the sample wavelength-dependent
+    };
+
+    // Unpacked brdf data; see render/detail/scene_types.glsl
+    struct BRDF {
+      eig::Array4f r;               // Albedo for 4 wavelengths
+      float        metallic;
+      float        alpha;
+      float        transmission;
+      float        absorption;
+      float        clearcoat;
+      float        clearcoat_alpha;
+      float        eta;             // Index of refraction for the hero wavelength
+      bool         is_spectral;     // Is the BRDF wavelength-dependent?
+    };
+
+    // Flattened view over the scene data used during rendering; gathered once per render() call.
+    // Spectra of untextured albedos and emitters are uplifted up front, taking the place of
+    // the gpu-side coefficient atlases; textured values are uplifted per hit instead
+    struct SceneView {
+      struct ObjectView {
+        const Object       *object;
+        const Mesh         *mesh;
+        const BVH<8>       *bvh;
+        eig::Matrix4f       trf, trf_inv; // Object * mesh transform, and its inverse
+        std::optional<Spec> albedo;       // Uplifted reflectance, unless the albedo is textured
+      };
+      
+      struct EmitterView {
+        const Emitter      *emitter;
+        eig::Matrix4f       trf, trf_inv;
+        std::optional<Spec> spec;         // Scaled emission, unless the emitter color is textured
+      };
+
+    public:
+      const Scene             &scene;
+      std::vector<ObjectView>  objects;
+      std::vector<EmitterView> emitters;
+      std::optional<uint>      envmap_i;
+      const Distribution      &emitter_distr;
+      Distribution             wavelength_distr;
+      CMFS                     cmfs;
+      uint                     max_depth;
+      uint                     rr_depth;
+    };
+
+    // Uplift a color to a spectrum through the uplifting's tessellation; this is the 
+    // per-texel operation of bake_object_coef.comp, minus the basis projection
+    Spec uplift_spectrum(const Scene &scene, uint uplifting_i, const Colr &c) {
+      const auto &uplifting_data = scene.components.upliftings.gl.uplifting_data[uplifting_i];
+      auto [bary, tetr_i] = uplifting_data.find_enclosing_tetrahedron(c.matrix());
+      Spec s = 0.f;
+      for (auto [i, elem_i] : enumerate_view(uplifting_data.tessellation.elems[tetr_i]))
+        s += bary[i] * uplifting_data.boundary_and_interior[elem_i].spec;
+      return s;
+    }
+
+    // Uplift an emitter's color to a spectrum; colors exceeding 1 are scaled down first,
+    // and the scale is reapplied afterwards, following bake_emitter_coef.comp
+    Spec uplift_emitter_spectrum(const Scene &scene, Colr c) {
+      float scale = c.maxCoeff() > 1.f ? c.maxCoeff() : 1.f;
+      return uplift_spectrum(scene, 0, c / scale) * scale;
+    }
+
+    // Sample a scene texture at given coordinates, applying an object's uv overrides
+    eig::Array4f sample_texture(const Scene &scene, const Object &object, uint image_i, const eig::Vector2f &tx) {
+      eig::Array2f uv = object.uv_offset + tx.array() * object.uv_extent;
+      return scene.resources.images[image_i]->sample(uv, Image::ColorFormat::eLRGB);
+    }
+
+    SceneView make_scene_view(const Scene &scene, const CPUPathRendererInfo &info) {
+      met_trace();
+
+      const auto &objects  = scene.components.objects;
+      const auto &emitters = scene.components.emitters;
+
+      SceneView view = { 
+        .scene         = scene, 
+        .emitter_distr = emitters.gl.emitter_distr,
+        .max_depth     = info.max_depth,
+        .rr_depth      = info.rr_depth
+      };
+
+      // Gather object data; untextured albedo is uplifted once
+      view.objects.resize(objects.size());
+      #pragma omp parallel for
+      for (int i = 0; i < objects.size(); ++i) {
+        const auto &object    = *objects[i];
+        const auto &mesh_data = scene.resources.meshes.gl.mesh_cache[object.mesh_i];
+        auto &object_view = view.objects[i];
+        object_view = { 
+          .object  = &object, 
+          .mesh    = &mesh_data.mesh, 
+          .bvh     = &mesh_data.bvh,
+          .trf     = (object.transform.affine().matrix() * mesh_data.unit_trf).eval()
+        };
+        object_view.trf_inv = object_view.trf.inverse().eval();
+        if (auto c = std::get_if<Colr>(&object.albedo))
+          object_view.albedo = uplift_spectrum(scene, object.uplifting_i, *c);
+      }
+
+      // Gather emitter data; illuminants and untextured colors are resolved once
+      view.emitters.resize(emitters.size());
+      for (uint i = 0; i < emitters.size(); ++i) {
+        const auto &emitter = *emitters[i];
+        auto &emitter_view = view.emitters[i];
+        emitter_view = {
+          .emitter = &emitter,
+          .trf     = emitter.transform.affine().matrix()
+        };
+        emitter_view.trf_inv = emitter_view.trf.inverse().eval();
+        if (emitter.spec_type == Emitter::SpectrumType::eIllm)
+          emitter_view.spec = scene.resources.illuminants[emitter.illuminant_i].value() * emitter.illuminant_scale;
+        else if (auto c = std::get_if<Colr>(&emitter.color))
+          emitter_view.spec = uplift_emitter_spectrum(scene, *c) * emitter.illuminant_scale;
+
+        // Store first active constant emitter as envmap; see SceneGLHandler<Emitter>
+        if (!view.envmap_i && emitter.is_active && emitter.type == Emitter::Type::eEnviron)
+          view.envmap_i = i;
+      }
+
+      // Generate sampling distribution for wavelengths; see IntegrationRenderPrimitive::reset()
+      {
+        CMFS observer = scene.primary_observer();
+        Spec distr    = 1.f;
+        if (rng::any_of(emitters, [](const auto &comp) { return comp.value.is_active; })) {
+          distr = 0.f;
+          for (const auto &comp : emitters) {
+            guard_continue(comp.value.is_active);
+            distr += scene.resources.illuminants[comp.value.illuminant_i].value() * comp.value.illuminant_scale;
+          }
+        }
+        distr /= distr.maxCoeff();
+        distr *= observer.array().rowwise().sum();
+        distr += (Spec(1) - distr) * 0.01f;
+        view.wavelength_distr = Distribution(cnt_span<const float>(distr));
+      }
+
+      // Integrate with the first observer, as the gpu-side film does; see SceneGLHandler<CMFS>
+      view.cmfs = ColrSystem { .cmfs = *scene.resources.observers[0], .illuminant = Spec(1) }.finalize();
+
+      return view;
+    }
+
+    // Ray/shape intersections, following render/shape/sphere.glsl and render/shape/rectangle.glsl
+    bool ray_intersect_sphere(const RayRecord &ray, float &t, const eig::Vector3f &center, float r) {
+      eig::Vector3f o = ray.o - center;
+      float b = 2.f * o.dot(ray.d);
+      float c = o.squaredNorm() - sdot(r);
+      float d = b * b - 4.f * c;
+      guard(d >= 0.f, false);
+
+      d = std::sqrt(d);
+      float t_near = (-b + d) * .5f, t_far = (-b - d) * .5f;
+      if (t_near < 0.f)
+        t_near = cpu_flt_max;
+      if (t_far < 0.f)
+        t_far = cpu_flt_max;
+      
+      t = std::min(t_near, t_far);
+      return t <= ray.t && t >= 0.f;
+    }
+
+    bool ray_intersect_rectangle(const RayRecord &ray, float &t, const eig::Matrix4f &trf) {
+      eig::Vector3f p = trf.col(3).head<3>(), 
+                    u = trf.col(0).head<3>(), 
+                    v = trf.col(1).head<3>(),
+                    n = trf.col(2).head<3>().normalized();
+      
+      // Plane distance test
+      t = (p.dot(n) - ray.o.dot(n)) / ray.d.dot(n);
+      guard(t >= 0.f && t <= ray.t, false);
+
+      // Plane boundary test
+      eig::Vector2f wh   = { u.norm(), v.norm() };
+      eig::Vector3f q    = ray.o + ray.d * t - p;
+      eig::Vector2f proj = { (u / wh.x()).dot(q), (v / wh.y()).dot(q) };
+      return (proj.array().abs() <= .5f * wh.array()).all();
+    }
+
+    bool ray_intersect_emitter(const SceneView &view, const RayRecord &ray, float &t, uint emitter_i) {
+      const auto &em = view.emitters[emitter_i];
+      guard(em.emitter->is_active, false);
+      switch (em.emitter->type) {
+        case Emitter::Type::eSphere: 
+          return ray_intersect_sphere(ray, t, em.trf.col(3).head<3>(), .5f * em.trf.col(0).head<3>().norm());
+        case Emitter::Type::eRect:
+          return ray_intersect_rectangle(ray, t, em.trf);
+        default:
+          return false;
+      }
+    }
+
+    // Transform a world-space ray to an object's local mesh space; as the direction 
+    // is not renormalized, distances along the ray remain the same
+    RayRecord ray_to_object(const SceneView::ObjectView &ob, const RayRecord &ray, uint object_i) {
+      return { .o      = (ob.trf_inv * ray.o.homogeneous()).head<3>(),
+               .t      = ray.t,
+               .d      = ob.trf_inv.topLeftCorner<3, 3>() * ray.d,
+               .record = { .data = SurfaceRecord::record_object_flag | (object_i << 24) } };
+    }
+
+    // Closest-hit query over all objects and emitters, following render/scene.glsl
+    bool scene_intersect(const SceneView &view, RayRecord &ray) {
+      for (uint i = 0; i < view.objects.size(); ++i) {
+        const auto &ob = view.objects[i];
+        guard_continue(ob.object->is_active);
+        RayRecord local = ray_to_object(ob, ray, i);
+        guard_continue(ray_intersect(local, *ob.bvh, *ob.mesh));
+        ray.t      = local.t;
+        ray.record = local.record;
+      }
+      for (uint i = 0; i < view.emitters.size(); ++i) {
+        float t;
+        guard_continue(ray_intersect_emitter(view, ray, t, i));
+        ray.t           = t;
+        ray.record.data = SurfaceRecord::record_emitter_flag | (i << 24);
+      }
+      return ray.record.is_valid();
+    }
+
+    // Any-hit query over all objects and emitters, following render/scene.glsl
+    bool scene_intersect_any(const SceneView &view, const RayRecord &ray) {
+      for (uint i = 0; i < view.objects.size(); ++i) {
+        const auto &ob = view.objects[i];
+        guard_continue(ob.object->is_active);
+        if (ray_intersect_any(ray_to_object(ob, ray, i), *ob.bvh, *ob.mesh))
+          return true;
+      }
+      for (uint i = 0; i < view.emitters.size(); ++i) {
+        float t;
+        if (ray_intersect_emitter(view, ray, t, i))
+          return true;
+      }
+      return false;
+    }
+
+    // Spherical texture coordinates for sphere/point/constant emitters
+    eig::Vector2f emitter_spherical_tx(const eig::Vector3f &n) {
+      eig::Vector2f tx = { std::atan2(n.x(), -n.z()) * .5f, std::acos(std::clamp(n.y(), -1.f, 1.f)) };
+      return (tx * cpu_pi_inv).unaryExpr([](float f) { return std::fmod(f + 1.f, 1.f); });
+    }
+
+    // Fill interaction data from a ray hit, following render/detail/interaction.glsl
+    Interaction get_interaction(const SceneView &view, const RayRecord &ray) {
+      Interaction si = { .record = ray.record };
+
+      // On a miss, fall back to the envmap if one is present
+      if (!si.record.is_valid()) {
+        guard(view.envmap_i, si);
+        si.record.data = SurfaceRecord::record_emitter_flag | (*view.envmap_i << 24);
+      }
+      
+      if (si.record.is_object()) {
+        const auto &ob   = view.objects[si.record.object_i()];
+        const auto &mesh = *ob.mesh;
+        const auto &elem = mesh.elems[si.record.primitive_i()];
+
+        // Gather primitive vertex data, forcing uvs to [0, 1]
+        std::array<eig::Vector3f, 3> p, n;
+        std::array<eig::Vector2f, 3> tx;
+        for (uint i = 0; i < 3; ++i) {
+          p[i]  = mesh.verts[elem[i]];
+          n[i]  = mesh.has_norms() ? mesh.norms[elem[i]].matrix().eval() : eig::Vector3f(0, 0, 1);
+          tx[i] = mesh.has_txuvs() ? mesh.txuvs[elem[i]].matrix().eval() : eig::Vector2f(.5f, .5f);
+          tx[i] = tx[i].unaryExpr([](float f) {
+            int   i = static_cast<int>(f);
+            float a = f - static_cast<float>(i);
+            return (i % 2) ? 1.f - a : a;
+          });
+        }
+
+        // Reinterpolate surface position, texture coordinates, shading normal using barycentrics
+        eig::Vector3f pl = (ob.trf_inv * (ray.o + ray.t * ray.d).homogeneous()).head<3>();
+        eig::Vector3f ab = p[1] - p[0], ac = p[2] - p[0];
+        float a_tri = .5f * ac.cross(ab).norm();
+        eig::Vector3f b = eig::Vector3f(.5f * (p[2] - pl).cross(p[1] - pl).norm(),
+                                        .5f * ac.cross(pl - p[0]).norm(),
+                                        .5f * (pl - p[0]).cross(ab).norm()) / a_tri;
+        si.p  = b.x() * p[0]  + b.y() * p[1]  + b.z() * p[2];
+        si.n  = b.x() * n[0]  + b.y() * n[1]  + b.z() * n[2];
+        si.tx = b.x() * tx[0] + b.y() * tx[1] + b.z() * tx[2];
+
+        // Transform relevant data to world-space
+        si.p = (ob.trf * si.p.homogeneous()).head<3>();
+        si.n = (ob.trf.topLeftCorner<3, 3>() * si.n).normalized();
+      } else {
+        const auto &em = view.emitters[si.record.emitter_i()];
+        si.p = ray.o + ray.d * ray.t;
+        switch (em.emitter->type) {
+          case Emitter::Type::eSphere:
+            si.n  = (si.p - em.trf.col(3).head<3>()).normalized();
+            si.tx = emitter_spherical_tx(si.n);
+            break;
+          case Emitter::Type::eRect:
+            si.n  = em.trf.col(2).head<3>().normalized();
+            si.tx = (em.trf_inv * si.p.homogeneous()).head<2>().array() + .5f;
+            break;
+          default:
+            si.n  = ray.d;
+            si.tx = emitter_spherical_tx(si.n);
+            break;
+        }
+      }
+
+      // Store incident ray data
+      si.wi = si.to_local(-ray.d);
+      si.t  = ray.t;
+      
+      return si;
+    }
+
+    // Emitter evaluation and sampling, following render/emitter.glsl
+    eig::Array4f eval_emitter(const SceneView &view, const Interaction &si, const eig::Array4f &wvls) {
+      guard(si.is_emitter(), 0.f);
+      const auto &em = view.emitters[si.record.emitter_i()];
+
+      // If normal is not inclined along the ray, return nothing
+      bool is_area = em.emitter->type == Emitter::Type::eSphere || em.emitter->type == Emitter::Type::eRect;
+      guard(!is_area || cos_theta(si.wi) > 0.f, 0.f);
+      
+      // Sample either pre-resolved spectral data, or uplift texture data
+      eig::Array4f L;
+      if (em.spec) {
+        L = sample_spectrum(wvls, *em.spec);
+      } else {
+        Colr c = view.scene.resources.images[std::get<uint>(em.emitter->color)]->sample(si.tx, Image::ColorFormat::eLRGB).head<3>();
+        L = sample_spectrum(wvls, uplift_emitter_spectrum(view.scene, c)) * em.emitter->illuminant_scale;
+      }
+
+      return em.emitter->type == Emitter::Type::ePoint ? (L / sdot(si.t)).eval() : L;
+    }
+
+    float pdf_emitter(const SceneView &view, const Interaction &si) {
+      guard(si.is_emitter(), 0.f);
+      const auto &em = view.emitters[si.record.emitter_i()];
+      
+      float pdf = view.emitter_distr.pdf_discrete(si.record.emitter_i());
+      switch (em.emitter->type) {
+        case Emitter::Type::eSphere:
+          return pdf * 2.f * cpu_pi_inv * sdot(si.t) / (em.trf.col(0).head<3>().squaredNorm() * cos_theta(si.wi));
+        case Emitter::Type::eRect:
+          return pdf * sdot(si.t) / (em.trf.col(0).norm() * em.trf.col(1).norm() * cos_theta(si.wi));
+        case Emitter::Type::eEnviron:
+          return pdf * square_to_unif_hemisphere_pdf();
+        default:
+          return 0.f;
+      }
+    }
+
+    EmitterSample sample_emitter(const SceneView &view, const Interaction &si, const eig::Vector3f &sample_3d) {
+      guard(view.emitter_distr.size() > 0 && view.emitter_distr.sum() > 0.f, { });
+      
+      // Sample specific emitter from distribution
+      uint  emitter_i = view.emitter_distr.sample_discrete(sample_3d.z());
+      float emitter_p = view.emitter_distr.pdf_discrete(emitter_i);
+      guard(emitter_i < view.emitters.size(), { });
+      const auto &em = view.emitters[emitter_i];
+      guard(em.emitter->is_active, { });
+
+      // Sample specific position on emitter
+      EmitterSample es;
+      eig::Vector2f sample_2d = sample_3d.head<2>();
+      switch (em.emitter->type) {
+        case Emitter::Type::eSphere: {
+          // Sample position on hemisphere facing surface, point may not be nearest
+          eig::Vector3f c = em.trf.col(3).head<3>();
+          eig::Vector3f p = c + (.5f * em.trf.col(0).head<3>().norm()) 
+                          * Frame((si.p - c).normalized()).to_world(square_to_unif_hemisphere(sample_2d));
+          es.ray = si.ray_towards_point(p);
+          
+          // Set pdf to zero if we are approaching from a back-face
+          float dp = (-es.ray.d).dot((p - c).normalized());
+          guard(dp >= 0.f, { });
+          es.pdf = 2.f * cpu_pi_inv * sdot(es.ray.t) / (em.trf.col(0).head<3>().squaredNorm() * dp);
+          break;
+        }
+        case Emitter::Type::eRect: {
+          // Sample position on rectangle, with (0, 0) at its center
+          eig::Vector3f p = (em.trf * eig::Vector4f(sample_2d.x() - .5f, sample_2d.y() - .5f, 0.f, 1.f)).head<3>();
+          es.ray = si.ray_towards_point(p);
+
+          // Set pdf to zero if we approach a backface
+          float dp = (-es.ray.d).dot(em.trf.col(2).head<3>().normalized());
+          guard(dp >= 0.f, { });
+          es.pdf = sdot(es.ray.t) / (em.trf.col(0).norm() * em.trf.col(1).norm() * dp);
+          break;
+        }
+        case Emitter::Type::ePoint:
+          es.ray      = si.ray_towards_point(em.trf.col(3).head<3>());
+          es.pdf      = 1.f;
+          es.is_delta = true;
+          break;
+        case Emitter::Type::eEnviron:
+          es.ray = si.ray_towards_direction(si.to_world(square_to_unif_hemisphere(sample_2d)));
+          es.pdf = square_to_unif_hemisphere_pdf();
+          break;
+      }
+
+      // Multiply sample pdfs, and store emitter index in ray record
+      es.pdf *= emitter_p;
+      es.ray.record.data = SurfaceRecord::record_emitter_flag | (emitter_i << 24);
+      
+      return es;
+    }
+
+    // BRDF construction, evaluation and sampling, following render/brdf.glsl
+    BRDF get_brdf(const SceneView &view, Interaction &si, const eig::Array4f &wvls) {
+      const auto &ob     = view.objects[si.record.object_i()];
+      const auto &object = *ob.object;
+
+      // Helper to sample scalar material data or textures
+      auto sample_1f = [&](const std::variant<float, uint> &v) {
+        return v | visit {
+          [&](float f) { return f; },
+          [&](uint  i) { return sample_texture(view.scene, object, i, si.tx).x(); }
+        };
+      };
+      
+      BRDF brdf = {
+        .metallic        = sample_1f(object.metallic),
+        .alpha           = std::max(1e-3f, std::pow(sample_1f(object.alpha), 3.f)),
+        .transmission    = sample_1f(object.transmission),
+        .absorption      = object.absorption * 10.f,
+        .clearcoat       = object.clearcoat,
+        .clearcoat_alpha = std::max(1e-3f, std::pow(object.clearcoat_alpha, 3.f))
+      };
+
+      // Uplift reflectance; untextured albedo was uplifted beforehand
+      if (ob.albedo) {
+        brdf.r = sample_spectrum(wvls, *ob.albedo);
+      } else {
+        Colr c = sample_texture(view.scene, object, std::get<uint>(object.albedo), si.tx).head<3>();
+        brdf.r = sample_spectrum(wvls, uplift_spectrum(view.scene, object.uplifting_i, c));
+      }
+
+      // Compute cauchy coefficients b and c, then compute actual wavelength-dependent eta
+      auto [eta_min, eta_max] = std::pair { object.eta_minmax.x(), object.eta_minmax.y() };
+      if (eta_max > eta_min) {
+        float lambda_min_2 = sdot(wavelength_min), lambda_max_2 = sdot(wavelength_max);
+        float cauchy_b = (lambda_min_2 * eta_max - lambda_max_2 * eta_min) / (lambda_min_2 - lambda_max_2);
+        float cauchy_c = lambda_min_2 * (eta_max - cauchy_b);
+        brdf.eta         = cauchy_b + cauchy_c / sdot(wavelength_min + wvls.x() * wavelength_range);
+        brdf.is_spectral = true;
+      } else {
+        brdf.eta         = eta_min;
+        brdf.is_spectral = false;
+      }
+
+      // Adjust the local shading frame through the normalmap, if one is present
+      if (object.normalmap) {
+        eig::Vector3f n  = sample_texture(view.scene, object, *object.normalmap, si.tx).head<3>().matrix().normalized();
+        eig::Vector3f wi = si.to_world(si.wi);
+        si.n  = si.to_world(n);
+        si.wi = si.to_local(wi);
+      }
+
+      return brdf;
+    }
+
+    eig::Array4f detail_get_lobe_pdf(const BRDF &brdf, const Interaction &si, const eig::Array4f &F) {
+      eig::Array4f v;
+
+      // Average used for metals, same as F for dielectrics
+      float F_avg = F.sum() * .25f;
+      
+      if (is_upper_hemisphere(si.wi)) {
+        // From upper; we skip computation of coat fresnel and simply use 1/2 of scaling
+        v[eLobeSpecReflect] = F_avg * (1.f - brdf.metallic) + brdf.metallic;
+        v[eLobeSpecRefract] = (1.f - F_avg) * (1.f - brdf.metallic) * brdf.transmission;
+        v[eLobeDiffReflect] = (1.f - F_avg) * (1.f - brdf.metallic) * (1.f - brdf.transmission);
+        v[eLobeCoatReflect] = .5f * brdf.clearcoat;
+      } else {
+        // From lower, we don't apply transmission twice, metallic doesn't even get here, nor does coat
+        v[eLobeSpecReflect] = F_avg;
+        v[eLobeSpecRefract] = 1.f - F_avg;
+        v[eLobeDiffReflect] = 0.f;
+        v[eLobeCoatReflect] = 0.f;
+      }
+
+      return v / v.sum();
+    }
+
+    eig::Array4f eval_brdf(const BRDF &brdf, const Interaction &si, const eig::Vector3f &wo) {
+      bool is_upper     = is_upper_hemisphere(si.wi);
+      bool is_reflected = cos_theta(si.wi) * cos_theta(wo) >= 0.f;
+
+      // Get relative index of refraction along ray
+      float eta     = is_upper ? brdf.eta : 1.f / brdf.eta;
+      float inv_eta = is_upper ? 1.f / brdf.eta : brdf.eta;
+
+      // Get the half-vector in the positive hemisphere direction
+      eig::Vector3f m = to_upper_hemisphere((si.wi + wo * (is_reflected ? 1.f : eta)).normalized());
+
+      // Evaluate fresnel, microfacet distribution
+      eig::Array4f F0 = eig::Array4f(schlick_F0(1.f, brdf.eta)) * (1.f - brdf.metallic) + brdf.r * brdf.metallic;
+      eig::Array4f F  = schlick_fresnel(F0, to_upper_hemisphere(si.wi).dot(m));
+      float        GD = eval_ggx(si.wi, m, wo, brdf.alpha);
+
+      eig::Array4f f = 0.f;
+
+      // Coat component
+      float coat = 0.f;
+      if (is_upper && is_reflected && brdf.clearcoat > 0.f) {
+        float F_coat  = schlick_fresnel(schlick_F0(1.f, 1.5f), cos_theta(to_upper_hemisphere(si.wi)));
+        float GD_coat = eval_ggx(si.wi, m, wo, brdf.clearcoat_alpha);
+        float weight  = 1.f / (4.f * cos_theta(si.wi) * cos_theta(wo));
+        coat = F_coat * brdf.clearcoat;
+        f += coat * GD_coat * weight;
+      }
+
+      // Diffuse component; lambert scaled by metallic
+      if (is_upper && is_reflected)
+        f += (1.f - coat) * (1.f - F) * (1.f - brdf.metallic) * (1.f - brdf.transmission) * brdf.r * cpu_pi_inv;
+
+      // Specular reflect; evaluate ggx and multiply by fresnel, jacobian
+      if (is_reflected) {
+        float weight = 1.f / (4.f * cos_theta(si.wi) * cos_theta(wo));
+        f += (1.f - coat) * F * GD * std::abs(weight);
+      }
+
+      // Specular refract; evaluate ggx and multiply by fresnel, jacobian
+      if (!is_reflected) {
+        // Apply Beer's law on exit
+        eig::Array4f r = is_upper ? eig::Array4f(1.f) : (brdf.r * std::exp(-si.t * brdf.absorption)).eval();
+        float weight = sdot(inv_eta) * si.wi.dot(m) * wo.dot(m)
+                     / std::abs(sdot(wo.dot(m) + si.wi.dot(m) * inv_eta) * cos_theta(si.wi) * cos_theta(wo));
+        f += (1.f - coat) * (1.f - F) * (1.f - brdf.metallic) * brdf.transmission * r * GD * std::abs(weight);
+      }
+
+      return f;
+    }
+
+    float pdf_brdf(const BRDF &brdf, const Interaction &si, const eig::Vector3f &wo) {
+      bool is_upper     = is_upper_hemisphere(si.wi);
+      bool is_reflected = cos_theta(si.wi) * cos_theta(wo) >= 0.f;
+
+      // Get relative index of refraction for bsdf
+      float eta     = is_upper ? brdf.eta : 1.f / brdf.eta;
+      float inv_eta = is_upper ? 1.f / brdf.eta : brdf.eta;
+
+      // Get the half-vector in the positive hemisphere direction as acting normal
+      eig::Vector3f m = to_upper_hemisphere((si.wi + wo * (is_reflected ? 1.f : eta)).normalized());
+
+      // Evaluate fresnel, microfacet distribution
+      eig::Array4f F0 = eig::Array4f(schlick_F0(1.f, brdf.eta)) * (1.f - brdf.metallic) + brdf.r * brdf.metallic;
+      eig::Array4f F  = schlick_fresnel(F0, to_upper_hemisphere(si.wi).dot(m));
+      float        GD = pdf_ggx(si.wi, m, brdf.alpha);
+
+      // Compute lobe densities
+      eig::Array4f lobe_pdf = detail_get_lobe_pdf(brdf, si, F);
+
+      float pdf = 0.f;
+
+      // Diffuse lobe sample density
+      if (is_reflected && is_upper)
+        pdf += lobe_pdf[eLobeDiffReflect] * square_to_cos_hemisphere_pdf(wo);
+      
+      // Reflect lobe sample density
+      if (is_reflected)
+        pdf += lobe_pdf[eLobeSpecReflect] * GD * std::abs(1.f / (4.f * si.wi.dot(m)));
+
+      // Refract lobe sample density
+      if (!is_reflected) {
+        float weight = sdot(inv_eta) * wo.dot(m) / sdot(wo.dot(m) + si.wi.dot(m) * inv_eta);
+        pdf += lobe_pdf[eLobeSpecRefract] * GD * std::abs(weight);
+      }
+
+      // Coat sample density
+      if (is_reflected && is_upper) {
+        float weight  = 1.f / (4.f * cos_theta(si.wi));
+        float GD_coat = pdf_ggx(si.wi, m, brdf.clearcoat_alpha);
+        pdf += lobe_pdf[eLobeCoatReflect] * GD_coat * std::abs(weight);
+      }
+
+      return pdf;
+    }
+
+    BRDFSample sample_brdf(const BRDF &brdf, const eig::Vector3f &sample_3d, const Interaction &si) {
+      eig::Vector2f sample_2d = sample_3d.tail<2>();
+
+      // Sample a microfacet normal to operate on, and move into its frame
+      eig::Vector3f m = sample_ggx(si.wi, brdf.alpha, sample_2d);
+      Frame local_fr(m);
+      eig::Vector3f local_wi = local_fr.to_local(si.wi);
+
+      // Get relative index of refraction
+      float inv_eta = is_upper_hemisphere(si.wi) ? 1.f / brdf.eta : brdf.eta;
+
+      // Compute fresnel and angle of transmission; F is set to 1 on total internal reflection
+      float cos_theta_t;
+      eig::Array4f F0 = eig::Array4f(schlick_F0(1.f, brdf.eta)) * (1.f - brdf.metallic) + brdf.r * brdf.metallic;
+      eig::Array4f F  = schlick_fresnel(F0, si.wi.dot(m), cos_theta_t, brdf.eta);
+
+      // Compute lobe densities as a cdf
+      eig::Array4f lobe_cdf = detail_get_lobe_pdf(brdf, si, F);
+      std::partial_sum(range_iter(lobe_cdf), lobe_cdf.begin());
+
+      BRDFSample bs;
+      if (sample_3d.x() < lobe_cdf[eLobeSpecReflect]) { // Sample 1st specular reflect lobe
+        bs.wo = local_fr.to_world(local_reflect(local_wi));
+        guard(cos_theta(bs.wo) * cos_theta(si.wi) > 0.f, { });
+      } else if (sample_3d.x() < lobe_cdf[eLobeSpecRefract]) { // Sample specular refract lobe
+        bs.wo          = local_fr.to_world(local_refract(local_wi, cos_theta_t, inv_eta));
+        bs.is_spectral = brdf.is_spectral;
+        bs.eta         = inv_eta;
+        guard(cos_theta(bs.wo) * cos_theta(si.wi) < 0.f, { });
+      } else if (sample_3d.x() < lobe_cdf[eLobeDiffReflect]) { // Sample diffuse lobe
+        bs.wo = square_to_cos_hemisphere(sample_2d);
+        guard(cos_theta(bs.wo) * cos_theta(si.wi) > 0.f, { });
+      } else if (sample_3d.x() < lobe_cdf[eLobeCoatReflect]) { // Sample 2nd specular reflect lobe for clearcoat
+        Frame coat_fr(sample_ggx(si.wi, brdf.clearcoat_alpha, sample_2d));
+        bs.wo = coat_fr.to_world(local_reflect(coat_fr.to_local(si.wi)));
+        guard(cos_theta(bs.wo) * cos_theta(si.wi) > 0.f, { });
+      }
+
+      bs.pdf = pdf_brdf(brdf, si, bs.wo);
+      return bs;
+    }
+
+    // Generate a sensor sample for a film pixel, following sample_sensor(FilmSensor) in render/sensor.glsl
+    SensorSample sample_sensor(const SceneView &view, const Sensor &sensor, const eig::Array2u &px, uint sample_i, const eig::Vector3f &sample_3d) {
+      SensorSample ss;
+
+      // Stratify into n_bins^2 subpixels
+      constexpr uint n_bins = 2;
+      eig::Vector2f bin      = { static_cast<float>(sample_i % n_bins), static_cast<float>((sample_i / n_bins) % n_bins) };
+      eig::Vector2f p_center = (bin.array() + .5f) / static_cast<float>(n_bins);
+      
+      // Get necessary sensor information
+      float tan_y  = 1.f / sensor.proj_trf(1, 1);
+      float aspect = static_cast<float>(sensor.film_size.x()) / static_cast<float>(sensor.film_size.y());
+      eig::Matrix4f view_inv = sensor.view_trf.inverse();
+      eig::Vector2f film_size = sensor.film_size.cast<float>();
+      
+      eig::Vector3f o, d;
+      if (sensor.focus_distance > 0.f) {
+        // Generate sample point on the aperture
+        eig::Vector2f p_sample = square_to_unif_disk_concentric(sample_3d.head<2>()) 
+                               * sensor.aperture_radius / static_cast<float>(n_bins * n_bins);
+
+        // Transform to [-1, 1] on film and compute focal point
+        p_center = ((px.cast<float>() + p_center.array()) / film_size.array() * 2.f - 1.f).matrix();
+        eig::Vector3f focal_point = eig::Vector3f(p_center.x() * tan_y * aspect, p_center.y() * tan_y, -1.f) 
+                                  * sensor.focus_distance;
+        
+        // Generate ray on focal plane towards focal point
+        o = { p_sample.x(), p_sample.y(), 0.f };
+        d = (focal_point - o).normalized();
+      } else {
+        // Generate sample offset, add to center, then transform to [-1, 1] on film
+        eig::Vector2f p = p_center + sample_tent_filter(sample_3d.head<2>());
+        p = ((px.cast<float>() + p.array()) / film_size.array() * 2.f - 1.f).matrix();
+        
+        // Generate ray at origin towards point at infinity
+        o = eig::Vector3f::Zero();
+        d = { p.x() * tan_y * aspect, p.y() * tan_y, -1.f };
+      }
+      
+      // Transform to world space
+      ss.ray = { .o      = (view_inv * o.homogeneous()).head<3>(),
+                 .t      = cpu_flt_max,
+                 .d      = (view_inv.topLeftCorner<3, 3>() * d).normalized(),
+                 .record = SurfaceRecord::invalid() };
+
+      // Sample wavelengths; stratified sample through inverse cdf
+      for (uint i = 0; i < 4; ++i) {
+        float u = std::fmod(sample_3d.z() + static_cast<float>(i) / 4.f, 1.f);
+        ss.wvls[i] = view.wavelength_distr.sample(u);
+        ss.pdfs[i] = view.wavelength_distr.pdf(ss.wvls[i]);
+      }
+
+      return ss;
+    }
+
+    // Estimate incident radiance along a sensor ray; follows Li() in render/path.glsl
+    eig::Array4f Li(const SceneView &view, SensorSample ss, UniformSampler<PCGEngine> &sampler, float &alpha) {
+      auto next_1d = [&]() { return sampler.next_1d(); };
+      auto next_3d = [&]() { return sampler.next_nd<3>().matrix().eval(); };
+
+      // Path throughput information; we track 4 wavelengths simultaneously
+      eig::Array4f Li   = 0.f;          // Accumulated spectrum
+      eig::Array4f Beta = 1.f / ss.pdfs; // Path throughput over density
+      float        eta  = 1.f;          // Relative index of refraction of path
+
+      // Prior brdf sample data, default-initialized, kept for NEE and MIS
+      float prev_bs_pdf      = 1.f;
+      bool  prev_bs_is_delta = true;
+      bool  bs_is_spectral   = false;
+
+      alpha = 0.f;
+      for (uint depth = 0; /* ... */ ; ++depth) {
+        guard_break(view.max_depth == 0 || depth < view.max_depth);
+
+        // Ray-trace against scene first; output 0 alpha on initial ray miss
+        alpha = (scene_intersect(view, ss.ray) || depth > 0) ? 1.f : 0.f;
+
+        // Get info about the intersected surface or lack thereof
+        Interaction si = get_interaction(view, ss.ray);
+        guard_break(si.is_valid());
+
+        // If an emissive object or envmap is hit, add its contribution to the 
+        // current path, and then terminate
+        if (si.is_emitter()) {
+          float em_pdf = prev_bs_is_delta ? 0.f : pdf_emitter(view, si);
+          Li += Beta * eval_emitter(view, si, ss.wvls) * mis_power(prev_bs_pdf, em_pdf);
+          break;
+        }
+
+        // Construct the underlying BRDF at the intersected surface
+        BRDF brdf = get_brdf(view, si, ss.wvls);
+
+        // Emitter sampling
+        {
+          EmitterSample es = sample_emitter(view, si, next_3d());
+
+          // BRDF sample density for exitant direction in local frame
+          eig::Vector3f wo     = si.to_local(es.ray.d);
+          float         bs_pdf = es.pdf > 0.f ? pdf_brdf(brdf, si, wo) : 0.f;
+
+          // If the sample has throughput, test for occluder closer 
+          // than sample position and add contribution
+          if (es.pdf > 0.f && bs_pdf > 0.f && !scene_intersect_any(view, es.ray)) {
+            float mis_weight = es.is_delta ? 1.f : mis_power(es.pdf, bs_pdf);
+            Li += Beta
+                * eval_brdf(brdf, si, wo)
+                * eval_emitter(view, get_interaction(view, es.ray), ss.wvls)
+                * mis_weight
+                * abs_cos_theta(wo)
+                / es.pdf;
+          }
+        }
+
+        // BRDF sampling
+        {
+          BRDFSample bs = sample_brdf(brdf, next_3d(), si);
+
+          // Early exit on zero brdf density
+          guard_break(bs.pdf > 0.f);
+
+          // Update path throughput and index of refraction
+          Beta *= eval_brdf(brdf, si, bs.wo) * abs_cos_theta(bs.wo) / bs.pdf;
+          eta  *= bs.eta;
+
+          // Retain last brdf density for direct emitter MIS weight
+          prev_bs_pdf      = bs.pdf;
+          prev_bs_is_delta = bs.is_delta;
+
+          // Handle delta wavelength-dependence in the BRDF by terminating secondary wavelengths
+          if (!bs_is_spectral && bs.is_spectral) {
+            bs_is_spectral = true;
+            Beta *= eig::Array4f(4, 0, 0, 0);
+          }
+
+          // Generate the next ray to trace through the scene
+          ss.ray = si.ray_towards_direction(si.to_world(bs.wo));
+        }
+
+        // Russian Roulette
+        if (view.rr_depth != 0 && depth >= view.rr_depth) {
+          float decay = std::pow(2.f, -static_cast<float>(depth - view.rr_depth));
+          float q     = std::min(0.95f, decay * Beta.maxCoeff() * sdot(eta));
+          guard_break(next_1d() < q);
+          Beta /= q;
+        }
+      } // for (uint depth)
+
+      return Li;
+    }
+
+    // Per-thread queues of tile indices; a thread pops tiles from the front of its own 
+    // queue, and steals from the back of other threads' queues once it runs dry
+    class TileQueues {
+      struct Queue {
+        std::mutex       mutex;
+        std::deque<uint> tiles;
+      };
+
+      std::vector<Queue> m_queues;
+
+    public:
+      TileQueues(uint n_queues, uint n_tiles)
+      : m_queues(n_queues) {
+        // Deal out contiguous runs of tiles, s.t. each thread starts on a coherent region
+        for (uint i = 0; i < n_tiles; ++i)
+          m_queues[static_cast<size_t>(i) * n_queues / n_tiles].tiles.push_back(i);
+      }
+
+      std::optional<uint> pop(uint queue_i) {
+        for (uint j = 0; j < m_queues.size(); ++j) {
+          auto &queue = m_queues[(queue_i + j) % m_queues.size()];
+          std::lock_guard lock(queue.mutex);
+          guard_continue(!queue.tiles.empty());
+          uint tile_i;
+          if (j == 0) {
+            tile_i = queue.tiles.front();
+            queue.tiles.pop_front();
+          } else {
+            tile_i = queue.tiles.back();
+            queue.tiles.pop_back();
+          }
+          return tile_i;
+        }
+        return std::nullopt;
+      }
+    };
+  } // namespace detail
+
+  CPUPathRenderer::CPUPathRenderer(InfoType info)
+  : m_info(info) {
+    met_trace();
+    m_info.spp_max      = std::max(m_info.spp_max, 1u);
+    m_info.spp_per_iter = std::clamp(m_info.spp_per_iter, 1u, m_info.spp_max);
+    m_info.tile_size    = std::max(m_info.tile_size, 1u);
+  }
+
+  Image CPUPathRenderer::render(const Sensor &sensor, const Scene &scene) {
+    met_trace_full();
+    debug::check_expr(scene.resources.meshes.gl.mesh_cache.size() == scene.resources.meshes.size()
+                   && scene.components.upliftings.gl.uplifting_data.size() == scene.components.upliftings.size(),
+                      "CPUPathRenderer: scene must be updated before rendering");
+
+    using clock = std::chrono::steady_clock;
+    auto time_end = clock::now() + std::chrono::duration_cast<clock::duration>(
+      std::chrono::duration<float>(m_info.time_budget));
+
+    // Gather render-ready scene data
+    detail::SceneView view = detail::make_scene_view(scene, m_info);
+
+    // Film and tile layout; film data is stored bottom-up, as in the gpu-side film
+    eig::Array2u film_size = sensor.film_size.max(1u);
+    eig::Array2u tile_ndiv = ceil_div(film_size, m_info.tile_size);
+    std::vector<eig::Array4f> film(film_size.prod(), eig::Array4f(0.f));
+    std::vector<uint>         tile_spp(tile_ndiv.prod(), 0);
+
+    // Render one tile for a range of sample indices, accumulating a running average per pixel
+    auto render_tile = [&](uint tile_i, uint spp_begin, uint spp_end) {
+      eig::Array2u tile_min = eig::Array2u(tile_i % tile_ndiv.x(), tile_i / tile_ndiv.x()) * m_info.tile_size;
+      eig::Array2u tile_max = (tile_min + m_info.tile_size).min(film_size);
+      for (uint y = tile_min.y(); y < tile_max.y(); ++y) {
+        for (uint x = tile_min.x(); x < tile_max.x(); ++x) {
+          auto &measure = film[y * film_size.x() + x];
+          for (uint i = spp_begin; i < spp_end; ++i) {
+            // Initial sample state is seeded from pixel index, and rotated by multiplication
+            UniformSampler<PCGEngine> sampler((1 + x + y * film_size.x()) * (1 + i));
+            
+            // Generate a sensor sample, then sample incident radiance along ray
+            auto ss = detail::sample_sensor(view, sensor, { x, y }, i, sampler.next_nd<3>().matrix());
+            float        alpha;
+            eig::Array4f L = detail::Li(view, ss, sampler, alpha);
+            if (!m_info.enable_alpha)
+              alpha = 1.f;
+            
+            // Brightness clamp, cheap hack for fireflies; also drops NaNs
+            L = L.isNaN().select(0.f, L).cwiseMax(0.f).cwiseMin(3200.f);
+
+            // Integrate over the color system, and add to the film in a running average
+            Colr c = integrate_cmfs(view.cmfs, ss.wvls, L) * .25f;
+            measure += (eig::Array4f(c.x(), c.y(), c.z(), alpha) - measure) / static_cast<float>(i + 1);
+          } // for (uint i)
+        } // for (uint x)
+      } // for (uint y)
+    };
+
+    // Render in iterations of spp_per_iter samples per pixel; each iteration distributes all
+    // tiles over threads, which check the time budget before picking up a new tile
+    uint n_threads = m_info.n_threads ? m_info.n_threads : std::max(std::thread::hardware_concurrency(), 1u);
+    std::atomic<bool> is_expired = false;
+    for (uint spp_curr = 0; spp_curr < m_info.spp_max && !is_expired; spp_curr += m_info.spp_per_iter) {
+      uint spp_next = std::min(spp_curr + m_info.spp_per_iter, m_info.spp_max);
+      detail::TileQueues queues(n_threads, tile_spp.size());
+
+      std::vector<std::jthread> threads;
+      for (uint thread_i = 0; thread_i < n_threads; ++thread_i) {
+        threads.emplace_back([&, thread_i]() {
+          while (auto tile_i = queues.pop(thread_i)) {
+            if (m_info.time_budget > 0.f && clock::now() > time_end) {
+              is_expired = true;
+              break;
+            }
+            render_tile(*tile_i, spp_curr, spp_next);
+            tile_spp[*tile_i] = spp_next;
+          }
+        });
+      }
+    } // for (uint spp_curr)
+
+    // Store sample count range for inspection
+    m_spp_min = rng::min(tile_spp);
+    m_spp_max = rng::max(tile_spp);
+
+    return Image({
+      .pixel_frmt = Image::PixelFormat::eRGBA,
+      .pixel_type = Image::PixelType::eFloat,
+      .color_frmt = Image::ColorFormat::eLRGB,
+      .size       = film_size,
+      .data       = cnt_span<const std::byte>(film)
+    });
+  }
+} // namespace met
\ No newline at end of file
@@ -19,8 +19,152 @@
 #include <metameric/scene/constraints.hpp>
 #include <nlohmann/json.hpp>
 #include <algorithm>
+#include <memory>
 
 namespace met {
+  namespace detail {
+    // Basis in the reduced spectral layout used by Settings::SolveLayout::ePreview
+    using PreviewBasis = BasisBase<preview_wavelength_samples, preview_wavelength_bases>;
+
+    // Helper; assemble info object for generating boundary spectra on the mismatch volume
+    // of a direct constraint, w.r.t. its last active constraint, the "free variable"; color
+    // systems are resampled to the layout of the given basis
+    template <uint Samples, uint Bases>
+    DirectMismatchSolidInfoBase<Samples, Bases> init_mismatch_info(const is_linear_constraint auto &cstr, 
+                                                                   const Scene                     &scene, 
+                                                                   const Uplifting                 &uplifting, 
+                                                                   const BasisBase<Samples, Bases> &basis,
+                                                                         uint                       seed    = 4, 
+                                                                         uint                       samples = 0) {
+      met_trace();
+
+      // Filter out inactive constraints
+      auto direct_cstr = cstr.cstr_j | vws::filter(&LinearConstraint::is_active) | view_to<std::vector<LinearConstraint>>();
+
+      // Assemble info object for generating boundary spectra
+      DirectMismatchSolidInfoBase<Samples, Bases> info = {
+        .basis     = basis,
+        .seed      = seed,
+        .n_samples = samples
+      };
+
+      // Base roundtrip objective
+      if (cstr.is_base_active)
+        info.linear_objectives.push_back(resample_csys<Samples>(scene.csys(uplifting)));
+
+      // Specify direct color systems forming objective
+      rng::transform(direct_cstr, 
+        std::back_inserter(info.linear_objectives),
+        [&](const auto &c) { return resample_csys<Samples>(scene.csys(c.cmfs_j, c.illm_j)); });
+
+      // Base roundtrip constraint
+      if (cstr.is_base_active)
+        info.linear_constraints.push_back({ resample_csys<Samples>(scene.csys(uplifting)), cstr.colr_i });
+
+      // Specify direct color constraints; all but the last constraint (the "free variable") are specified
+      rng::transform(direct_cstr | vws::take(direct_cstr.size() - 1), 
+        std::back_inserter(info.linear_constraints),
+        [&](const auto &c) { return std::pair { resample_csys<Samples>(scene.csys(c.cmfs_j, c.illm_j)), c.colr_j }; });
+
+      return info;
+    }
+
+    // Helper; assemble info object for generating boundary spectra on the mismatch volume
+    // of an indirect constraint, w.r.t. its last active constraint, the "free variable"; color
+    // systems are resampled to the layout of the given basis
+    template <uint Samples, uint Bases>
+    IndirectMismatchSolidInfoBase<Samples, Bases> init_mismatch_info(const IndirectSurfaceConstraint &cstr, 
+                                                                     const Scene                     &scene, 
+                                                                     const Uplifting                 &uplifting, 
+                                                                     const BasisBase<Samples, Bases> &basis,
+                                                                           uint                       seed    = 4, 
+                                                                           uint                       samples = 0) {
+      met_trace();
+
+      // Filter out inactive constraints
+      auto indrct_cstr = cstr.cstr_j | vws::filter(&NLinearConstraint::is_active) |  view_to<std::vector<NLinearConstraint>>();
+
+      // Assemble info object for generating boundary spectra
+      IndirectMismatchSolidInfoBase<Samples, Bases> info = {
+        .basis     = basis,
+        .seed      = seed,
+        .n_samples = samples
+      };
+
+      // Specify indirect color systems forming objective
+      info.nlinear_objectives.push_back(resample_csys<Samples>(IndirectColrSystem {
+        .cmfs   = scene.resources.observers[indrct_cstr.back().cmfs_j].value(),
+        .powers = indrct_cstr.back().powr_j
+      }));
+
+      // Base roundtrip constraint
+      if (cstr.is_base_active)
+        info.linear_constraints.push_back({ resample_csys<Samples>(scene.csys(uplifting)), cstr.colr_i });
+        
+      // Specify direct/indirect color constraints; all but the last constraint (the "free variable") are specified
+      rng::transform(indrct_cstr | vws::take(indrct_cstr.size() - 1), 
+        std::back_inserter(info.nlinear_constraints),
+        [&](const auto &c) { 
+          IndirectColrSystem csys = { scene.resources.observers[c.cmfs_j].value(), c.powr_j };
+          return std::pair { resample_csys<Samples>(csys), c.colr_j }; 
+        });
+
+      return info;
+    }
+
+    // Helper; return the objective generating output colors of a mismatch volume solve
+    template <uint Samples, uint Bases>
+    const auto &free_objective(const DirectMismatchSolidInfoBase<Samples, Bases> &info) {
+      return info.linear_objectives.back();
+    }
+    template <uint Samples, uint Bases>
+    const auto &free_objective(const IndirectMismatchSolidInfoBase<Samples, Bases> &info) {
+      return info.nlinear_objectives.back();
+    }
+
+    // Helper; assemble a deferred job for generating boundary spectra on the mismatch volume
+    // of a constraint through solve(info); the job owns a copy of the basis, as the info object 
+    // refers to it, and solves supporting it are stopped through the job's token. Under 
+    // Settings::SolveLayout::ePreview, the job solves in the preview layout, after which 
+    // spectra are refit in the full basis and colors are regenerated in full
+    MismatchJob init_mismatch_job(const auto      &cstr, 
+                                  const Scene     &scene, 
+                                  const Uplifting &uplifting, 
+                                        auto       solve,
+                                        uint       seed    = 4, 
+                                        uint       samples = 0) {
+      met_trace();
+      auto basis = std::make_shared<Basis>(scene.resources.bases[uplifting.basis_i].value());
+      auto info  = init_mismatch_info(cstr, scene, uplifting, *basis, seed, samples);
+      
+      if (scene.components.settings->solve_layout == Settings::SolveLayout::ePreview) {
+        auto preview_basis = std::make_shared<PreviewBasis>(
+          resample_basis<preview_wavelength_samples, preview_wavelength_bases>(*basis));
+        auto preview_info  = init_mismatch_info(cstr, scene, uplifting, *preview_basis, seed, samples);
+        return [basis, info, preview_basis, preview_info, solve](std::stop_token stop) {
+          auto job_info = preview_info;
+          if constexpr (requires { job_info.stop; })
+            job_info.stop = stop;
+          auto output = resample_mismatch_samples(solve(job_info), *preview_basis, *basis);
+          for (auto &sample : output)
+            sample.colr = free_objective(info)(sample.spec);
+          return output;
+        };
+      }
+
+      return [basis, info, solve](std::stop_token stop) {
+        auto job_info = info;
+        if constexpr (requires { job_info.stop; })
+          job_info.stop = stop;
+        return solve(job_info);
+      };
+    }
+
+    // Solver entry points handed to init_mismatch_job
+    constexpr auto mismatch_solve       = [](const auto &info) { return solve_mismatch_solid(info); };
+    constexpr auto mismatch_solve_exact = [](const auto &info) { return solve_mismatch_solid_exact(info); };
+  } // namespace detail
+
   bool LinearConstraint::operator==(const LinearConstraint &o) const {
     return is_active == o.is_active 
         && cmfs_j == o.cmfs_j 
@@ -226,139 +370,77 @@ namespace met {
     // Return zero constraint for black
     guard(!colr_i.isZero(), { Spec(0), Basis::vec_type(0) });
 
-    /* if (has_mismatching(scene, uplifting)) {
-      // NOTE; not implemented r.n. as gen_uplifting_task overrides this behavior with a nice, 
-      //       mismatch-volume based approximation. See MetamerConstraintBuilder
+    // We first fill in a default spectrum from the base roundtrip constraint, which is necessary 
+    // to establish the initial system, and warm-starts the indirect solve
+    auto basis = scene.resources.bases[uplifting.basis_i].value();
+    auto coef  = solve_spectrum_coef(DirectSpectrumInfo {
+      .linear_constraints = {{ scene.csys(uplifting), colr_i }},
+      .basis              = basis
+    });
 
-      auto basis = scene.resources.bases[uplifting.basis_i].value();
+    // Filter out inactive constraints; if none remain, the default spectrum is returned
+    auto indrct_cstr = cstr_j | vws::filter(&NLinearConstraint::is_active) | view_to<std::vector<NLinearConstraint>>();
+    guard(!indrct_cstr.empty(), { basis(coef), coef });
 
-      // Gather all relevant color system spectra and corresponding color signals
-      IndirectColrSystem csys = {
-        .cmfs   = scene.resources.observers[scene.components.observer_i.value].value(),
-        .powers = powers
-      };
-      IndirectSpectrumInfo spec_info = {
-        .linear_constraints   = {{ scene.csys(uplifting.csys_i), surface.diffuse }},
-        .nlinear_constraints = {{ csys, colr }},
-        .basis                = basis
-      };
-
-      // Generate a metamer satisfying the system+signal constraint set and return as pair
-      return solve_spectrum(spec_info);
-    } else { */ 
-      // We attempt to fill in a default spectrum, which is necessary to establish the initial system
-      // Gather all relevant color system spectra and corresponding color signals
-      
-      auto basis = scene.resources.bases[uplifting.basis_i].value();
-      DirectSpectrumInfo spec_info = {
-        .linear_constraints = {{ scene.csys(uplifting), colr_i }},
-        .basis              = basis
-      };
+    // Gather all relevant color system spectra and corresponding color signals
+    IndirectSpectrumInfo spec_info = { .basis = basis, .coef_init = coef };
+    if (is_base_active)
+      spec_info.linear_constraints.push_back({ scene.csys(uplifting), colr_i });
+    rng::transform(indrct_cstr, std::back_inserter(spec_info.nlinear_constraints), [&](const auto &c) { 
+      return std::pair { IndirectColrSystem { scene.resources.observers[c.cmfs_j].value(), c.powr_j }, c.colr_j }; 
+    });
 
-      // Generate a metamer satisfying the system+signal constraint set and return as pair
-      return solve_spectrum(spec_info);
-    // }
+    // Generate a metamer satisfying the system+signal constraint set and return as pair
+    return solve_spectrum(spec_info);
   }
 
   std::vector<MismatchSample> DirectColorConstraint::realize_mismatch(const Scene &scene, const Uplifting &uplifting, uint seed, uint samples) const {
     met_trace();
-    
-    // Filter out inactive constraints
-    auto direct_cstr = cstr_j | vws::filter(&LinearConstraint::is_active) | view_to<std::vector<LinearConstraint>>();
-
-    // Assemble info object for generating boundary spectra
-    DirectMismatchSolidInfo info = {
-      .basis     = scene.resources.bases[uplifting.basis_i].value(),
-      .seed      = seed,
-      .n_samples = samples
-    };
-
-    // Base roundtrip objective
-    if (is_base_active)
-      info.linear_objectives.push_back(scene.csys(uplifting));
-
-    // Specify direct color systems forming objective
-    rng::transform(direct_cstr, 
-      std::back_inserter(info.linear_objectives),
-      [&](const auto &c) { return scene.csys(c.cmfs_j, c.illm_j); });
+    return prepare_mismatch(scene, uplifting, seed, samples)(std::stop_token());
+  }
 
-    // Base roundtrip constraint
-    if (is_base_active)
-      info.linear_constraints.push_back({ scene.csys(uplifting), colr_i });
+  std::vector<MismatchSample> DirectColorConstraint::realize_mismatch_exact(const Scene &scene, const Uplifting &uplifting) const {
+    met_trace();
+    return prepare_mismatch_exact(scene, uplifting)(std::stop_token());
+  }
 
-    // Specify direct color constraints; all but the last constraint (the "free variable") are specified
-    rng::transform(direct_cstr | vws::take(direct_cstr.size() - 1), 
-      std::back_inserter(info.linear_constraints),
-      [&](const auto &c) { return std::pair { scene.csys(c.cmfs_j, c.illm_j), c.colr_j }; });
+  MismatchJob DirectColorConstraint::prepare_mismatch(const Scene &scene, const Uplifting &uplifting, uint seed, uint samples) const {
+    met_trace();
+    return detail::init_mismatch_job(*this, scene, uplifting, detail::mismatch_solve, seed, samples);
+  }
 
-    return solve_mismatch_solid(info);
+  MismatchJob DirectColorConstraint::prepare_mismatch_exact(const Scene &scene, const Uplifting &uplifting) const {
+    met_trace();
+    return detail::init_mismatch_job(*this, scene, uplifting, detail::mismatch_solve_exact);
   }
 
   std::vector<MismatchSample> DirectSurfaceConstraint::realize_mismatch(const Scene &scene, const Uplifting &uplifting, uint seed, uint samples) const {
     met_trace();
-    
-    // Filter out inactive constraints
-    auto direct_cstr = cstr_j | vws::filter(&LinearConstraint::is_active) |  view_to<std::vector<LinearConstraint>>();
-
-    // Assemble info object for generating boundary spectra
-    DirectMismatchSolidInfo info = {
-      .basis     = scene.resources.bases[uplifting.basis_i].value(),
-      .seed      = seed,
-      .n_samples = samples
-    };
-
-    // Base roundtrip objective
-    if (is_base_active)
-      info.linear_objectives.push_back(scene.csys(uplifting));
-
-    // Specify direct color systems forming objective
-    rng::transform(direct_cstr, 
-      std::back_inserter(info.linear_objectives),
-      [&](const auto &c) { return scene.csys(c.cmfs_j, c.illm_j); });
+    return prepare_mismatch(scene, uplifting, seed, samples)(std::stop_token());
+  }
 
-    // Base roundtrip constraint
-    if (is_base_active)
-      info.linear_constraints.push_back({ scene.csys(uplifting), colr_i });
+  std::vector<MismatchSample> DirectSurfaceConstraint::realize_mismatch_exact(const Scene &scene, const Uplifting &uplifting) const {
+    met_trace();
+    return prepare_mismatch_exact(scene, uplifting)(std::stop_token());
+  }
 
-    // Specify direct color constraints; all but the last constraint (the "free variable") are specified
-    rng::transform(direct_cstr | vws::take(direct_cstr.size() - 1), 
-      std::back_inserter(info.linear_constraints),
-      [&](const auto &c) { return std::pair { scene.csys(c.cmfs_j, c.illm_j), c.colr_j }; });
+  MismatchJob DirectSurfaceConstraint::prepare_mismatch(const Scene &scene, const Uplifting &uplifting, uint seed, uint samples) const {
+    met_trace();
+    return detail::init_mismatch_job(*this, scene, uplifting, detail::mismatch_solve, seed, samples);
+  }
 
-    return solve_mismatch_solid(info);
+  MismatchJob DirectSurfaceConstraint::prepare_mismatch_exact(const Scene &scene, const Uplifting &uplifting) const {
+    met_trace();
+    return detail::init_mismatch_job(*this, scene, uplifting, detail::mismatch_solve_exact);
   }
 
   std::vector<MismatchSample> IndirectSurfaceConstraint::realize_mismatch(const Scene &scene, const Uplifting &uplifting, uint seed, uint samples) const {
     met_trace();
+    return prepare_mismatch(scene, uplifting, seed, samples)(std::stop_token());
+  }
 
-    // Filter out inactive constraints
-    auto indrct_cstr = cstr_j | vws::filter(&NLinearConstraint::is_active) |  view_to<std::vector<NLinearConstraint>>();
-
-    // Assemble info object for generating boundary spectra
-    IndirectMismatchSolidInfo info = {
-      .basis     = scene.resources.bases[uplifting.basis_i].value(),
-      .seed      = seed,
-      .n_samples = samples
-    };
-
-    // Specify indirect color systems forming objective
-    info.nlinear_objectives.push_back({
-      .cmfs   = scene.resources.observers[indrct_cstr.back().cmfs_j].value(),
-      .powers = indrct_cstr.back().powr_j
-    });
-
-    // Base roundtrip constraint
-    if (is_base_active)
-      info.linear_constraints.push_back({ scene.csys(uplifting), colr_i });
-      
-    // Specify direct/indirect color constraints; all but the last constraint (the "free variable") are specified
-    rng::transform(indrct_cstr | vws::take(indrct_cstr.size() - 1), 
-      std::back_inserter(info.nlinear_constraints),
-      [&](const auto &c) { 
-        return std::pair { IndirectColrSystem { scene.resources.observers[c.cmfs_j].value(), c.powr_j }, c.colr_j }; 
-      });
-
-    // Output color values
-    return solve_mismatch_solid(info);
+  MismatchJob IndirectSurfaceConstraint::prepare_mismatch(const Scene &scene, const Uplifting &uplifting, uint seed, uint samples) const {
+    met_trace();
+    return detail::init_mismatch_job(*this, scene, uplifting, detail::mismatch_solve, seed, samples);
   }
 } // namespace met
\ No newline at end of file
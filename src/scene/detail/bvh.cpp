@@ -14,6 +14,7 @@
 // along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include <metameric/core/ranges.hpp>
+#include <metameric/core/detail/packing.hpp>
 #include <metameric/scene/detail/bvh.hpp>
 #include <embree4/rtcore.h>
 #include <algorithm>
@@ -268,6 +269,53 @@ namespace met::detail {
     *this = create_bvh_internal<K>({ .data = prims, .n_leaf_children = info.n_leaf_children });
   }
 
+  NodePack pack(const BVH<8>::Node &node) {
+    met_trace();
+
+    // Output node pack
+    NodePack p;
+
+    // Generate enclosing AABB over children
+    auto child_aabbs = std::span<const AABB>(node.child_aabb.begin(), node.size);
+    auto parent_aabb =*rng::fold_left_first(child_aabbs, std::plus {});
+
+    // 3xu32 packs AABB lo, ex
+    auto b_lo_in = parent_aabb.minb;
+    auto b_ex_in = (parent_aabb.maxb - parent_aabb.minb).eval();
+    p.aabb[0] = detail::pack_unorm_2x16_floor({ b_lo_in.x(), b_lo_in.y() });
+    p.aabb[1] = detail::pack_unorm_2x16_ceil ({ b_ex_in.x(), b_ex_in.y() });
+    p.aabb[2] = detail::pack_unorm_2x16_floor({ b_lo_in.z(), 0 }) 
+              | detail::pack_unorm_2x16_ceil ({ 0, b_ex_in.z() });
+
+    // Convert child leaf/node mask to bit field
+    uint child_mask = 0;
+    for (uint i = 0; i < node.child_mask.size(); ++i)
+      child_mask |= node.child_mask[i] << i;
+
+    // type 1b | child mask 8b | size 4b | offs 19b
+    p.data =  (0x007FFFFu & node.offset)        // 19 bits, child range offset
+           | ((0x000000Fu & node.size)   << 19) // 4 bits,  child range size
+           | ((0x00000FFu & child_mask)  << 23) // 8 bits,  child leaf/node mask
+           | ((0x0000001u & node.type)   << 31) // 1 bit,   current leaf/node type
+           ;
+
+    // Child AABBs are packed in 6 bytes per child
+    p.child_aabb_0.fill(0);
+    p.child_aabb_1.fill(0);
+    for (uint i = 0; i < child_aabbs.size(); ++i) {
+      auto b_lo_safe = ((child_aabbs[i].minb - b_lo_in) / b_ex_in).eval();
+      auto b_hi_safe = ((child_aabbs[i].maxb - b_lo_in) / b_ex_in).eval();
+      auto pack_0 = detail::pack_unorm_4x8_floor((eig::Array4f() << b_lo_safe.head<2>(), 0, 0).finished())
+                  | detail::pack_unorm_4x8_ceil ((eig::Array4f() << 0, 0, b_hi_safe.head<2>()).finished());
+      auto pack_1 = detail::pack_unorm_4x8_floor((eig::Array4f() << b_lo_safe.z(), 0, 0, 0).finished())
+                  | detail::pack_unorm_4x8_ceil ((eig::Array4f() << 0, b_hi_safe.z(), 0, 0).finished());
+      p.child_aabb_0[i    ] |= pack_0;
+      p.child_aabb_1[i / 2] |= (pack_1 << ((i % 2) ? 16 : 0));
+    }
+
+    return p;
+  }
+
   /* Explicit template instantiations follow for supported BVH fanouts */
 
   template class BVH<2>;
@@ -0,0 +1,55 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <metameric/core/ranges.hpp>
+#include <metameric/core/utility.hpp>
+#include <metameric/scene/detail/scheduler.hpp>
+#include <algorithm>
+
+namespace met::detail {
+  void BudgetScheduler::dispatch(std::span<Request> requests, DispatchInfo info) {
+    met_trace();
+    guard(!requests.empty());
+    m_frame++;
+
+    // Update cost estimate for requests without measurements
+    if (auto costs = requests 
+                   | vws::transform(&Request::sample_cost) 
+                   | vws::filter([](float f) { return f > 0.f; })
+                   | view_to<std::vector<float>>(); !costs.empty())
+      m_cost_mean = rng::fold_left(costs, 0.f, std::plus<float>()) / static_cast<float>(costs.size());
+
+    // Serve edited requests first, then the least recently served ones
+    std::vector<uint> order(requests.size());
+    rng::iota(order, 0u);
+    rng::stable_sort(order, {}, [&](uint i) {
+      return std::pair { !requests[i].is_edited, requests[i].last_served };
+    });
+
+    // Size jobs to fit the budget
+    float budget = info.budget;
+    for (uint k = 0; k < order.size(); ++k) {
+      auto &r = requests[order[k]];
+      float cost = r.sample_cost > 0.f ? r.sample_cost : m_cost_mean;
+      uint  n    = static_cast<uint>(std::clamp(budget / cost, 0.f, static_cast<float>(info.n_max)));
+      if (r.is_edited || k == 0)
+        n = std::max(n, info.n_min);
+      guard_continue(n >= info.n_min);
+
+      r.submit(n, m_frame);
+      budget -= static_cast<float>(n) * cost;
+    }
+  }
+} // namespace met::detail
\ No newline at end of file
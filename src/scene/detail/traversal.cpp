@@ -0,0 +1,338 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <metameric/core/detail/cpu.hpp>
+#include <metameric/scene/detail/traversal.hpp>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+
+namespace met::detail {
+  // AVX2 child box tests, defined in traversal_avx2.cpp; child boxes are passed as 3x8 floats
+  // in axis-major order, and packed child boxes are decoded relative to the parent box
+  namespace avx2 {
+    bool is_compiled();
+    uint intersect_aabb_mask(const float *o, const float *d_rcp, float t,
+                             const float *lo, const float *hi, uint size);
+    uint intersect_aabb_mask_packed(const float *o, const float *d_rcp, float t,
+                                    const float *p_lo, const float *p_ex, 
+                                    const uint *child_aabb_0, const uint *child_aabb_1, 
+                                    uint size);
+  } // namespace avx2
+
+  bool traversal_supports_avx2() {
+    static const bool is_supported = avx2::is_compiled() && cpu_supports_avx2();
+    return is_supported;
+  }
+
+  // Resolve the instruction set for a query; eAVX2 falls back to scalar code if unsupported
+  bool use_avx2(TraversalISA isa) {
+    return isa != TraversalISA::eScalar && traversal_supports_avx2();
+  }
+
+  // Per-ray data reused across child box tests during traversal
+  struct RayData {
+    eig::Array3f o, d_rcp;
+    float        t;
+
+  public:
+    RayData(const RayRecord &ray)
+    : o(ray.o), d_rcp(1.f / ray.d.array()), t(ray.t) { }
+  };
+
+  // Child AABBs of a single node, in SoA layout for 8-wide tests
+  struct NodeBoxes {
+    std::array<std::array<float, 8>, 3> lo, hi;
+  };
+
+  // Decode parent AABB of a packed node; lower bounds and extent
+  std::pair<eig::Array3f, eig::Array3f> unpack_parent_aabb(const NodePack &node) {
+    eig::Array3f lo, ex;
+    lo << unpack_unorm_2x16(node.aabb[0]), unpack_unorm_2x16(node.aabb[2]).x();
+    ex << unpack_unorm_2x16(node.aabb[1]), unpack_unorm_2x16(node.aabb[2]).y();
+    return { lo, ex };
+  }
+
+  // Decode child AABBs of a packed node; child bounds are stored as 8-bit offsets relative 
+  // to the parent AABB, and are reconstructed as fma(child, parent.ex, parent.lo)
+  NodeBoxes unpack_child_aabbs(const NodePack &node) {
+    auto [p_lo, p_ex] = unpack_parent_aabb(node);
+    NodeBoxes b;
+    for (uint i = 0; i < 8; ++i) {
+      auto unpack_0 = unpack_unorm_4x8(node.child_aabb_0[i]);
+      auto unpack_1 = unpack_unorm_4x8(node.child_aabb_1[i / 2] >> ((i % 2) ? 16 : 0));
+      b.lo[0][i] = std::fma(unpack_0[0], p_ex[0], p_lo[0]);
+      b.lo[1][i] = std::fma(unpack_0[1], p_ex[1], p_lo[1]);
+      b.lo[2][i] = std::fma(unpack_1[0], p_ex[2], p_lo[2]);
+      b.hi[0][i] = std::fma(unpack_0[2], p_ex[0], p_lo[0]);
+      b.hi[1][i] = std::fma(unpack_0[3], p_ex[1], p_lo[1]);
+      b.hi[2][i] = std::fma(unpack_1[1], p_ex[2], p_lo[2]);
+    }
+    return b;
+  }
+
+  // Gather child AABBs of an unpacked node; unused children are zeroed
+  NodeBoxes unpack_child_aabbs(const BVH<8>::Node &node) {
+    NodeBoxes b = { };
+    for (uint i = 0; i < node.size; ++i) {
+      for (uint a = 0; a < 3; ++a) {
+        b.lo[a][i] = node.child_aabb[i].minb[a];
+        b.hi[a][i] = node.child_aabb[i].maxb[a];
+      }
+    }
+    return b;
+  }
+
+  // Slab test of ray against <= 8 child AABBs; returns bitmask of hit children
+  uint ray_intersect_aabb_mask(const RayData &ray, const NodeBoxes &b, uint size) {
+    uint aabb_mask = 0u;
+    for (uint i = 0; i < size; ++i) {
+      eig::Array3f lo = { b.lo[0][i], b.lo[1][i], b.lo[2][i] },
+                   hi = { b.hi[0][i], b.hi[1][i], b.hi[2][i] };
+      
+      eig::Array3f t_max = (hi - ray.o) * ray.d_rcp,
+                   t_min = (lo - ray.o) * ray.d_rcp;
+      for (uint a = 0; a < 3; ++a)
+        if (ray.d_rcp[a] < 0.f)
+          std::swap(t_min[a], t_max[a]);
+      
+      float t_in  = std::max(std::max(t_min[0], t_min[1]), t_min[2]),
+            t_out = std::min(std::min(t_max[0], t_max[1]), t_max[2]);
+      
+      // On closest hit (compared to current ray distance), set child's bit in hit mask
+      if (t_out >= 0.f && t_in <= std::min(ray.t, t_out))
+        aabb_mask |= 1u << i;
+    }
+    return aabb_mask;
+  }
+
+  // Child box tests per node type, dispatching to the AVX2 kernels if requested
+  uint ray_intersect_aabb_mask(const RayData &ray, const BVH<8>::Node &node, bool is_avx2) {
+    auto b = unpack_child_aabbs(node);
+    guard(is_avx2, ray_intersect_aabb_mask(ray, b, node.size));
+    return avx2::intersect_aabb_mask(ray.o.data(), ray.d_rcp.data(), ray.t, 
+                                     b.lo[0].data(), b.hi[0].data(), node.size);
+  }
+
+  uint ray_intersect_aabb_mask(const RayData &ray, const NodePack &node, bool is_avx2) {
+    guard(is_avx2, ray_intersect_aabb_mask(ray, unpack_child_aabbs(node), node.size()));
+    auto [p_lo, p_ex] = unpack_parent_aabb(node);
+    return avx2::intersect_aabb_mask_packed(ray.o.data(), ray.d_rcp.data(), ray.t, p_lo.data(), p_ex.data(),
+                                            node.child_aabb_0.data(), node.child_aabb_1.data(), node.size());
+  }
+
+  // Ray/triangle test, following ray_intersect(Ray, Triangle) in render/shape/primitive.glsl;
+  // differs only in that NaN distances from degenerate triangles are rejected
+  bool ray_intersect_triangle(RayRecord &ray, const eig::Vector3f &p0, const eig::Vector3f &p1, const eig::Vector3f &p2) {
+    eig::Vector3f ab = p1 - p0,
+                  bc = p2 - p1,
+                  n_ = bc.cross(ab);
+
+    // Ray/plane distance test
+    float t = ((p0 + p1 + p2) / 3.f - ray.o).dot(n_) / n_.dot(ray.d);
+    guard(t >= 0.f && t <= ray.t, false);
+
+    // Point-in-triangle test
+    eig::Vector3f p = { std::fma(ray.d[0], t, ray.o[0]),
+                        std::fma(ray.d[1], t, ray.o[1]),
+                        std::fma(ray.d[2], t, ray.o[2]) };
+    guard(!(n_.dot((p - p0).cross(ab))      < 0.f) &&
+          !(n_.dot((p - p1).cross(bc))      < 0.f) &&
+          !(n_.dot((p - p2).cross(p0 - p2)) < 0.f), false);
+
+    // Update closest-hit distance before return
+    ray.t = t;
+    return true;
+  }
+
+  // Store primitive index in record, following record_set_object_primitive in render/record.glsl
+  void record_set_object_primitive(SurfaceRecord &rc, uint primitive_i) {
+    rc.data = SurfaceRecord::record_object_flag
+            | (rc.data     & 0x7F000000)
+            | (primitive_i & 0x00FFFFFF);
+  }
+
+  // Traversal adapter over unpacked BVH<8> data and the mesh it was built over
+  struct MeshBVHAdapter {
+    const BVH<8> &bvh;
+    const Mesh   &mesh;
+    bool          is_avx2;
+
+  public:
+    bool empty()         const { return bvh.nodes.empty();      }
+    bool is_leaf(uint i) const { return bvh.nodes[i].type;      }
+    uint offs(uint i)    const { return bvh.nodes[i].offset;    }
+    uint size(uint i)    const { return bvh.nodes[i].size;      }
+    uint mask(uint i)    const {
+      uint mask = 0;
+      for (uint j = 0; j < 8; ++j)
+        mask |= static_cast<uint>(bvh.nodes[i].child_mask[j]) << j;
+      return mask;
+    }
+
+    uint intersect_aabb_mask(const RayData &ray, uint i) const {
+      return ray_intersect_aabb_mask(ray, bvh.nodes[i], is_avx2);
+    }
+
+    bool intersect_prim(RayRecord &ray, uint j) const {
+      uint elem_i = bvh.prims[j];
+      const auto &el = mesh.elems[elem_i];
+      guard(ray_intersect_triangle(ray, mesh.verts[el[0]].matrix(), 
+                                        mesh.verts[el[1]].matrix(), 
+                                        mesh.verts[el[2]].matrix()), false);
+      record_set_object_primitive(ray.record, elem_i);
+      return true;
+    }
+  };
+
+  // Traversal adapter over packed node/primitive data, as uploaded to the gpu
+  struct PackedBVHAdapter {
+    const PackedBVH &bvh;
+    bool             is_avx2;
+
+  public:
+    bool empty()         const { return bvh.nodes.empty();     }
+    bool is_leaf(uint i) const { return bvh.nodes[i].is_leaf(); }
+    uint offs(uint i)    const { return bvh.nodes[i].offs();    }
+    uint size(uint i)    const { return bvh.nodes[i].size();    }
+    uint mask(uint i)    const { return bvh.nodes[i].mask();    }
+
+    uint intersect_aabb_mask(const RayData &ray, uint i) const {
+      return ray_intersect_aabb_mask(ray, bvh.nodes[i], is_avx2);
+    }
+
+    bool intersect_prim(RayRecord &ray, uint j) const {
+      // Unpack only position data, following unpack_triangle in render/shape/primitive.glsl
+      auto unpack_p = [](const VertexPack &v) -> eig::Vector3f {
+        return { unpack_unorm_2x16(v.p0)[0], unpack_unorm_2x16(v.p0)[1], unpack_snorm_2x16(v.p1)[0] };
+      };
+      const auto &prim = bvh.prims[j];
+      guard(ray_intersect_triangle(ray, unpack_p(prim.v0), unpack_p(prim.v1), unpack_p(prim.v2)), false);
+      record_set_object_primitive(ray.record, j);
+      return true;
+    }
+  };
+
+  // Stack-based traversal, following ray_intersect_blas in render/blas.glsl; stack entries
+  // flag <= 8 children of interest at an offset, and flagged leaves are handled first
+  // on a separate single-entry stack, to keep primitive tests coherent
+  template <bool IsAnyHit, typename Adapter>
+  bool ray_traverse(RayRecord &ray, const Adapter &bvh) {
+    met_trace();
+    guard(!bvh.empty(), false);
+
+    struct StackEntry { uint offs, mask; };
+    
+    RayData ray_data(ray);
+    bool    hit = false;
+    
+    // Test primitives in a leaf; leaves of BVHs built with n_leaf_children > 1 hold several
+    auto intersect_leaf = [&](uint leaf_i) {
+      for (uint j = bvh.offs(leaf_i); j < bvh.offs(leaf_i) + bvh.size(leaf_i); ++j) {
+        guard_continue(bvh.intersect_prim(ray, j));
+        ray_data.t = ray.t;
+        hit = true;
+        if constexpr (IsAnyHit)
+          return;
+      }
+    };
+
+    // A root leaf only occurs for tiny meshes, and is not handled gpu-side
+    if (bvh.is_leaf(0)) {
+      intersect_leaf(0);
+      return hit;
+    }
+
+    // Initiate stack for traversal from root node
+    std::array<StackEntry, 64> stck;
+    stck[0] = { .offs = 0, .mask = 1u };
+    StackEntry leaf_stck = { .offs = 0, .mask = 0u };
+
+    // Continue traversal until stack is once again empty
+    int stckc = 0;
+    while (stckc >= 0 || leaf_stck.mask != 0u) {
+      // First, handle all entries on leaf stack until empty
+      while (leaf_stck.mask != 0u) {
+        // Read next flagged bit, then remove flagged bit
+        uint leaf_bit = std::bit_width(leaf_stck.mask) - 1;
+        leaf_stck.mask &= ~(1u << leaf_bit);
+        
+        // Test primitives, exit early on any-hit
+        intersect_leaf(leaf_stck.offs + leaf_bit);
+        if constexpr (IsAnyHit)
+          guard(!hit, true);
+      }
+      
+      // Then, handle next entry on node stack
+      if (stckc >= 0) {
+        // Read next flagged node bit, then remove flagged bit
+        auto &top = stck[stckc];
+        uint node_bit = std::bit_width(top.mask) - 1;
+        top.mask &= ~(1u << node_bit);
+        uint node_i = top.offs + node_bit;
+
+        // If this was the last flagged bit, decrease stack count
+        if (top.mask == 0u)
+          stckc--;
+        
+        // Intersect against node children, build intersection mask
+        uint aabb_mask = bvh.intersect_aabb_mask(ray_data, node_i);
+        guard_continue(aabb_mask != 0u);
+
+        // If any children were hit, push the child offset + mask on the stack;
+        // we separate and push the mask into node and leaf stacks
+        uint node_mask = aabb_mask & ~bvh.mask(node_i), 
+             leaf_mask = aabb_mask &  bvh.mask(node_i);
+        if (node_mask != 0u) {
+          debug::check_expr(stckc + 1 < static_cast<int>(stck.size()), 
+                            "ray_traverse: exceeded traversal stack size");
+          stck[++stckc] = { .offs = bvh.offs(node_i), .mask = node_mask };
+        }
+        if (leaf_mask != 0u)
+          leaf_stck = { .offs = bvh.offs(node_i), .mask = leaf_mask };
+      }
+    } // while (...)
+
+    return hit;
+  }
+
+  bool ray_intersect(RayRecord &ray, const BVH<8> &bvh, const Mesh &mesh, TraversalISA isa) {
+    return ray_traverse<false>(ray, MeshBVHAdapter { bvh, mesh, use_avx2(isa) });
+  }
+
+  bool ray_intersect(RayRecord &ray, const PackedBVH &bvh, TraversalISA isa) {
+    return ray_traverse<false>(ray, PackedBVHAdapter { bvh, use_avx2(isa) });
+  }
+
+  bool ray_intersect_any(const RayRecord &ray, const BVH<8> &bvh, const Mesh &mesh, TraversalISA isa) {
+    RayRecord ray_ = ray;
+    return ray_traverse<true>(ray_, MeshBVHAdapter { bvh, mesh, use_avx2(isa) });
+  }
+
+  bool ray_intersect_any(const RayRecord &ray, const PackedBVH &bvh, TraversalISA isa) {
+    RayRecord ray_ = ray;
+    return ray_traverse<true>(ray_, PackedBVHAdapter { bvh, use_avx2(isa) });
+  }
+
+  uint ray_intersect_aabb_mask(const RayRecord &ray, const BVH<8>::Node &node, TraversalISA isa) {
+    return ray_intersect_aabb_mask(RayData(ray), node, use_avx2(isa));
+  }
+
+  uint ray_intersect_aabb_mask(const RayRecord &ray, const NodePack &node, TraversalISA isa) {
+    return ray_intersect_aabb_mask(RayData(ray), node, use_avx2(isa));
+  }
+} // namespace met::detail
\ No newline at end of file
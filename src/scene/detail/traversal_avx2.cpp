@@ -0,0 +1,110 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// AVX2 child box tests for traversal.cpp; this file alone is compiled with AVX2/FMA enabled,
+// and is only called into after a runtime cpu check. It deliberately includes no project or 
+// standard library headers, and uses plain pointers, as inline functions instantiated here 
+// could otherwise be emitted with AVX2 instructions and picked up by other translation units.
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#include <immintrin.h>
+#define MET_TRAVERSAL_AVX2
+#endif
+
+namespace met::detail::avx2 {
+#ifdef MET_TRAVERSAL_AVX2
+  namespace {
+    // Slab test of ray against 8 child AABBs in registers; returns bitmask of hit children
+    unsigned intersect_aabb_mask(const float *o, const float *d_rcp, float t, 
+                                 const __m256 *lo, const __m256 *hi, unsigned size) {
+      __m256 t_min[3], t_max[3];
+      for (unsigned a = 0; a < 3; ++a) {
+        __m256 o_a  = _mm256_set1_ps(o[a]), 
+               d_a  = _mm256_set1_ps(d_rcp[a]);
+        __m256 t_lo = _mm256_mul_ps(_mm256_sub_ps(lo[a], o_a), d_a),
+               t_hi = _mm256_mul_ps(_mm256_sub_ps(hi[a], o_a), d_a);
+        
+        // Swap is uniform across children, as it depends on ray direction only
+        bool is_swap = d_rcp[a] < 0.f;
+        t_min[a] = is_swap ? t_hi : t_lo;
+        t_max[a] = is_swap ? t_lo : t_hi;
+      }
+
+      // Operands to min/max are swapped; _mm256_max_ps(b, a) matches std::max(a, b) and 
+      // max(a, b) in glsl, in that both return a if either operand is NaN
+      __m256 t_in  = _mm256_max_ps(t_min[2], _mm256_max_ps(t_min[1], t_min[0])),
+             t_out = _mm256_min_ps(t_max[2], _mm256_min_ps(t_max[1], t_max[0])),
+             t_cap = _mm256_min_ps(t_out, _mm256_set1_ps(t));
+      __m256 is_hit = _mm256_and_ps(_mm256_cmp_ps(t_out, _mm256_setzero_ps(), _CMP_GE_OQ),
+                                    _mm256_cmp_ps(t_in, t_cap, _CMP_LE_OQ));
+      
+      return static_cast<unsigned>(_mm256_movemask_ps(is_hit)) & ((1u << size) - 1u);
+    }
+  } // namespace
+
+  bool is_compiled() { 
+    return true; 
+  }
+
+  unsigned intersect_aabb_mask(const float *o, const float *d_rcp, float t,
+                               const float *lo, const float *hi, unsigned size) {
+    __m256 lo_[3], hi_[3];
+    for (unsigned a = 0; a < 3; ++a) {
+      lo_[a] = _mm256_loadu_ps(lo + 8 * a);
+      hi_[a] = _mm256_loadu_ps(hi + 8 * a);
+    }
+    return intersect_aabb_mask(o, d_rcp, t, lo_, hi_, size);
+  }
+
+  unsigned intersect_aabb_mask_packed(const float *o, const float *d_rcp, float t,
+                                      const float *p_lo, const float *p_ex, 
+                                      const unsigned *child_aabb_0, const unsigned *child_aabb_1, 
+                                      unsigned size) {
+    // Child i reads child_aabb_0[i], and child_aabb_1[i / 2] shifted by 16 bits for odd i
+    __m256i c0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(child_aabb_0));
+    __m256i c1 = _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(child_aabb_1)));
+    c1 = _mm256_permutevar8x32_epi32(c1, _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3));
+    c1 = _mm256_srlv_epi32(c1, _mm256_setr_epi32(0, 16, 0, 16, 0, 16, 0, 16));
+
+    // Extract k'th byte as unorm; matches unpack_unorm_4x8
+    auto unpack_unorm = [](__m256i v, int k) {
+      __m256i u = _mm256_and_si256(_mm256_srl_epi32(v, _mm_cvtsi32_si128(8 * k)), _mm256_set1_epi32(0xFF));
+      return _mm256_mul_ps(_mm256_cvtepi32_ps(u), _mm256_set1_ps(0.0039215686274509803921568627451f));
+    };
+
+    // Child bounds are reconstructed as fma(child, parent.ex, parent.lo)
+    auto fma = [&](__m256 u, unsigned a) {
+      return _mm256_fmadd_ps(u, _mm256_set1_ps(p_ex[a]), _mm256_set1_ps(p_lo[a]));
+    };
+
+    __m256 lo[3] = { fma(unpack_unorm(c0, 0), 0), fma(unpack_unorm(c0, 1), 1), fma(unpack_unorm(c1, 0), 2) };
+    __m256 hi[3] = { fma(unpack_unorm(c0, 2), 0), fma(unpack_unorm(c0, 3), 1), fma(unpack_unorm(c1, 1), 2) };
+    return intersect_aabb_mask(o, d_rcp, t, lo, hi, size);
+  }
+#else
+  // Not compiled with AVX2 support; traversal.cpp never dispatches here
+  bool is_compiled() { 
+    return false; 
+  }
+
+  unsigned intersect_aabb_mask(const float *, const float *, float, const float *, const float *, unsigned) {
+    return 0u;
+  }
+
+  unsigned intersect_aabb_mask_packed(const float *, const float *, float, const float *, const float *, 
+                                      const unsigned *, const unsigned *, unsigned) {
+    return 0u;
+  }
+#endif
+} // namespace met::detail::avx2
\ No newline at end of file
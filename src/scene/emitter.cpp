@@ -64,17 +64,56 @@ namespace met {
       return gl::Buffer {{ .data = cnt_span<const std::byte>(data) }};    
     }
     
-    SceneGLHandler<met::Emitter>::SceneGLHandler() {
+    void SceneGLHandler<met::Emitter>::update_cache(const Scene &scene) {
       met_trace_full();
 
-      // Alllocate up to a number of objects and obtain writeable/flushable mapping
-      // for regular emitters and an envmap
-      std::tie(emitter_info, m_emitter_info_map) = gl::Buffer::make_flusheable_object<BufferLayout>();
-      std::tie(emitter_envm_info, m_envm_info_data) = gl::Buffer::make_flusheable_object<EnvBufferLayout>();
+      // Get relevant resources
+      const auto &emitters = scene.components.emitters;
+      guard(!emitters.empty() && emitters);
+
+      // Build sampling distribution over emitter's relative output
+      std::vector<float> emitter_power(met_max_emitters, 0.f);
+      #pragma omp parallel for
+      for (int i = 0; i < emitters.size(); ++i) {
+        const auto &[emitter, state] = emitters[i];
+        guard_continue(emitter.is_active);
+
+        // Get corresponding observer luminance for output spd under xyz/d65
+        Spec  s = scene.resources.illuminants[emitter.illuminant_i].value() * emitter.illuminant_scale;
+        float w = luminance(ColrSystem { .cmfs = models::cmfs_cie_xyz, .illuminant = models::emitter_cie_d65 }(s));
+
+        // Multiply by either approx. surface area, or hemisphere
+        switch (emitter.type) {
+          case Emitter::Type::eSphere:
+            w *= 
+              .5f *
+              4.f * std::numbers::pi_v<float> * std::pow(emitter.transform.scaling.x(), 2.f);
+            break;
+          case Emitter::Type::eRect:
+            w *= 
+              emitter.transform.scaling.x() * emitter.transform.scaling.y();
+            break;
+          default:
+            w *= 2.f * std::numbers::pi_v<float>; // half a hemisphere
+            break;
+        }
+
+        emitter_power[i] = w;
+      }
+
+      // Generate sampling distribution
+      emitter_distr = Distribution(cnt_span<float>(emitter_power));
     }
 
     void SceneGLHandler<met::Emitter>::update(const Scene &scene) {
       met_trace_full();
+
+      // Alllocate up to a number of objects on first use and obtain writeable/flushable mapping
+      // for regular emitters and an envmap
+      if (!emitter_info.is_init()) {
+        std::tie(emitter_info, m_emitter_info_map) = gl::Buffer::make_flusheable_object<BufferLayout>();
+        std::tie(emitter_envm_info, m_envm_info_data) = gl::Buffer::make_flusheable_object<EnvBufferLayout>();
+      }
       
       // Destroy old sync object
       m_fence = { };
@@ -110,40 +149,10 @@ namespace met {
                                   gl::BarrierFlags::eClientMappedBuffer);
       }
 
-      // Build sampling distribution over emitter's relative output
+      // Build sampling distribution over emitter's relative output, and push to gpu
       if (emitters) {
-        std::vector<float> emitter_distr(met_max_emitters, 0.f);
-        #pragma omp parallel for
-        for (int i = 0; i < emitters.size(); ++i) {
-          const auto &[emitter, state] = emitters[i];
-          guard_continue(emitter.is_active);
-
-          // Get corresponding observer luminance for output spd under xyz/d65
-          Spec  s = scene.resources.illuminants[emitter.illuminant_i].value() * emitter.illuminant_scale;
-          float w = luminance(ColrSystem { .cmfs = models::cmfs_cie_xyz, .illuminant = models::emitter_cie_d65 }(s));
-
-          // Multiply by either approx. surface area, or hemisphere
-          switch (emitter.type) {
-            case Emitter::Type::eSphere:
-              w *= 
-                .5f *
-                4.f * std::numbers::pi_v<float> * std::pow(emitter.transform.scaling.x(), 2.f);
-              break;
-            case Emitter::Type::eRect:
-              w *= 
-                emitter.transform.scaling.x() * emitter.transform.scaling.y();
-              break;
-            default:
-              w *= 2.f * std::numbers::pi_v<float>; // half a hemisphere
-              break;
-          }
-
-          emitter_distr[i] = w;
-        }
-        
-        // Generate sampling distribution and push to gpu
-        auto emitter_cdf = Distribution(cnt_span<float>(emitter_distr));
-        emitter_distr_buffer = to_std140(emitter_cdf);
+        update_cache(scene);
+        emitter_distr_buffer = to_std140(emitter_distr);
 
         // Store information on first constant emitter, if one is present and active;
         // we don't support multiple environment emitters (I mean how would that even look...)
@@ -112,16 +112,13 @@ namespace met {
       return u;
     }
 
-    SceneGLHandler<met::Object>::SceneGLHandler() {
-      met_trace_full();
-
-      // Allocate up to a number of objects and obtain writeable/flushable mapping
-      std::tie(object_info, m_object_info_map) = gl::Buffer::make_flusheable_object<BufferLayout>();
-    }
-
     void SceneGLHandler<met::Object>::update(const Scene &scene) {
       met_trace_full();
 
+      // Allocate up to a number of objects on first use and obtain writeable/flushable mapping
+      if (!object_info.is_init())
+        std::tie(object_info, m_object_info_map) = gl::Buffer::make_flusheable_object<BufferLayout>();
+
       // Destroy old sync object
       m_fence = { };
 
@@ -25,62 +25,6 @@
 #include <numeric>
 
 namespace met::detail {
-  struct NodePack {
-    uint data;                        // type 1b | child mask 8b | size 4b | offs 19b
-    std::array<uint, 3> aabb;         // [lo.x, lo.y], [hi.x, hi.y], [lo.z, hi.z]
-    std::array<uint, 8> child_aabb_0; // per child: lo.x | lo.y | hi.x | hi.y
-    std::array<uint, 4> child_aabb_1; // per child: lo.z | hi.z
-  };
-  static_assert(sizeof(NodePack) == 64);
-
-  // Helper method to pack BVH node data to NodePack type
-  NodePack pack(const BVH<8>::Node &node) {
-    met_trace();
-
-    // Output node pack
-    NodePack p;
-
-    // Generate enclosing AABB over children
-    auto child_aabbs = std::span<const AABB>(node.child_aabb.begin(), node.size);
-    auto parent_aabb =*rng::fold_left_first(child_aabbs, std::plus {});
-
-    // 3xu32 packs AABB lo, ex
-    auto b_lo_in = parent_aabb.minb;
-    auto b_ex_in = (parent_aabb.maxb - parent_aabb.minb).eval();
-    p.aabb[0] = detail::pack_unorm_2x16_floor({ b_lo_in.x(), b_lo_in.y() });
-    p.aabb[1] = detail::pack_unorm_2x16_ceil ({ b_ex_in.x(), b_ex_in.y() });
-    p.aabb[2] = detail::pack_unorm_2x16_floor({ b_lo_in.z(), 0 }) 
-              | detail::pack_unorm_2x16_ceil ({ 0, b_ex_in.z() });
-
-    // Convert child leaf/node mask to bit field
-    uint child_mask = 0;
-    for (uint i = 0; i < node.child_mask.size(); ++i)
-      child_mask |= node.child_mask[i] << i;
-
-    // type 1b | child mask 8b | size 4b | offs 19b
-    p.data =  (0x007FFFFu & node.offset)        // 19 bits, child range offset
-           | ((0x000000Fu & node.size)   << 19) // 4 bits,  child range size
-           | ((0x00000FFu & child_mask)  << 23) // 8 bits,  child leaf/node mask
-           | ((0x0000001u & node.type)   << 31) // 1 bit,   current leaf/node type
-           ;
-
-    // Child AABBs are packed in 6 bytes per child
-    p.child_aabb_0.fill(0);
-    p.child_aabb_1.fill(0);
-    for (uint i = 0; i < child_aabbs.size(); ++i) {
-      auto b_lo_safe = ((child_aabbs[i].minb - b_lo_in) / b_ex_in).eval();
-      auto b_hi_safe = ((child_aabbs[i].maxb - b_lo_in) / b_ex_in).eval();
-      auto pack_0 = detail::pack_unorm_4x8_floor((eig::Array4f() << b_lo_safe.head<2>(), 0, 0).finished())
-                  | detail::pack_unorm_4x8_ceil ((eig::Array4f() << 0, 0, b_hi_safe.head<2>()).finished());
-      auto pack_1 = detail::pack_unorm_4x8_floor((eig::Array4f() << b_lo_safe.z(), 0, 0, 0).finished())
-                  | detail::pack_unorm_4x8_ceil ((eig::Array4f() << 0, b_hi_safe.z(), 0, 0).finished());
-      p.child_aabb_0[i    ] |= pack_0;
-      p.child_aabb_1[i / 2] |= (pack_1 << ((i % 2) ? 16 : 0));
-    }
-
-    return p;
-  }
-
   // Helper to calculate (poorly) fitting AABB
   AABB generate_rotated_aabb(const eig::Matrix4f &trf) {
     // Corners of AABB
@@ -120,14 +64,7 @@ namespace met::detail {
     return AABB { minb, maxb };
   }
 
-  SceneGLHandler<met::Mesh>::SceneGLHandler() {
-    met_trace_full();
-
-    // Preallocate up to a number of meshes and obtain writeable/flushable mapping
-    std::tie(blas_info, m_blas_info_map) = gl::Buffer::make_flusheable_object<BLASInfoBufferLayout>();
-  }
-
-  void SceneGLHandler<met::Mesh>::update(const Scene &scene) {
+  void SceneGLHandler<met::Mesh>::update_cache(const Scene &scene) {
     met_trace_full();
 
     const auto &meshes = scene.resources.meshes;
@@ -136,9 +73,6 @@ namespace met::detail {
     // Resize cache vector, which keeps cleaned, simplified mesh data around 
     mesh_cache.resize(meshes.size());
 
-    // Set appropriate mesh count in buffer
-    m_blas_info_map->size = static_cast<uint>(meshes.size());
-
     // For each mesh, we simplify the mesh to a hardcoded maximum, 
     // fit it to a [0, 1] cube, and finally compute a BVH over the result.
     // The result is cached cpu-side
@@ -151,6 +85,23 @@ namespace met::detail {
       data.unit_trf = unitize_mesh<met::Mesh>(data.mesh);
       data.bvh      = {{ .mesh = data.mesh, .n_leaf_children = 1 }};
     }
+  }
+
+  void SceneGLHandler<met::Mesh>::update(const Scene &scene) {
+    met_trace_full();
+
+    // Allocate up to a number of meshes on first use and obtain writeable/flushable mapping
+    if (!blas_info.is_init())
+      std::tie(blas_info, m_blas_info_map) = gl::Buffer::make_flusheable_object<BLASInfoBufferLayout>();
+
+    const auto &meshes = scene.resources.meshes;
+    guard(!meshes.empty() && meshes);
+
+    // Rebuild cpu-side mesh data and BVHs first
+    update_cache(scene);
+
+    // Set appropriate mesh count in buffer
+    m_blas_info_map->size = static_cast<uint>(meshes.size());
 
     // Pack mesh/BVH data tightly and fill in corresponding mesh layout info
     // Temporary layout data
@@ -256,15 +207,12 @@ namespace met::detail {
     blas_info.flush();
   }
 
-  SceneGLHandler<met::Image>::SceneGLHandler() {
-    met_trace_full();
-
-    // Preallocate up to a number of blocks
-    std::tie(texture_info, m_texture_info_map) = gl::Buffer::make_flusheable_object<BufferLayout>();
-  }
-
   void SceneGLHandler<met::Image>::update(const Scene &scene) {
     met_trace_full();
+
+    // Allocate up to a number of blocks on first use
+    if (!texture_info.is_init())
+      std::tie(texture_info, m_texture_info_map) = gl::Buffer::make_flusheable_object<BufferLayout>();
     
     const auto &images = scene.resources.images;
     const auto &e_settings = scene.components.settings.value;
@@ -362,17 +310,16 @@ namespace met::detail {
       texture_atlas_1f.texture().generate_mipmaps();
   }
 
-  SceneGLHandler<met::Spec>::SceneGLHandler() {
-    met_trace_full();
-
-    auto n_layers   = std::min<uint>(gl::get_variable_int(gl::VariableName::eMaxArrayTextureLayers), met_max_constraints);
-    spec_texture    = {{ .size = { wavelength_samples, n_layers } }};
-    std::tie(spec_buffer, spec_buffer_map) = gl::Buffer::make_flusheable_span<Spec>(n_layers);
-  }
-
   void SceneGLHandler<met::Spec>::update(const Scene &scene) {
     met_trace_full();
 
+    // Allocate texture and pixel buffer on first use
+    if (!spec_texture.is_init()) {
+      auto n_layers   = std::min<uint>(gl::get_variable_int(gl::VariableName::eMaxArrayTextureLayers), met_max_constraints);
+      spec_texture    = {{ .size = { wavelength_samples, n_layers } }};
+      std::tie(spec_buffer, spec_buffer_map) = gl::Buffer::make_flusheable_span<Spec>(n_layers);
+    }
+
     const auto &illuminants = scene.resources.illuminants;
     guard(illuminants);
     
@@ -386,16 +333,16 @@ namespace met::detail {
     spec_texture.set(spec_buffer);
   }
 
-  SceneGLHandler<met::CMFS>::SceneGLHandler() {
-    met_trace_full();
-    auto n_layers   = std::min<uint>(gl::get_variable_int(gl::VariableName::eMaxArrayTextureLayers), 16);
-    cmfs_texture    = {{ .size = { wavelength_samples, n_layers } }};
-    std::tie(cmfs_buffer, cmfs_buffer_map) = gl::Buffer::make_flusheable_span<CMFS>(n_layers);
-  }
-
   void SceneGLHandler<met::CMFS>::update(const Scene &scene) {
     met_trace_full();
 
+    // Allocate texture and pixel buffer on first use
+    if (!cmfs_texture.is_init()) {
+      auto n_layers   = std::min<uint>(gl::get_variable_int(gl::VariableName::eMaxArrayTextureLayers), 16);
+      cmfs_texture    = {{ .size = { wavelength_samples, n_layers } }};
+      std::tie(cmfs_buffer, cmfs_buffer_map) = gl::Buffer::make_flusheable_span<CMFS>(n_layers);
+    }
+
     const auto &observers = scene.resources.observers;
     guard(observers);
     
@@ -115,7 +115,9 @@ namespace met {
     js = {{ "renderer_type", settings.renderer_type },
           { "texture_size",  settings.texture_size  },
           { "view_i",        settings.view_i        },
-          { "view_scale",    settings.view_scale    }};
+          { "view_scale",    settings.view_scale    },
+          { "solve_budget",  settings.solve_budget  },
+          { "solve_layout",  settings.solve_layout  }};
   }
 
   void from_json(const json &js, Settings &settings) {
@@ -124,6 +126,10 @@ namespace met {
     js.at("texture_size").get_to(settings.texture_size);
     js.at("view_i").get_to(settings.view_i);
     js.at("view_scale").get_to(settings.view_scale);
+    if (js.contains("solve_budget"))
+      js.at("solve_budget").get_to(settings.solve_budget);
+    if (js.contains("solve_layout"))
+      js.at("solve_layout").get_to(settings.solve_layout);
   }
 
   void to_json(json &js, const View &view) {
@@ -863,6 +869,16 @@ namespace met {
 
   void Scene::update() {
     met_trace_full();
+    update(true);
+  }
+
+  void Scene::update_headless() {
+    met_trace_full();
+    update(false);
+  }
+
+  void Scene::update(bool gl_enabled) {
+    met_trace_full();
 
     // Force check of scene indices to ensure linked components/resources still exist,
     // or reset to indices that we know exist
@@ -908,15 +924,15 @@ namespace met {
     components.settings.state.update(components.settings.value);
 
     // Force update check of stale gl-side components and state tracking
-    resources.meshes.update(*this);
-    resources.images.update(*this);
-    resources.illuminants.update(*this);
-    resources.observers.update(*this);
-    resources.bases.update(*this);
-    components.emitters.update(*this);
-    components.objects.update(*this);
-    components.upliftings.update(*this);
-    components.views.update(*this);
+    resources.meshes.update(*this, gl_enabled);
+    resources.images.update(*this, gl_enabled);
+    resources.illuminants.update(*this, gl_enabled);
+    resources.observers.update(*this, gl_enabled);
+    resources.bases.update(*this, gl_enabled);
+    components.emitters.update(*this, gl_enabled);
+    components.objects.update(*this, gl_enabled);
+    components.upliftings.update(*this, gl_enabled);
+    components.views.update(*this, gl_enabled);
   }
 
   void Scene::wait_for_update() const {
@@ -16,9 +16,12 @@
 #include <metameric/scene/scene.hpp>
 #include <metameric/core/metamer.hpp>
 #include <metameric/core/ranges.hpp>
+#include <metameric/core/worker.hpp>
 #include <small_gl/dispatch.hpp>
 #include <algorithm>
+#include <chrono>
 #include <execution>
+#include <utility>
 
 namespace met {
   namespace detail {
@@ -57,16 +60,17 @@ namespace met {
       && rng::equal(verts, o.verts);
   }
   
-  std::vector<MismatchSample> Uplifting::sample_color_solid(const Scene &scene, uint seed, uint n) const {
+  ColorSolidCache::entry_type Uplifting::sample_color_solid(const Scene &scene, uint seed, uint n) const {
     met_trace();
     // Assemble color system data, then forward to metamer.hpp to 
-    // generate n points on color system boundary
+    // generate n points on color system boundary; the output is shared
+    // through a process-wide cache, as many upliftings use the same color system
     ColrSystem csys = { .cmfs       = *scene.resources.observers[observer_i],
                         .illuminant = *scene.resources.illuminants[illuminant_i] };
-    return solve_color_solid({ .direct_objective = csys,
-                               .basis            = *scene.resources.bases[basis_i],
-                               .seed             = seed,
-                               .n_samples        = n });
+    return ColorSolidCache::instance().solve({ .direct_objective = csys,
+                                               .basis            = *scene.resources.bases[basis_i],
+                                               .seed             = seed,
+                                               .n_samples        = n });
   }
 
   MismatchSample Uplifting::Vertex::realize(const Scene &scene, const Uplifting &uplifting) const {
@@ -100,6 +104,53 @@ namespace met {
     });
   }
 
+  std::vector<MismatchSample> Uplifting::Vertex::realize_mismatch_exact(const Scene     &scene, 
+                                                                        const Uplifting &uplifting) const {
+    met_trace();
+
+    // Return zero constraint for inactive vertices or those without mismatching
+    guard(has_mismatching(scene, uplifting), { });
+
+    // Otherwise, visit the underlying constraint; only linear constraints produce a polytope
+    return constraint | visit {
+      [&](const is_linear_constraint auto &cstr) { 
+        return cstr.realize_mismatch_exact(scene, uplifting); 
+      },
+      [](const auto &) { return std::vector<MismatchSample>(); }
+    };
+  }
+
+  MismatchJob Uplifting::Vertex::prepare_mismatch(const Scene     &scene, 
+                                                  const Uplifting &uplifting,
+                                                        uint       seed,
+                                                        uint       samples) const {
+    met_trace();
+
+    // Return empty job for inactive vertices or those without mismatching
+    guard(has_mismatching(scene, uplifting), { });
+
+    // Otherwise, visit the underlying constraint to assemble the job
+    return constraint | visit([&](const auto &cstr) { 
+      return cstr.prepare_mismatch(scene, uplifting, seed, samples); 
+    });
+  }
+
+  MismatchJob Uplifting::Vertex::prepare_mismatch_exact(const Scene     &scene, 
+                                                        const Uplifting &uplifting) const {
+    met_trace();
+
+    // Return empty job for inactive vertices or those without mismatching
+    guard(has_mismatching(scene, uplifting), { });
+
+    // Otherwise, visit the underlying constraint; only linear constraints produce a polytope
+    return constraint | visit {
+      [&](const is_linear_constraint auto &cstr) { 
+        return cstr.prepare_mismatch_exact(scene, uplifting); 
+      },
+      [](const auto &) { return MismatchJob(); }
+    };
+  }
+
   bool Uplifting::Vertex::is_position_shifting() const {
     met_trace();
     return constraint | visit {
@@ -436,50 +487,196 @@ namespace met {
       for (uint i = emitter_data.size(); i > scene.components.emitters.size(); --i)
         emitter_data.pop_back();
       
-      // Generate spectral uplifting data and per-object spectral texture
+      // Generate spectral uplifting data and per-object spectral texture; then, 
+      // distribute mismatch volume solves over the builders requesting them
       for (auto &data : uplifting_data)
-        data.update(scene);
+        data.update(scene, worker_pool);
+      solve_scheduler.dispatch(scene, uplifting_data, worker_pool);
       for (auto &data : object_data)
         data.update(scene);
       for (auto &data : emitter_data)
         data.update(scene);
     }
 
+    void SceneGLHandler<met::Uplifting>::update_cache(const Scene &scene) {
+      met_trace_full();
+
+      // Only rebuild if there are upliftings
+      guard(!scene.components.upliftings.empty());
+
+      // Adjust nr of UpliftingData blocks up to or down to relevant size
+      for (uint i = uplifting_data.size(); i < scene.components.upliftings.size(); ++i)
+        uplifting_data.push_back(i);
+      for (uint i = uplifting_data.size(); i > scene.components.upliftings.size(); --i)
+        uplifting_data.pop_back();
+
+      // Generate spectral uplifting data, but skip gl-side packing and texture bakes
+      for (auto &data : uplifting_data)
+        data.update_cache(scene, worker_pool);
+      solve_scheduler.dispatch(scene, uplifting_data, worker_pool);
+    }
+
     using MetamerBuilder = SceneGLHandler<met::Uplifting>::MetamerBuilder;
 
-    void MetamerBuilder::insert_samples(std::span<const MismatchSample> new_samples) {
+    void MetamerBuilder::State::insert_samples(std::span<const MismatchSample> new_samples) {
       met_trace();
       
       // If old samples exist, these are incrementally discarded,
       // figure out which parts to discard at the front before adding new samples
-      if (m_samples_prev > 0) {
-        auto reduce_size = std::min({ static_cast<uint>(new_samples.size()),
-                                      static_cast<uint>(m_samples.size()),
-                                      m_samples_prev });
-        m_samples_prev -= reduce_size;
-        m_samples.erase(m_samples.begin(), m_samples.begin() + reduce_size);
+      uint reduce_size = 0;
+      if (samples_prev > 0) {
+        reduce_size = std::min({ static_cast<uint>(new_samples.size()),
+                                 static_cast<uint>(samples.size()),
+                                 samples_prev });
+        samples_prev -= reduce_size;
+        samples.erase(samples.begin(), samples.begin() + reduce_size);
       }
 
       // Add new samples to the end of the queue
-      rng::copy(new_samples, std::back_inserter(m_samples));
-      m_samples_curr += new_samples.size();
+      rng::copy(new_samples, std::back_inserter(samples));
+      samples_curr += new_samples.size();
+
+      // If no samples were discarded, the hull's vertices still match the sample queue,
+      // and new samples are inserted incrementally; samples inside the hull are rejected there
+      if (reduce_size == 0 && hull.has_delaunay()) {
+        auto points = new_samples | vws::transform(&MismatchSample::colr) | view_to<std::vector<Colr>>();
+        hull.insert(points);
+        return;
+      }
+
+      // Otherwise, rebuild the hull from the full point set, if it is large enough
+      if (samples.size() < 6) {
+        hull = { };
+        return;
+      }
 
       // Extract point data into range, and determine AABB of this full point set
-      auto points = m_samples | vws::transform(&MismatchSample::colr) | view_to<std::vector<Colr>>();
+      auto points = samples | vws::transform(&MismatchSample::colr) | view_to<std::vector<Colr>>();
       auto maxb   = rng::fold_left_first(points, [](auto a, auto b) { return a.max(b).eval(); }).value();
       auto minb   = rng::fold_left_first(points, [](auto a, auto b) { return a.min(b).eval(); }).value();
 
       // Minimum threshold for convex hull generation exceeds simplex size,
-      // because QHull can throw a fit on small inputs
+      // because the hull can degenerate on small inputs
       // if (m_colr_samples.size() >= 6 && (maxb - minb).minCoeff() > .005f) {
-      if (m_samples.size() >= 6 && (maxb - minb).minCoeff() > .0005f) {
-        hull = {{ .data = points }};
+      if ((maxb - minb).minCoeff() > .0005f) {
+        hull = IncrementalConvexHull(points);
       } else {
         hull = { };
       }
     }
 
-    MismatchSample MetamerBuilder::realize(const Scene &scene, uint uplifting_i, uint vertex_i) {
+    void MetamerBuilder::reset() {
+      met_trace();
+      hull = { };
+      m_samples.clear();
+      m_samples_curr = 0;
+      m_samples_prev = 0;
+      m_sequence_i   = 0;
+      m_is_exact     = false;
+      invalidate();
+    }
+
+    void MetamerBuilder::invalidate() {
+      met_trace();
+      std::lock_guard lock(m_mailbox->mutex);
+      m_mailbox->generation++;
+      m_mailbox->ready = std::nullopt;
+      m_mailbox->stop.request_stop();
+      m_mailbox->stop  = std::stop_source();
+      m_is_pending     = false;
+    }
+
+    bool MetamerBuilder::poll() {
+      met_trace();
+
+      // Take completed back state, if any exists
+      std::optional<State> ready;
+      {
+        std::lock_guard lock(m_mailbox->mutex);
+        guard(m_mailbox->ready, false);
+        ready = std::exchange(m_mailbox->ready, std::nullopt);
+      }
+
+      // Swap to front
+      hull           = std::move(ready->hull);
+      m_samples      = std::move(ready->samples);
+      m_samples_curr = ready->samples_curr;
+      m_samples_prev = ready->samples_prev;
+      m_is_exact     = ready->is_exact;
+      m_is_pending   = false;
+
+      // Track per-sample job cost for SolveScheduler
+      if (ready->sample_cost > 0.f)
+        m_sample_cost = m_sample_cost > 0.f ? 0.75f * m_sample_cost + 0.25f * ready->sample_cost
+                                            : ready->sample_cost;
+      return true;
+    }
+
+    void MetamerBuilder::submit(WorkerPool &pool, const Scene &scene, const Uplifting &uplifting, const Uplifting::Vertex &vert, uint n) {
+      met_trace();
+
+      // Assemble self-contained solver jobs on this thread, as scene data may change
+      // while the jobs are in flight; for linear constraints, the exact volume is 
+      // attempted first, only once, as it replaces all prior samples. Each job continues the
+      // vertex' low-discrepancy direction sequence, s.t. new samples fill gaps in coverage
+      auto exact_job = m_samples_curr == 0 ? vert.prepare_mismatch_exact(scene, uplifting) : MismatchJob();
+      auto iter_job  = vert.prepare_mismatch(scene, uplifting, m_sequence_i, n);
+      guard(exact_job || iter_job);
+      m_sequence_i  += n;
+      m_wants_submit = false;
+
+      // Copy the front state, including its hull; the job builds its back state from this,
+      // s.t. new samples are inserted into the existing hull instead of rebuilding it
+      State state = {
+        .is_exact     = m_is_exact,
+        .samples      = m_samples,
+        .samples_curr = m_samples_curr,
+        .samples_prev = m_samples_prev,
+        .hull         = hull
+      };
+
+      m_is_pending = true;
+      pool.submit([mailbox    = m_mailbox, 
+                   generation = m_mailbox->generation.load(),
+                   stop       = m_mailbox->stop.get_token(),
+                   exact_job  = std::move(exact_job), 
+                   iter_job   = std::move(iter_job),
+                   n_samples  = n,
+                   state      = std::move(state)]() mutable {
+        met_trace();
+
+        // Skip stale jobs
+        guard(mailbox->generation == generation);
+
+        // Generate new samples, and build the back state's hull; a stopped exact job returns
+        // nothing, in which case the stale job is dropped entirely
+        auto exact_samples = exact_job ? exact_job(stop) : std::vector<MismatchSample>();
+        guard(!stop.stop_requested());
+        if (!exact_samples.empty()) {
+          state.samples.clear();
+          state.samples_curr = 0;
+          state.samples_prev = 0;
+          state.is_exact     = true;
+          state.hull         = { };
+          state.insert_samples(exact_samples);
+        } else if (iter_job) {
+          // Measure per-sample cost of the solve itself
+          using clock = std::chrono::steady_clock;
+          auto time_start = clock::now();
+          auto samples    = iter_job(stop);
+          state.sample_cost = std::chrono::duration<float, std::milli>(clock::now() - time_start).count() 
+                            / static_cast<float>(n_samples);
+          state.insert_samples(samples);
+        }
+
+        // Publish result, unless the job went stale in the meantime
+        std::lock_guard lock(mailbox->mutex);
+        guard(mailbox->generation == generation);
+        mailbox->ready = std::move(state);
+      });
+    }
+
+    MismatchSample MetamerBuilder::realize(WorkerPool &pool, const Scene &scene, uint uplifting_i, uint vertex_i) {
       met_trace();
 
       // Get handles
@@ -487,24 +684,23 @@ namespace met {
       const auto &vert      = uplifting->verts[vertex_i];
 
       // Return dead data if the vertex is inactive
+      m_did_solve    = false;
+      m_wants_submit = false;
       guard(vert.is_active, MismatchSample { Colr(0), Spec(0), Basis::vec_type(0) });
 
       // First, deal with new mismatch samples
       if (vert.has_mismatching(scene, *uplifting)) {
-        // Vertex data supports metamer mismatching;
-        // then, if the builder is not converged, generate new samples
-        if (m_did_sample = !is_converged(); m_did_sample) {
-          auto new_samples = vert.realize_mismatch(scene, *uplifting, m_samples_curr, n_uplifting_mismatch_samples_iter);
-          insert_samples(new_samples);
-        }
+        // Vertex data supports metamer mismatching; pick up samples generated
+        // by a completed job, then, if the builder is not converged, request the next job
+        m_did_sample   = poll();
+        m_wants_submit = !m_is_pending && !is_converged();
       } else {
-        // Vertex data does not support metamer mismatching; 
-        // clear internal state entirely as the builder should play dead
-        hull = { };
-        m_samples.clear();
-        m_samples_curr = 0;
-        m_samples_prev = 0;
-        m_did_sample   = true;
+        // Vertex data does not support metamer mismatching; clear internal state entirely as
+        // the builder should play dead. Skip this if nothing is left to clear, as a reset also
+        // invalidates the mailbox, which would otherwise happen on every frame
+        m_did_sample = m_is_pending || !m_samples.empty() || m_sequence_i > 0;
+        if (m_did_sample)
+          reset();
       }
 
       // Next, deal with generating a spectral output
@@ -530,8 +726,16 @@ namespace met {
       } else {
         // Fallback; let a solver handle the constraint, potentially
         // outputting a metamer that does not satisfy all constraints. Either
-        // there are no constraints, or the constraints conflict somehow
-        return vert.realize(scene, *uplifting);
+        // there are no constraints, or the constraints conflict somehow.
+        // As this is costly, the output is reused until the solve's inputs change
+        eig::Array3u csys = { uplifting->basis_i, uplifting->observer_i, uplifting->illuminant_i };
+        m_did_solve = !m_solve_cache
+          || scene.resources.bases || scene.resources.observers || scene.resources.illuminants
+          || !(m_solve_cache->csys == csys).all()
+          || !(m_solve_cache->cnstr == vert.constraint);
+        if (m_did_solve)
+          m_solve_cache = { .cnstr = vert.constraint, .csys = csys, .sample = vert.realize(scene, *uplifting) };
+        return m_solve_cache->sample;
       }
     }
 
@@ -556,20 +760,48 @@ namespace met {
       m_cnstr_cache  = uplifting->verts[vertex_i].constraint;
       m_samples_prev = m_samples.size();
       m_samples_curr = 0;
+      m_sequence_i   = 0;
       m_did_sample   = true;
+      m_is_exact     = false;
+
+      // Invalidate in-flight jobs, which sample the prior constraint's volume
+      invalidate();
     }
 
-    SceneGLHandler<met::Uplifting>::UpliftingData::UpliftingData(uint uplifting_i)
-    : m_uplifting_i(uplifting_i), m_is_first_update(true) {
+    void SceneGLHandler<met::Uplifting>::SolveScheduler::dispatch(const Scene              &scene, 
+                                                                  std::span<UpliftingData>  uplifting_data, 
+                                                                  WorkerPool               &pool) {
       met_trace();
 
-      // Instantiate mapped buffer objects; these'll hold packed barycentric and spectral coefficient
-      // data, which is used by ObjectData::update below to bake spectral textures per object
-      std::tie(buffer_bary, m_buffer_bary_map) = gl::Buffer::make_flusheable_object<BufferBaryLayout>();
-      std::tie(buffer_coef, m_buffer_coef_map) = gl::Buffer::make_flusheable_object<BufferCoefLayout>();
+      // Gather builders awaiting a job
+      std::vector<BudgetScheduler::Request> requests;
+      for (uint i = 0; i < uplifting_data.size(); ++i) {
+        const auto &uplifting = scene.components.upliftings[i];
+        for (uint j = 0; j < uplifting_data[i].metamer_builders.size(); ++j) {
+          auto &builder = uplifting_data[i].metamer_builders[j];
+          guard_continue(builder.wants_submit() && j < uplifting->verts.size());
+          requests.push_back({
+            .sample_cost = builder.sample_cost(),
+            .last_served = builder.last_served(),
+            .is_edited   = j < uplifting.state.verts.size() && uplifting.state.verts[j],
+            .submit      = [&pool, &scene, &builder = builder, &uplifting = uplifting, j](uint n, uint frame) {
+              builder.submit(pool, scene, *uplifting, uplifting->verts[j], n);
+              builder.m_last_served = frame;
+            }
+          });
+        }
+      }
+
+      // Size and submit jobs within the frame budget
+      m_scheduler.dispatch(requests, { .budget = scene.components.settings->solve_budget,
+                                       .n_min  = n_uplifting_mismatch_samples_iter_min,
+                                       .n_max  = n_uplifting_mismatch_samples_iter_max });
     }
 
-    void SceneGLHandler<met::Uplifting>::UpliftingData::update(const Scene &scene) {
+    SceneGLHandler<met::Uplifting>::UpliftingData::UpliftingData(uint uplifting_i)
+    : m_uplifting_i(uplifting_i), m_is_first_update(true) { }
+
+    bool SceneGLHandler<met::Uplifting>::UpliftingData::update_cache(const Scene &scene, WorkerPool &pool) {
       met_trace();
 
       // Get handles to uplifting and linked resources
@@ -598,7 +830,9 @@ namespace met {
 
       // Step 1; generate a color system boundary; spectra, coefficients, and colors
       if (is_color_system_stale) {
-        boundary = uplifting->sample_color_solid(scene, 4, n_uplifting_boundary_samples);
+        auto solid    = uplifting->sample_color_solid(scene, 4, n_uplifting_boundary_samples);
+        boundary      = solid->samples;
+        boundary_hull = solid->hull;
         fmt::print("Uplifting {}: sampled {} color system boundary points\n", m_uplifting_i, boundary.size());
       }
 
@@ -609,14 +843,17 @@ namespace met {
         // Ensure the right data is present
         metamer_builders.resize(uplifting->verts.size());
         interior.resize(uplifting->verts.size());
+        n_solves = 0;
 
         // Iterate interior vertioces
         for (int i = 0; i < uplifting->verts.size(); ++i) {
           auto &builder = metamer_builders[i];
 
-          // Test if the builder is due for a reset; either the color system changed, or the
-          // vertex did in some important way
-          if (is_color_system_stale || !builder.supports_vertex(scene, m_uplifting_i, i))
+          // Test if the builder is due for a reset; either the color system or solver layout
+          // changed, or the vertex did in some important way
+          if (is_color_system_stale 
+            || scene.components.settings.state.solve_layout 
+            || !builder.supports_vertex(scene, m_uplifting_i, i))
             builder.set_vertex(scene, m_uplifting_i, i);
 
           // If the builder has already converged, or the vertex wasn't even touched; exit early
@@ -624,7 +861,9 @@ namespace met {
           is_spectrum_stale = true;
 
           // Generate a new sample from the builder
-          auto new_sample = builder.realize(scene, m_uplifting_i, i);
+          auto new_sample = builder.realize(pool, scene, m_uplifting_i, i);
+          if (builder.did_solve())
+            n_solves++;
 
           // Check if the color output of this sample is different from the previous sample;
           // if so, we denote the tessellation as stale
@@ -642,10 +881,30 @@ namespace met {
       if (is_tessellation_stale) {
         auto points = boundary_and_interior | vws::transform(&MismatchSample::colr) | view_to<std::vector<Colr>>();
         tessellation = generate_delaunay<AlDelaunay, Colr>(points);
+        tessellation_locator = TetrahedronLocator(tessellation);
+      }
+
+      // Finally; set state to false
+      m_is_first_update = false;
+
+      return is_color_system_stale || is_tessellation_stale || is_spectrum_stale;
+    }
+
+    void SceneGLHandler<met::Uplifting>::UpliftingData::update(const Scene &scene, WorkerPool &pool) {
+      met_trace();
+
+      // Instantiate mapped buffer objects on first use; these'll hold packed barycentric and spectral 
+      // coefficient data, which is used by ObjectData::update below to bake spectral textures per object
+      if (!buffer_bary.is_init()) {
+        std::tie(buffer_bary, m_buffer_bary_map) = gl::Buffer::make_flusheable_object<BufferBaryLayout>();
+        std::tie(buffer_coef, m_buffer_coef_map) = gl::Buffer::make_flusheable_object<BufferCoefLayout>();
       }
 
+      // Steps 1-3; update cpu-side spectral data and tessellation
+      bool is_stale = update_cache(scene, pool);
+
       // Step 4; update GL-side packed data for ObjectData::update() to use later on
-      if (is_color_system_stale || is_tessellation_stale || is_spectrum_stale) {
+      if (is_stale) {
         // Updated buffer size values to the nr. of tetrahedra
         m_buffer_bary_map->size = tessellation.elems.size();
         
@@ -680,44 +939,22 @@ namespace met {
         buffer_bary.flush();
         buffer_coef.flush();
       }
-
-      // Finally; set state to false
-      m_is_first_update = false;
     }
 
     std::pair<eig::Vector4f, uint> SceneGLHandler<met::Uplifting>::UpliftingData::find_enclosing_tetrahedron(const eig::Vector3f &p) const {
       met_trace();
       
-      // Search data, initial value
-      float result_err = std::numeric_limits<float>::max();
-      uint  result_i = 0;
-      auto  result_bary = eig::Vector4f(0.f);
-
-      // Search tetrahedron with all positive barycentric weights
-      for (uint i = 0; i < tessellation.elems.size(); ++i) {
-        // Unpack matrix data from mapped buffer; not ideal exactly
-        auto block = m_buffer_bary_map->data[i];
-        auto inv   = block.inv.block<3, 3>(0, 0).eval();
-        auto sub   = block.sub.head<3>().eval();
-
-        // Compute barycentric weights using packed element data
-        eig::Vector3f xyz  = (inv * (p.array() - sub.array()).matrix()).eval();
-        eig::Vector4f bary = (eig::Array4f() << xyz, 1.f - xyz.sum()).finished();
-
-        // Compute squared error of potentially unbounded barycentric weights
-        float err = (bary - bary.cwiseMax(0.f).cwiseMin(1.f)).matrix().squaredNorm();
-
-        // Continue if error does not improve
-        // or store best result
-        if (err > result_err)
-          continue;
-        result_err  = err;
-        result_bary = bary;
-        result_i    = i;
-      }
+      // Search tetrahedron with all positive barycentric weights, or the closest one
+      auto [bary, i] = tessellation_locator.locate(p);
+      debug::check_expr(i < tessellation.elems.size());
+      return { bary.matrix(), i };
+    }
 
-      debug::check_expr(result_i < tessellation.elems.size());
-      return { result_bary, result_i };
+    std::vector<std::pair<eig::Vector4f, uint>> SceneGLHandler<met::Uplifting>::UpliftingData::find_enclosing_tetrahedron(std::span<const Colr> p) const {
+      met_trace();
+      return tessellation_locator.locate(p)
+           | vws::transform([](const auto &r) { return std::pair { r.first.matrix().eval(), r.second }; })
+           | view_to<std::vector<std::pair<eig::Vector4f, uint>>>();
     }
 
     SceneGLHandler<met::Uplifting>::ObjectData::ObjectData(const Scene &scene, uint object_i)
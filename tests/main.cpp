@@ -0,0 +1,42 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <test.hpp>
+#include <cstdlib>
+#include <exception>
+
+// Runs all test cases registered in the current executable; returns nonzero if any check failed
+int main() {
+  using namespace met;
+  using namespace met::test;
+
+  uint n_failed = 0;
+  for (const auto &test_case : test_cases()) {
+    fmt::print("{}\n", test_case.name);
+    test_failures() = 0;
+    try {
+      test_case.func();
+    } catch (const std::exception &e) {
+      fmt::print(stderr, "  exception: {}\n", e.what());
+      test_failures()++;
+    }
+    if (test_failures() > 0)
+      n_failed++;
+  }
+
+  fmt::print("{} of {} test cases passed\n", test_cases().size() - n_failed, test_cases().size());
+  return n_failed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
\ No newline at end of file
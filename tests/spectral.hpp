@@ -0,0 +1,52 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <metameric/core/io.hpp>
+#include <metameric/core/spectrum.hpp>
+#include <cmath>
+
+namespace met::test {
+  // Spectral basis as loaded by the scene; tests run from the binary directory, next to data/
+  inline const Basis &test_basis() {
+    static Basis basis = io::load_basis("data/basis_262144.txt");
+    return basis;
+  }
+
+  // Color systems used across tests; CIE XYZ under D65, FL11 and FL2
+  inline ColrSystem test_csys(uint i) {
+    std::array<const Spec *, 3> illuminants = { &models::emitter_cie_d65, 
+                                                &models::emitter_cie_fl11, 
+                                                &models::emitter_cie_fl2 };
+    return { .cmfs = models::cmfs_cie_xyz, .illuminant = *illuminants[i % 3] };
+  }
+
+  // Smooth, seeded reflectance that lies within the basis' span and within [0, 1], 
+  // s.t. its color is feasible for any system, and metamers of it exist
+  inline Spec test_reflectance(uint seed) {
+    const auto &basis = test_basis();
+    float a = .5f + .25f * static_cast<float>(seed % 5), 
+          b = .3f * static_cast<float>(seed % 7);
+    Spec s;
+    for (uint i = 0; i < wavelength_samples; ++i)
+      s[i] = .5f + .35f * std::sin(a * static_cast<float>(i) * .1f + b);
+    
+    // Fit in basis, and scale down, s.t. the fit stays inside [0, 1]
+    Basis::vec_type c = (basis.func.transpose() * basis.func).ldlt().solve(basis.func.transpose() * s.matrix());
+    return (basis.func * (.2f * c)).array().eval();
+  }
+} // namespace met::test
\ No newline at end of file
@@ -0,0 +1,65 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <metameric/core/utility.hpp>
+#include <source_location>
+#include <string_view>
+#include <vector>
+
+namespace met::test {
+  // Registered test case; test files declare these through met_test_case(name)
+  struct TestCase {
+    std::string_view name;
+    void           (*func)();
+  };
+
+  // Global list of registered test cases, run in order of registration by main()
+  inline std::vector<TestCase> &test_cases() {
+    static std::vector<TestCase> cases;
+    return cases;
+  }
+
+  // Nr. of failed checks in the currently running test case
+  inline uint &test_failures() {
+    static uint failures = 0;
+    return failures;
+  }
+
+  struct TestRegistrar {
+    TestRegistrar(std::string_view name, void (*func)()) {
+      test_cases().push_back({ name, func });
+    }
+  };
+
+  // Record a failed check, without aborting the test case
+  inline void check(bool expr, std::string_view expr_str, 
+                    std::source_location sl = std::source_location::current()) {
+    guard(!expr);
+    fmt::print(stderr, "  {}({}): check failed: {}\n", sl.file_name(), sl.line(), expr_str);
+    test_failures()++;
+  }
+} // namespace met::test
+
+// Declare and register a test case
+#define met_test_case(name)                                                    \
+  static void name();                                                          \
+  static met::test::TestRegistrar name##_registrar(#name, name);               \
+  static void name()
+
+// Check an expression, printing it and its location on failure
+#define met_test_check(expr) met::test::check(static_cast<bool>(expr), #expr)
\ No newline at end of file
@@ -0,0 +1,125 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <metameric/core/detail/metamer.hpp>
+#include <metameric/core/distribution.hpp>
+#include <spectral.hpp>
+#include <test.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace met {
+  namespace detail {
+    constexpr uint n_boundary = 2 * wavelength_samples;
+    using boundary_vec = eig::Vector<double, wavelength_bases>;
+    using boundary_out = eig::Vector<double, n_boundary>;
+    using boundary_jac = eig::Matrix<double, wavelength_bases, n_boundary>;
+
+    // The prior boundary constraint, a generic product with [B; -B] offset by [1, 0]
+    auto boundary_func_dot_v(const Basis &basis) {
+      auto A = (eig::Matrix<float, n_boundary, wavelength_bases>() << basis.func, -basis.func).finished();
+      auto b = (eig::Array<float, n_boundary, 1>() << Spec(1.f), Spec(0.f)).finished();
+      return opt::func_dot_v<wavelength_bases>(A, b);
+    }
+
+    // Evaluate a constraint as opt::TypedWrapper's trampoline would; g is skipped if null
+    void eval_boundary(const auto &f, const boundary_vec &x, boundary_out &r, boundary_jac *g) {
+      f(eig::Map<eig::VectorXd>(r.data(), n_boundary), 
+        eig::Map<const boundary_vec>(x.data()),
+        eig::Map<eig::Matrix<double, wavelength_bases, -1>>(g ? g->data() : nullptr, wavelength_bases, n_boundary));
+    }
+
+    // Random coefficients; Bx falls both in and outside [0, 1]. The float samples are perturbed
+    // to full double precision, as products with the float basis would otherwise be exact
+    std::vector<boundary_vec> gen_boundary_coefs(uint n, uint seed) {
+      UniformSampler<PCGEngine> sampler(-2.f, 2.f, seed);
+      std::vector<boundary_vec> xs(n);
+      for (auto &x : xs) {
+        x = sampler.template next_nd<wavelength_bases>().matrix().cast<double>();
+        x += 1e-3 * sampler.template next_nd<wavelength_bases>().matrix().cast<double>() / 3.0;
+      }
+      return xs;
+    }
+  } // namespace detail
+
+  // The boundary kernel, through Eigen and through AVX2 if supported, must reproduce the values
+  // and Jacobians of the prior generic constraint
+  met_test_case(boundary_matches_func_dot_v) {
+    const auto &basis = test::test_basis();
+    auto f_ref = detail::boundary_func_dot_v(basis);
+    auto cstr  = detail::boundary_constraint(basis, 1e-2);
+    met_test_check(cstr.n == detail::n_boundary);
+    
+    std::vector<bool> isas = { false };
+    if (detail::boundary_supports_avx2())
+      isas.push_back(true);
+    fmt::print("  avx2 kernel {}\n", detail::boundary_supports_avx2() ? "supported" : "not supported");
+
+    for (bool is_avx2 : isas) {
+      auto f = cstr.f;
+      f.is_avx2 = is_avx2;
+      
+      double err_r = 0.0, err_g = 0.0;
+      for (const auto &x : detail::gen_boundary_coefs(1000, 4)) {
+        detail::boundary_out r_ref, r, r_no_g;
+        detail::boundary_jac g_ref, g;
+        detail::eval_boundary(f_ref, x, r_ref, &g_ref);
+        detail::eval_boundary(f, x, r, &g);
+        detail::eval_boundary(f, x, r_no_g, nullptr);
+        err_r = std::max({ err_r, (r - r_ref).lpNorm<eig::Infinity>(), (r_no_g - r_ref).lpNorm<eig::Infinity>() });
+        err_g = std::max(err_g, (g - g_ref).lpNorm<eig::Infinity>());
+      }
+
+      fmt::print("  {}: max. value error {:.1e}, max. jacobian error {:.1e}\n", is_avx2 ? "avx2" : "eigen", err_r, err_g);
+      met_test_check(err_r <= 1e-12);
+      met_test_check(err_g == 0.0);
+    }
+  }
+
+  // Time per evaluation of value and Jacobian, for the prior constraint and both kernel paths
+  met_test_case(boundary_timing) {
+    using clock = std::chrono::steady_clock;
+    constexpr uint n_reps = 64;
+
+    const auto &basis = test::test_basis();
+    auto xs   = detail::gen_boundary_coefs(1024, 8);
+    auto time = [&](const auto &f) {
+      detail::boundary_out r;
+      detail::boundary_jac g;
+      double checksum = 0.0;
+      auto start = clock::now();
+      for (uint i = 0; i < n_reps; ++i) {
+        for (const auto &x : xs) {
+          detail::eval_boundary(f, x, r, &g);
+          checksum += r[0];
+        }
+      }
+      auto ns = std::chrono::duration<double, std::nano>(clock::now() - start).count() / (n_reps * xs.size());
+      met_test_check(std::isfinite(checksum));
+      return ns;
+    };
+
+    auto f = detail::boundary_constraint(basis, 1e-2).f;
+    f.is_avx2 = false;
+    double t_ref = time(detail::boundary_func_dot_v(basis)), t_eigen = time(f);
+    fmt::print("  func_dot_v {:.0f} ns, eigen {:.0f} ns", t_ref, t_eigen);
+    if (detail::boundary_supports_avx2()) {
+      f.is_avx2 = true;
+      fmt::print(", avx2 {:.0f} ns", time(f));
+    }
+    fmt::print(" per evaluation\n");
+  }
+} // namespace met
\ No newline at end of file
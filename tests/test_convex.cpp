@@ -0,0 +1,151 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <metameric/core/convex.hpp>
+#include <metameric/core/distribution.hpp>
+#include <metameric/core/mesh.hpp>
+#include <metameric/core/ranges.hpp>
+#include <test.hpp>
+#include <volume.hpp>
+#include <chrono>
+#include <cmath>
+
+namespace met {
+  namespace detail {
+    // Test point sets; surface of an ellipsoid, uniform in a cube, and heavily duplicated cube corners
+    std::vector<eig::Array3f> gen_points(uint type, uint n, uint seed) {
+      UniformSampler<PCGEngine> sampler(seed);
+      std::vector<eig::Array3f> points(n);
+      for (auto &p : points) {
+        eig::Array3f v = sampler.next_nd<3>() * 2.f - 1.f;
+        if (type == 0)
+          p = v.matrix().normalized().array() * eig::Array3f(.3f, .1f, .05f) + .5f;
+        else if (type == 1)
+          p = v * .2f;
+        else
+          p = v.sign() * .1f + .5f;
+      }
+      return points;
+    }
+  } // namespace detail
+
+  // Insert points in batches, as the uplifting's mismatch sampling does, and compare the hull and 
+  // tesselation after each batch against a full qhull rebuild over all points so far
+  met_test_case(incremental_hull_matches_qhull) {
+    constexpr uint n_batches = 12, batch_size = 64;
+    for (uint type = 0; type < 3; ++type) {
+      auto points = detail::gen_points(type, n_batches * batch_size, type + 1);
+
+      IncrementalConvexHull incr;
+      for (uint i = 0; i < n_batches; ++i) {
+        auto batch = std::span(points).subspan(i * batch_size, batch_size);
+        auto prior = std::span(points).first((i + 1) * batch_size);
+        incr.insert(batch);
+
+        ConvexHull full = {{ .data = prior }};
+        met_test_check(incr.has_hull() && incr.has_delaunay());
+        met_test_check(full.has_hull() && full.has_delaunay());
+
+        // Hull and tesselation enclose the same volume as qhull's output
+        double v_full = test::hull_volume(full.hull);
+        met_test_check(std::abs(test::hull_volume(incr.hull) - v_full) <= 1e-4 * v_full);
+        met_test_check(std::abs(test::deln_volume(incr.deln) - v_full) <= 1e-4 * v_full);
+        
+        // Every qhull hull vertex lies on or inside the incremental hull, and vice versa
+        for (const auto &p : full.hull.verts)
+          met_test_check(test::is_enclosed(incr.hull, p));
+        for (const auto &p : incr.hull.verts)
+          met_test_check(test::is_enclosed(full.hull, p));
+      } // for (uint i)
+    } // for (uint type)
+  }
+
+  // The locator is appended to per batch; its queries must agree with a locator built from scratch
+  met_test_case(incremental_locator_matches_rebuild) {
+    constexpr uint n_batches = 12, batch_size = 64, n_queries = 256;
+    auto points  = detail::gen_points(1, n_batches * batch_size, 7);
+    auto queries = detail::gen_points(1, n_queries, 8);
+    
+    IncrementalConvexHull incr;
+    for (uint i = 0; i < n_batches; ++i) {
+      incr.insert(std::span(points).subspan(i * batch_size, batch_size));
+      TetrahedronLocator full(incr.deln);
+      for (const auto &q : queries) {
+        auto [bry_incr, elem_incr] = incr.locator.locate(q.matrix());
+        auto [bry_full, elem_full] = full.locate(q.matrix());
+        
+        // Elements may differ for points on shared faces, but both must reproduce q equally well
+        auto error = [&](const eig::Array4f &bry, uint i) {
+          eig::Array3f p = eig::Array3f::Zero();
+          for (uint k = 0; k < 4; ++k)
+            p += bry[k] * incr.deln.verts[incr.deln.elems[i][k]];
+          float outside = (bry - bry.cwiseMax(0.f)).matrix().norm();
+          return (p - q).matrix().norm() + outside;
+        };
+        met_test_check(std::abs(error(bry_incr, elem_incr) - error(bry_full, elem_full)) <= 1e-4f);
+      } // for (q)
+    } // for (uint i)
+  }
+  // Delaunay element indices must refer to the input points they were generated from; duplicated
+  // points exercise the coordinate lookup for vertices whose point id is not an input index
+  met_test_case(delaunay_indices_match_input) {
+    for (uint type = 0; type < 3; ++type) {
+      auto points = detail::gen_points(type, 256, type + 11);
+      points.insert(points.end(), points.begin(), points.begin() + 64);
+      
+      auto deln = generate_delaunay<Delaunay, eig::Array3f>(points);
+      met_test_check(deln.verts.size() == points.size());
+      met_test_check(rng::all_of(deln.elems, [&](const auto &el) { return (el < points.size()).all(); }));
+      guard_continue(rng::all_of(deln.elems, [&](const auto &el) { return (el < points.size()).all(); }));
+      
+      // Tetrahedra over the indexed input points cover the points' convex hull
+      double v_hull = test::point_hull_volume(points);
+      met_test_check(std::abs(test::deln_volume(deln) - v_hull) <= 1e-4 * v_hull);
+
+      // No input point lies strictly inside the circumsphere of a non-degenerate tetrahedron
+      uint n_violations = 0;
+      for (const auto &el : deln.elems) {
+        eig::Vector3d a = points[el[0]].matrix().cast<double>();
+        eig::Matrix3d A;
+        eig::Vector3d b;
+        for (uint k = 0; k < 3; ++k) {
+          eig::Vector3d v = points[el[k + 1]].matrix().cast<double>();
+          A.row(k) = 2.0 * (v - a);
+          b[k]     = v.squaredNorm() - a.squaredNorm();
+        }
+        guard_continue(std::abs(A.determinant()) > 1e-12);
+        eig::Vector3d c = A.partialPivLu().solve(b);
+        double r2 = (a - c).squaredNorm();
+        for (const auto &p : points)
+          if ((p.matrix().cast<double>() - c).squaredNorm() < r2 * (1.0 - 1e-6))
+            n_violations++;
+      } // for (el)
+      met_test_check(n_violations == 0);
+    } // for (uint type)
+  }
+
+  met_test_case(delaunay_timing) {
+    using clock = std::chrono::steady_clock;
+    for (uint n : { 1000u, 10000u, 100000u }) {
+      auto points = detail::gen_points(1, n, 31);
+      auto start  = clock::now();
+      auto deln   = generate_delaunay<Delaunay, eig::Array3f>(points);
+      auto ms     = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+      fmt::print("  {} points, {} elements; {:.1f} ms\n", n, deln.elems.size(), ms);
+      met_test_check(!deln.elems.empty());
+    }
+  }
+} // namespace met
\ No newline at end of file
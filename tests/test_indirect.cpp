@@ -0,0 +1,123 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <metameric/core/metamer.hpp>
+#include <spectral.hpp>
+#include <test.hpp>
+#include <cmath>
+
+namespace met {
+  namespace detail {
+    // Indirect spectrum setup; a reference reflectance's color under a direct system and under 
+    // a truncated interreflection series of a varying nr. of bounces, lit by a different 
+    // illuminant, must both be reproduced; the direct warm start then only satisfies the former
+    IndirectSpectrumInfo init_test_indirect(uint seed) {
+      auto r    = test::test_reflectance(seed);
+      auto csys = test::test_csys(seed);
+      
+      Spec illm = test::test_csys(seed + 1).illuminant;
+      illm /= illm.maxCoeff();
+      IndirectColrSystem isys = { .cmfs = models::cmfs_cie_xyz };
+      for (uint p = 0; p < 2 + seed % 3; ++p)
+        isys.powers.push_back(illm * std::pow(.6f, static_cast<float>(p + 1)));
+
+      return { .linear_constraints  = {{ csys, csys.apply(r) }},
+               .nlinear_constraints = {{ isys, isys.apply(r) }},
+               .basis               = test::test_basis() };
+    }
+
+    // Largest color error over all constraints, for given coefficients
+    float indirect_residual(const IndirectSpectrumInfo &info, const Basis::vec_type &coef) {
+      Spec  s   = info.basis(coef);
+      float err = 0.f;
+      for (const auto &[csys, colr] : info.linear_constraints)
+        err = std::max(err, (csys.apply(s) - colr).matrix().norm());
+      for (const auto &[csys, colr] : info.nlinear_constraints)
+        err = std::max(err, (csys.apply(s) - colr).matrix().norm());
+      return err;
+    }
+  } // namespace detail
+
+  // Levenberg-Marquardt must converge on feasible problems, reproducing all constraint colors
+  // within a few iterations, without taking the fallback
+  met_test_case(indirect_lm_converges) {
+    for (uint seed = 0; seed < 8; ++seed) {
+      IndirectSpectrumStats stats;
+      auto info  = detail::init_test_indirect(seed);
+      info.stats = &stats;
+      auto coef  = solve_spectrum_coef(info);
+      auto err   = detail::indirect_residual(info, coef);
+
+      fmt::print("  seed {}: residual {:.2e}, {} iterations\n", seed, err, stats.n_iters);
+      met_test_check(stats.status == IndirectSpectrumStats::Status::eConverged);
+      met_test_check(!stats.is_fallback);
+      met_test_check(stats.n_iters < info.max_iters);
+      met_test_check(err <= 1e-3f);
+      met_test_check(((info.basis(coef) >= -1e-3f) && (info.basis(coef) <= 1.f + 1e-3f)).all());
+    }
+  }
+
+  // Levenberg-Marquardt replaces SLSQP for this problem; its residuals must be at least as small
+  met_test_case(indirect_lm_matches_nlopt) {
+    for (uint seed = 0; seed < 8; ++seed) {
+      IndirectSpectrumStats stats_lm, stats_nlopt;
+      auto info = detail::init_test_indirect(seed);
+      
+      info.stats   = &stats_lm;
+      info.backend = IndirectSpectrumInfo::Backend::eLM;
+      auto err_lm  = detail::indirect_residual(info, solve_spectrum_coef(info));
+      
+      info.stats     = &stats_nlopt;
+      info.backend   = IndirectSpectrumInfo::Backend::eNLopt;
+      auto err_nlopt = detail::indirect_residual(info, solve_spectrum_coef(info));
+
+      fmt::print("  seed {}: lm residual {:.2e} in {} iterations, nlopt residual {:.2e} in {} evaluations\n", 
+        seed, err_lm, stats_lm.n_iters, err_nlopt, stats_nlopt.n_iters);
+      met_test_check(err_lm <= err_nlopt + 1e-4f);
+      met_test_check(err_nlopt <= 1e-2f);
+    }
+  }
+
+  // If iterations run out, the status says so, and SLSQP continues from the LM result
+  met_test_case(indirect_lm_falls_back) {
+    IndirectSpectrumStats stats;
+    auto info      = detail::init_test_indirect(2);
+    info.stats     = &stats;
+    info.max_iters = 1;
+    auto err = detail::indirect_residual(info, solve_spectrum_coef(info));
+
+    fmt::print("  residual {:.2e} after fallback\n", err);
+    met_test_check(stats.status == IndirectSpectrumStats::Status::eMaxIters);
+    met_test_check(stats.n_iters == 1);
+    met_test_check(stats.is_fallback);
+    met_test_check(err <= 1e-2f);
+  }
+  // A target outside the reachable set leaves a large residual at the LM fixed point; a vanishing 
+  // gradient or box-clamped step there must not be reported as convergence, s.t. SLSQP is tried
+  met_test_case(indirect_lm_unreachable_not_converged) {
+    for (uint seed = 0; seed < 4; ++seed) {
+      IndirectSpectrumStats stats;
+      auto info  = detail::init_test_indirect(seed);
+      info.stats = &stats;
+      info.nlinear_constraints[0].second *= 20.f;
+      auto err = detail::indirect_residual(info, solve_spectrum_coef(info));
+
+      fmt::print("  seed {}: residual {:.2e}, {} iterations\n", seed, err, stats.n_iters);
+      met_test_check(err > 1e-2f);
+      met_test_check(stats.status != IndirectSpectrumStats::Status::eConverged);
+    }
+  }
+} // namespace met
\ No newline at end of file
@@ -0,0 +1,160 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <metameric/core/metamer.hpp>
+#include <metameric/core/ranges.hpp>
+#include <spectral.hpp>
+#include <test.hpp>
+#include <volume.hpp>
+#include <chrono>
+
+namespace met {
+  namespace detail {
+    // Reduced layout in which the cpu-side solvers are additionally instantiated
+    constexpr uint ps = preview_wavelength_samples, pb = preview_wavelength_bases;
+    using PreviewBasis = BasisBase<ps, pb>;
+
+    inline const PreviewBasis &test_preview_basis() {
+      static PreviewBasis basis = resample_basis<ps, pb>(test::test_basis());
+      return basis;
+    }
+
+    // Direct mismatch volume setup in a given layout, as in test_mismatch.cpp; color systems and
+    // the reference reflectance are resampled from the full layout
+    template <uint Samples, uint Bases>
+    DirectMismatchSolidInfoBase<Samples, Bases> init_layout_mismatch(const BasisBase<Samples, Bases> &basis, 
+                                                                     uint seed, uint n_samples) {
+      auto csys_i = resample_csys<Samples>(test::test_csys(seed)), 
+           csys_j = resample_csys<Samples>(test::test_csys(seed + 1));
+      auto r      = resample_spectrum<Samples>(test::test_reflectance(seed));
+      return { .linear_objectives  = { csys_i, csys_j },
+               .linear_constraints = {{ csys_i, csys_i.apply(r) }},
+               .basis              = basis,
+               .n_samples          = n_samples };
+    }
+
+    std::vector<Colr> layout_colrs(const auto &samples) {
+      return samples | vws::transform([](const auto &s) { return s.colr; }) | view_to<std::vector<Colr>>();
+    }
+
+    // Average wall-clock time of f in milliseconds, over n_reps runs
+    double time_ms(uint n_reps, auto &&f) {
+      using clock = std::chrono::steady_clock;
+      auto start = clock::now();
+      for (uint i = 0; i < n_reps; ++i)
+        f();
+      return std::chrono::duration<double, std::milli>(clock::now() - start).count() / n_reps;
+    }
+
+    // Time per solve of spectrum generation, sampled mismatch volumes, and color solid
+    // boundaries in a given layout
+    template <uint Samples, uint Bases>
+    std::array<double, 3> time_layout(const BasisBase<Samples, Bases> &basis, uint n_reps) {
+      auto mismatch = init_layout_mismatch(basis, 0, 256);
+      auto [csys, colr] = mismatch.linear_constraints[0];
+      DirectSpectrumInfoBase<Samples, Bases> spectrum = { .linear_constraints = {{ csys, colr }}, .basis = basis };
+      ColorSolidInfoBase<Samples, Bases>     solid    = { .direct_objective = csys, .basis = basis, .n_samples = 256 };
+
+      double checksum = 0.0;
+      std::array<double, 3> t = {
+        time_ms(n_reps, [&] { checksum += solve_spectrum_coef(spectrum).sum(); }),
+        time_ms(n_reps, [&] { checksum += solve_mismatch_solid(mismatch).size(); }),
+        time_ms(n_reps, [&] { checksum += solve_color_solid(solid).size(); })
+      };
+      met_test_check(std::isfinite(checksum));
+      return t;
+    }
+  } // namespace detail
+
+  // Resampling to the same layout must be an identity, and reducing the nr. of samples must
+  // preserve a spectrum's mean, as output bins average the input bins they cover
+  met_test_case(layout_resample_identity) {
+    const auto &basis = test::test_basis();
+    auto same = resample_basis<wavelength_samples, wavelength_bases>(basis);
+    met_test_check(same.func == basis.func);
+    met_test_check(same.mean.isApprox(basis.mean));
+
+    for (uint seed = 0; seed < 4; ++seed) {
+      auto r = test::test_reflectance(seed);
+      met_test_check(resample_spectrum<wavelength_samples>(r).isApprox(r));
+      auto r_p = resample_spectrum<detail::ps>(r);
+      met_test_check(std::abs(r_p.mean() - r.mean()) < 1e-5f);
+      met_test_check(r_p.minCoeff() >= r.minCoeff() - 1e-5f && r_p.maxCoeff() <= r.maxCoeff() + 1e-5f);
+    }
+  }
+
+  // Spectra solved in the preview layout must reproduce their constraints, and stay in [0, 1]
+  met_test_case(layout_preview_spectrum_meets_constraints) {
+    const auto &basis = detail::test_preview_basis();
+    for (uint seed = 0; seed < 8; ++seed) {
+      auto csys_i = resample_csys<detail::ps>(test::test_csys(seed)),
+           csys_j = resample_csys<detail::ps>(test::test_csys(seed + 1));
+      auto r      = resample_spectrum<detail::ps>(test::test_reflectance(seed));
+      DirectSpectrumInfoBase<detail::ps, detail::pb> info = {
+        .linear_constraints = {{ csys_i, csys_i.apply(r) }, { csys_j, csys_j.apply(r) }},
+        .basis              = basis
+      };
+      auto [s, c] = solve_spectrum(info);
+      for (const auto &[csys, colr] : info.linear_constraints)
+        met_test_check((csys.apply(s) - colr).abs().maxCoeff() < 1e-3f);
+      met_test_check(s.minCoeff() >= 0.f && s.maxCoeff() <= 1.f);
+    }
+  }
+
+  // Mismatch volumes solved in the preview layout, mapped back to the full layout, should 
+  // approximate the volume solved in the full layout
+  met_test_case(layout_preview_mismatch_approximates_full) {
+    const auto &basis   = test::test_basis();
+    const auto &basis_p = detail::test_preview_basis();
+    for (uint seed = 0; seed < 4; ++seed) {
+      auto info   = detail::init_layout_mismatch(basis, seed, 256);
+      auto info_p = detail::init_layout_mismatch(basis_p, seed, 256);
+
+      // Solve in both layouts; preview output is refit in the full basis and recolored
+      auto full   = solve_mismatch_solid(info);
+      auto mapped = resample_mismatch_samples(solve_mismatch_solid(info_p), basis_p, basis);
+      for (auto &sample : mapped)
+        sample.colr = info.linear_objectives.back()(sample.spec);
+      met_test_check(!mapped.empty());
+      guard_continue(!mapped.empty());
+
+      // Mapped spectra lie in the full basis and in [0, 1]
+      for (const auto &sample : mapped) {
+        met_test_check(sample.spec.isApprox(basis(sample.coef)));
+        met_test_check(sample.spec.minCoeff() >= 0.f && sample.spec.maxCoeff() <= 1.f);
+      }
+
+      auto v_full = test::point_hull_volume(detail::layout_colrs(full));
+      auto v_map  = test::point_hull_volume(detail::layout_colrs(mapped));
+      fmt::print("  seed {}: full volume {:.4e}, preview volume {:.4e}\n", seed, v_full, v_map);
+      met_test_check(v_full > 0.0 && v_map > 0.0);
+      met_test_check(std::abs(v_map - v_full) <= .5 * v_full);
+    }
+  }
+
+  // Time per solve in the full and the preview layout, for spectrum generation, sampled 
+  // mismatch volumes, and color solid boundaries
+  met_test_case(layout_timing) {
+    const auto &basis   = test::test_basis();
+    const auto &basis_p = detail::test_preview_basis();
+    constexpr uint n_reps = 16;
+
+    auto t_full = detail::time_layout(basis, n_reps), t_prev = detail::time_layout(basis_p, n_reps);
+    std::array<std::string, 3> names = { "spectrum", "mismatch", "color solid" };
+    for (uint i = 0; i < names.size(); ++i)
+      fmt::print("  {:<12} {}/{}: {:.3f} ms, {}/{}: {:.3f} ms ({:.1f}x)\n", names[i], 
+        wavelength_samples, wavelength_bases, t_full[i], detail::ps, detail::pb, t_prev[i], t_full[i] / t_prev[i]);
+  }
+} // namespace met
\ No newline at end of file
@@ -0,0 +1,116 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <metameric/core/convex.hpp>
+#include <metameric/core/distribution.hpp>
+#include <metameric/core/locate.hpp>
+#include <metameric/core/mesh.hpp>
+#include <test.hpp>
+#include <chrono>
+
+namespace met {
+  namespace detail {
+    // Test point sets; uniform in a cube, or clustered in a thin shell around an ellipsoid
+    std::vector<eig::Array3f> gen_locate_points(uint type, uint n, uint seed) {
+      UniformSampler<PCGEngine> sampler(seed);
+      std::vector<eig::Array3f> points(n);
+      for (auto &p : points) {
+        eig::Array3f v = sampler.next_nd<3>() * 2.f - 1.f;
+        if (type == 0)
+          p = v * .2f + .5f;
+        else
+          p = v.matrix().normalized().array() * (.9f + .1f * sampler.next_1d()) * eig::Array3f(.3f, .1f, .05f) + .5f;
+      }
+      return points;
+    }
+
+    // Barycentric error of p w.r.t. element i, in double precision; zero for enclosing elements
+    double locate_error(const Delaunay &deln, uint i, const eig::Array3f &p) {
+      eig::Matrix3d m;
+      eig::Vector3d d = deln.verts[deln.elems[i][3]].matrix().cast<double>();
+      for (uint k = 0; k < 3; ++k)
+        m.col(k) = deln.verts[deln.elems[i][k]].matrix().cast<double>() - d;
+      eig::Vector3d xyz = m.inverse() * (p.matrix().cast<double>() - d);
+      eig::Array4d  bry = (eig::Array4d() << xyz, 1.0 - xyz.sum()).finished();
+      return (bry - bry.cwiseMax(0.0).cwiseMin(1.0)).matrix().squaredNorm();
+    }
+
+    // Reference point location; linear scan for the element of least barycentric error
+    std::pair<double, uint> locate_linear(const Delaunay &deln, const eig::Array3f &p) {
+      std::pair<double, uint> best = { std::numeric_limits<double>::max(), 0 };
+      for (uint i = 0; i < deln.elems.size(); ++i)
+        if (double err = locate_error(deln, i, p); err < best.first)
+          best = { err, i };
+      return best;
+    }
+  } // namespace detail
+
+  // The locator's jump-and-walk must find an element as good as a linear scan over all elements,
+  // for interior points as well as exterior points, which take the fallback scan
+  met_test_case(locator_matches_linear_scan) {
+    constexpr uint n_points = 2048, n_queries = 512;
+    for (uint type = 0; type < 2; ++type) {
+      auto points  = detail::gen_locate_points(type, n_points, type + 1);
+      auto queries = detail::gen_locate_points(type, n_queries, type + 11);
+      for (uint j = 0; j < n_queries; j += 4) // Push some queries outside the hull
+        queries[j] = (queries[j] - .5f) * 1.1f + .5f;
+      
+      ConvexHull hull = {{ .data = points, .options = ConvexHull::CreateInfo::BuildOptions::eDelaunay }};
+      met_test_check(hull.has_delaunay());
+      guard_continue(hull.has_delaunay());
+
+      TetrahedronLocator locator(hull.deln);
+      uint n_exterior = 0;
+      for (const auto &q : queries) {
+        auto [bry, i]    = locator.locate(q.matrix());
+        auto [err_ref, _] = detail::locate_linear(hull.deln, q);
+        met_test_check(i < hull.deln.elems.size());
+        met_test_check(detail::locate_error(hull.deln, i, q) <= err_ref + 1e-8);
+        if (err_ref > 0.0)
+          n_exterior++;
+      } // for (q)
+      fmt::print("  type {}: {} elements, {} of {} queries exterior\n", 
+        type, hull.deln.elems.size(), n_exterior, n_queries);
+    } // for (uint type)
+  }
+
+  // Timing of the locator against a linear scan, at a tesselation size seen in dense mismatch volumes
+  met_test_case(locator_timing) {
+    constexpr uint n_points = 10000, n_queries = 1000;
+    auto points  = detail::gen_locate_points(0, n_points, 21);
+    auto queries = detail::gen_locate_points(0, n_queries, 22);
+    ConvexHull hull = {{ .data = points, .options = ConvexHull::CreateInfo::BuildOptions::eDelaunay }};
+    met_test_check(hull.has_delaunay());
+    guard(hull.has_delaunay());
+
+    using clock = std::chrono::steady_clock;
+    auto time_build = clock::now();
+    TetrahedronLocator locator(hull.deln);
+    auto time_locate = clock::now();
+    auto located = locator.locate(std::span<const eig::Array3f>(queries));
+    auto time_linear = clock::now();
+    uint n_mismatch = 0;
+    for (uint j = 0; j < n_queries; ++j)
+      if (detail::locate_error(hull.deln, located[j].second, queries[j]) > detail::locate_linear(hull.deln, queries[j]).first + 1e-8)
+        n_mismatch++;
+    auto time_end = clock::now();
+    
+    auto ms = [](auto a, auto b) { return std::chrono::duration<double, std::milli>(b - a).count(); };
+    fmt::print("  {} elements, {} queries; build {:.2f} ms, locate {:.2f} ms, linear scan {:.2f} ms\n",
+      hull.deln.elems.size(), n_queries, ms(time_build, time_locate), ms(time_locate, time_linear), ms(time_linear, time_end));
+    met_test_check(n_mismatch == 0);
+  }
+} // namespace met
\ No newline at end of file
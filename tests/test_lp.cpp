@@ -0,0 +1,130 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <metameric/core/distribution.hpp>
+#include <metameric/core/lp.hpp>
+#include <metameric/core/ranges.hpp>
+#include <spectral.hpp>
+#include <test.hpp>
+#include <chrono>
+
+namespace met {
+  using LP = LPSolver<wavelength_bases>;
+
+  namespace detail {
+    // Boundary LP as solved for direct mismatch volumes; coefficients producing reflectances 
+    // in [0, 1], which reproduce the color of a reference reflectance in the given system
+    LP init_test_lp(const ColrSystem &csys, const Spec &r, bool mixed) {
+      const auto &basis = test::test_basis();
+      auto B = basis.func.cast<double>().eval();
+      auto S = csys.finalize(false).cast<double>().eval();
+      
+      constexpr uint n_nq = 2 * wavelength_samples + 2 * wavelength_bases;
+      LP::cmat      G(n_nq, wavelength_bases);
+      eig::VectorXd h(n_nq);
+      G << B, -B, eig::Matrix<double, wavelength_bases, wavelength_bases>::Identity(), 
+                 -eig::Matrix<double, wavelength_bases, wavelength_bases>::Identity();
+      h << eig::VectorXd::Ones(wavelength_samples), 
+           eig::VectorXd::Zero(wavelength_samples),
+           eig::VectorXd::Ones(2 * wavelength_bases);
+
+      return LP({ .C     = S.transpose() * B, 
+                  .d     = S.transpose() * r.matrix().cast<double>(), 
+                  .G     = std::move(G), 
+                  .h     = std::move(h), 
+                  .mixed = mixed });
+    }
+
+    // Print a histogram of values over decades, from 1e-16 to 1, as rows of counts and bars
+    void print_decade_histogram(std::span<const double> values) {
+      constexpr int n_bins = 8; // Bins of two decades each
+      std::array<uint, n_bins + 1> bins = { };
+      for (double v : values) {
+        int b = v <= 0.0 ? 0 : std::clamp(static_cast<int>(std::floor((std::log10(v) + 16.0) / 2.0)) + 1, 0, n_bins);
+        bins[b]++;
+      }
+      for (int b = 0; b <= n_bins; ++b) {
+        guard_continue(bins[b] > 0);
+        auto label = b == 0 ? std::string("          0") : fmt::format("[1e{:+03},1e{:+03})", 2 * b - 18, 2 * b - 16);
+        uint width = (60 * bins[b] + values.size() - 1) / values.size();
+        fmt::print("    {:>16} {:>6} {}\n", label, bins[b], std::string(width, '#'));
+      }
+    }
+  } // namespace detail
+
+  // Timing and accuracy harness for mixed-precision LP solves against double precision; runs 
+  // warm-started solves over random objectives, as mismatch volume sampling does, and prints
+  // timings and a histogram of relative objective errors per trial
+  met_test_case(lp_mixed_matches_double) {
+    using clock = std::chrono::steady_clock;
+    constexpr uint n_dirs = 4096;
+
+    const auto &basis = test::test_basis();
+    for (uint trial = 0; trial < 3; ++trial) {
+      auto csys_in  = test::test_csys(trial), csys_out = test::test_csys(trial + 1);
+      auto r        = test::test_reflectance(trial);
+      met_test_check((r >= 0.f).all() && (r <= 1.f).all());
+
+      auto lp_d = detail::init_test_lp(csys_in, r, false);
+      auto lp_m = detail::init_test_lp(csys_in, r, true);
+      met_test_check(lp_d.is_valid() && lp_m.is_valid() && lp_m.is_mixed());
+      guard_continue(lp_d.is_valid() && lp_m.is_valid());
+      
+      // Objectives; random directions in the output system's color space, mapped to coefficients
+      auto M = (basis.func.transpose() * csys_out.finalize(false)).cast<double>().eval();
+      UniformSampler<PCGEngine> sampler(-1.f, 1.f, trial);
+      std::vector<LP::vec> objectives(n_dirs);
+      for (auto &c : objectives)
+        c = M * sampler.next_nd<3>().matrix().normalized().cast<double>();
+
+      // Warm-started solve chain; returns results and mean time per solve in microseconds
+      auto run = [&](const LP &lp) {
+        std::vector<LP::Result> results(n_dirs);
+        auto state = lp.init();
+        auto start = clock::now();
+        for (uint i = 0; i < n_dirs; ++i) {
+          results[i] = lp.solve(objectives[i], state);
+          if (results[i].success)
+            state = results[i];
+        }
+        double us = std::chrono::duration<double, std::micro>(clock::now() - start).count() / n_dirs;
+        return std::pair { std::move(results), us };
+      };
+      run(lp_d); // warm-up
+      auto [results_d, us_d] = run(lp_d);
+      auto [results_m, us_m] = run(lp_m);
+
+      // Compare objective values; vertices may differ under ties, so solutions are not compared
+      uint n_success_d = 0, n_success_m = 0;
+      std::vector<double> errors;
+      for (uint i = 0; i < n_dirs; ++i) {
+        n_success_d += results_d[i].success;
+        n_success_m += results_m[i].success;
+        guard_continue(results_d[i].success && results_m[i].success);
+        double o_d = objectives[i].dot(results_d[i].x), o_m = objectives[i].dot(results_m[i].x);
+        errors.push_back(std::abs(o_d - o_m) / std::max(std::abs(o_d), 1.0));
+      }
+      
+      double max_error = errors.empty() ? 0.0 : rng::max(errors);
+      fmt::print("  trial {}: double {:.2f} us/solve, mixed {:.2f} us/solve, success {}/{} vs {}/{}, max rel. error {:.2e}\n",
+        trial, us_d, us_m, n_success_d, n_dirs, n_success_m, n_dirs, max_error);
+      detail::print_decade_histogram(errors);
+
+      met_test_check(n_success_m >= n_success_d);
+      met_test_check(max_error <= 1e-4);
+    } // for (uint trial)
+  }
+} // namespace met
\ No newline at end of file
@@ -0,0 +1,192 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <metameric/core/distribution.hpp>
+#include <metameric/core/metamer.hpp>
+#include <metameric/core/ranges.hpp>
+#include <spectral.hpp>
+#include <test.hpp>
+#include <volume.hpp>
+#include <array>
+#include <iterator>
+
+namespace met {
+  namespace detail {
+    // Direct mismatch volume setup; the color of a reference reflectance under one system is
+    // held fixed, and its possible colors under a second system are sampled
+    DirectMismatchSolidInfo init_test_mismatch(uint seed, uint n_samples) {
+      auto csys_i = test::test_csys(seed), csys_j = test::test_csys(seed + 1);
+      auto r      = test::test_reflectance(seed);
+      return { .linear_objectives  = { csys_i, csys_j },
+               .linear_constraints = {{ csys_i, csys_i.apply(r) }},
+               .basis              = test::test_basis(),
+               .n_samples          = n_samples };
+    }
+
+    std::vector<Colr> sample_colrs(std::span<const MismatchSample> samples) {
+      return samples | vws::transform(&MismatchSample::colr) | view_to<std::vector<Colr>>();
+    }
+  } // namespace detail
+
+  // The LP backend replaces per-direction SLSQP solves; it must produce the same mismatch volume, 
+  // and as it solves each direction exactly, its hull should not be smaller
+  met_test_case(mismatch_lp_matches_nlopt_volume) {
+    for (uint seed = 0; seed < 4; ++seed) {
+      auto info = detail::init_test_mismatch(seed, 256);
+
+      info.backend = DirectMismatchSolidInfo::Backend::eLP;
+      auto v_lp    = test::point_hull_volume(detail::sample_colrs(solve_mismatch_solid(info)));
+      info.backend = DirectMismatchSolidInfo::Backend::eNLopt;
+      auto v_nlopt = test::point_hull_volume(detail::sample_colrs(solve_mismatch_solid(info)));
+      
+      fmt::print("  seed {}: lp volume {:.4e}, nlopt volume {:.4e}\n", seed, v_lp, v_nlopt);
+      met_test_check(v_lp > 0.0);
+      met_test_check(v_lp >= .99 * v_nlopt);
+      met_test_check(std::abs(v_lp - v_nlopt) <= .05 * v_lp);
+    }
+  }
+
+  // The exact volume is enumerated facet by facet; every sampled support point must lie inside
+  // it, and dense sampling must approach its volume from below
+  met_test_case(mismatch_exact_encloses_samples) {
+    for (uint seed = 0; seed < 4; ++seed) {
+      auto info  = detail::init_test_mismatch(seed, 512);
+      auto exact = detail::sample_colrs(solve_mismatch_solid_exact(info));
+      auto samps = detail::sample_colrs(solve_mismatch_solid(info));
+      met_test_check(exact.size() >= 4);
+      guard_continue(exact.size() >= 4);
+
+      ConvexHull hull = {{ .data = exact, .options = ConvexHull::CreateInfo::BuildOptions::eHull }};
+      auto v_exact = test::hull_volume(hull.hull);
+      auto v_samps = test::point_hull_volume(samps);
+      fmt::print("  seed {}: exact volume {:.4e} ({} verts), sampled volume {:.4e}\n", 
+        seed, v_exact, exact.size(), v_samps);
+      
+      // Tolerance relative to the volume's extent
+      Colr minb = exact[0], maxb = exact[0];
+      for (const auto &c : exact) {
+        minb = minb.min(c);
+        maxb = maxb.max(c);
+      }
+      float tol = 1e-4f * (maxb - minb).maxCoeff();
+      met_test_check(rng::all_of(samps, [&](const auto &c) { return test::is_enclosed(hull.hull, c, tol); }));
+      met_test_check(v_samps <= v_exact * (1.0 + 1e-3));
+      met_test_check(v_samps >= v_exact * 0.95);
+    }
+  }
+
+  // Directions are a low-discrepancy sequence, s.t. the hull approaches the exact volume in fewer
+  // solves than under the previous, independently drawn directions; the latter are emulated by
+  // solving single directions at hashed offsets into the sequence, averaged over several draws
+  met_test_case(mismatch_volume_convergence) {
+    constexpr std::array<uint, 4> sample_counts = { 16, 32, 64, 128 };
+    constexpr uint n_seeds = 4, n_draws = 8;
+    std::array<double, sample_counts.size()> ratio_seq = { }, ratio_rnd = { };
+    
+    for (uint seed = 0; seed < n_seeds; ++seed) {
+      auto info    = detail::init_test_mismatch(seed, 0);
+      auto v_exact = test::point_hull_volume(detail::sample_colrs(solve_mismatch_solid_exact(info)));
+      met_test_check(v_exact > 0.0);
+      guard_continue(v_exact > 0.0);
+
+      // Sequence prefixes of n directions, starting where a vertex' running offset starts; prefixes
+      // are nested, so volume cannot shrink
+      double v_prev = 0.0;
+      for (uint i = 0; i < sample_counts.size(); ++i) {
+        info.seed      = 0;
+        info.n_samples = sample_counts[i];
+        auto v_seq = test::point_hull_volume(detail::sample_colrs(solve_mismatch_solid(info)));
+        met_test_check(v_seq >= v_prev * (1.0 - 1e-6));
+        v_prev        = v_seq;
+        ratio_seq[i] += v_seq / v_exact;
+      }
+
+      // Independent directions, extended to n
+      PCGEngine engine(seed);
+      for (uint draw = 0; draw < n_draws; ++draw) {
+        std::vector<Colr> colrs;
+        for (uint i = 0; i < sample_counts.size(); ++i) {
+          info.n_samples = 1;
+          while (colrs.size() < sample_counts[i]) {
+            info.seed = engine();
+            rng::copy(detail::sample_colrs(solve_mismatch_solid(info)), std::back_inserter(colrs));
+          }
+          ratio_rnd[i] += test::point_hull_volume(colrs) / (v_exact * n_draws);
+        }
+      }
+    }
+
+    // On average over seeds, the sequence covers more of the volume over the range of solve counts,
+    // and no count falls clearly behind independent directions
+    double area_seq = 0.0, area_rnd = 0.0;
+    for (uint i = 0; i < sample_counts.size(); ++i) {
+      fmt::print("  {} solves: sequence {:.4f}, independent {:.4f} of exact volume\n", 
+        sample_counts[i], ratio_seq[i] / n_seeds, ratio_rnd[i] / n_seeds);
+      met_test_check(ratio_seq[i] >= .95 * ratio_rnd[i]);
+      area_seq += ratio_seq[i];
+      area_rnd += ratio_rnd[i];
+    }
+    met_test_check(area_seq >= area_rnd);
+  }
+
+  // Nonlinear solves are seeded from their predecessor along the direction ordering; per accepted 
+  // sample, this must take fewer solver evaluations than cold starts, without losing samples
+  met_test_case(mismatch_warm_start_reduces_evals) {
+    auto run = [](std::string_view name, auto info) {
+      MismatchSolveStats stats_warm, stats_cold;
+      info.warm_start = true;
+      info.stats      = &stats_warm;
+      auto v_warm = test::point_hull_volume(detail::sample_colrs(solve_mismatch_solid(info)));
+      info.warm_start = false;
+      info.stats      = &stats_cold;
+      auto v_cold = test::point_hull_volume(detail::sample_colrs(solve_mismatch_solid(info)));
+
+      auto per_sample = [](const MismatchSolveStats &s) { 
+        return static_cast<double>(s.n_evals) / std::max(s.n_accepted, 1u); 
+      };
+      fmt::print("  {}: warm {:.2f} evals/sample ({} accepted), cold {:.2f} evals/sample ({} accepted)\n",
+        name, per_sample(stats_warm), stats_warm.n_accepted, per_sample(stats_cold), stats_cold.n_accepted);
+      met_test_check(stats_warm.n_accepted > 0 && stats_cold.n_accepted > 0);
+      met_test_check(per_sample(stats_warm) < per_sample(stats_cold));
+      met_test_check(stats_warm.n_accepted >= .95 * stats_cold.n_accepted);
+      met_test_check(v_warm >= .95 * v_cold);
+    };
+
+    for (uint seed = 0; seed < 2; ++seed) {
+      auto direct    = detail::init_test_mismatch(seed, 512);
+      direct.backend = DirectMismatchSolidInfo::Backend::eNLopt;
+      run("direct", direct);
+
+      auto csys = test::test_csys(seed);
+      IndirectColrSystem indirect_csys = { .cmfs = csys.cmfs, .powers = { csys.illuminant, .5f * csys.illuminant } };
+      run("indirect", IndirectMismatchSolidInfo {
+        .nlinear_objectives = { indirect_csys },
+        .linear_constraints = {{ csys, csys.apply(test::test_reflectance(seed)) }},
+        .basis              = test::test_basis(),
+        .n_samples          = 512
+      });
+    }
+  }
+
+  // A requested stop ends exact enumeration without output
+  met_test_case(mismatch_exact_stops) {
+    std::stop_source stop;
+    stop.request_stop();
+    auto info = detail::init_test_mismatch(0, 0);
+    info.stop = stop.get_token();
+    met_test_check(solve_mismatch_solid_exact(info).empty());
+  }
+} // namespace met
\ No newline at end of file
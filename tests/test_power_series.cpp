@@ -0,0 +1,124 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <metameric/core/detail/metamer.hpp>
+#include <metameric/core/distribution.hpp>
+#include <metameric/core/metamer.hpp>
+#include <spectral.hpp>
+#include <test.hpp>
+#include <chrono>
+#include <cmath>
+
+namespace met {
+  namespace detail {
+    using power_vec = eig::Vector<double, wavelength_bases>;
+    
+    // Random power series terms of the given order, decaying in magnitude with the power
+    template <int M>
+    std::vector<PowerSeriesTerm<M>> gen_power_series(uint order, uint seed) {
+      UniformSampler<PCGEngine> sampler(seed);
+      std::vector<PowerSeriesTerm<M>> A(order + 1);
+      for (uint p = 0; p <= order; ++p)
+        for (auto &a : A[p].reshaped())
+          a = (2.0 * sampler.next_1d() - 1.0) * std::pow(.5, static_cast<double>(p)) / wavelength_samples;
+      return A;
+    }
+
+    // Coefficients of a reference reflectance, s.t. Bx lies inside [0, 1]
+    power_vec gen_power_coef(uint seed) {
+      const auto &basis = test::test_basis();
+      Spec s = test::test_reflectance(seed);
+      return (basis.func.transpose() * basis.func).ldlt().solve(basis.func.transpose() * s.matrix()).cast<double>();
+    }
+
+    // Compare value and gradient of a function object against its autodiff oracle
+    void check_against_oracle(const auto &f, const auto &f_ad, const power_vec &x) {
+      power_vec g, g_ad;
+      double v    = f(eig::Map<const power_vec>(x.data()), eig::Map<power_vec>(g.data()));
+      double v_ad = f_ad(eig::Map<const power_vec>(x.data()), eig::Map<power_vec>(g_ad.data()));
+      met_test_check(std::abs(v - v_ad) <= 1e-9 * std::max(1.0, std::abs(v_ad)));
+      met_test_check((g - g_ad).norm() <= 1e-9 * std::max(1.0, g_ad.norm()));
+
+      // Value-only evaluation must agree with the evaluation that also writes the gradient
+      double v_only = f(eig::Map<const power_vec>(x.data()), eig::Map<power_vec>(nullptr));
+      met_test_check(v_only == v);
+    }
+  } // namespace detail
+
+  // Hand-derived power series gradients must match autodiff, for every series order in use
+  met_test_case(power_series_matches_autodiff) {
+    auto B = test::test_basis().func.cast<double>().eval();
+    for (uint order = 1; order <= 8; ++order) {
+      for (uint seed = 0; seed < 4; ++seed) {
+        auto x   = detail::gen_power_coef(seed);
+        auto x_b = detail::gen_power_coef(seed + 7);
+
+        detail::PowerSeriesDotFunc<> f_dot = { .A = detail::gen_power_series<1>(order, seed), .B = B };
+        detail::check_against_oracle(f_dot, detail::ad_power_series_dot(f_dot.A, f_dot.B), x);
+        
+        // Target b is the series' value elsewhere, s.t. the norm is away from its kink at zero
+        detail::PowerSeriesNormFunc<> f_norm = { .A = detail::gen_power_series<3>(order, seed + 1), .B = B };
+        auto [H, D] = detail::eval_power_series<3>(f_norm.A, B * x_b);
+        f_norm.b    = H.rowwise().sum().array();
+        detail::check_against_oracle(f_norm, detail::ad_power_series_norm(f_norm.A, f_norm.B, f_norm.b), x);
+      } // for (uint seed)
+    } // for (uint order)
+  }
+
+  // Time evaluation of the analytic and autodiff functions, and an indirect mismatch solve, per order
+  met_test_case(power_series_timing) {
+    using clock = std::chrono::steady_clock;
+    constexpr uint n_evals = 1000;
+    
+    auto us    = [](auto a, auto b) { return std::chrono::duration<double, std::micro>(b - a).count(); };
+    auto B     = test::test_basis().func.cast<double>().eval();
+    auto x     = detail::gen_power_coef(0);
+    auto r     = test::test_reflectance(0);
+    auto csys  = test::test_csys(0);
+    Spec illm  = test::test_csys(1).illuminant / test::test_csys(1).illuminant.maxCoeff();
+    for (uint order = 1; order <= 8; ++order) {
+      detail::PowerSeriesDotFunc<> f = { .A = detail::gen_power_series<1>(order, order), .B = B };
+      auto f_ad = detail::ad_power_series_dot(f.A, f.B);
+      
+      // Function and gradient evaluations
+      detail::power_vec g;
+      double sink = 0.0;
+      auto t_0 = clock::now();
+      for (uint i = 0; i < n_evals; ++i)
+        sink += f(eig::Map<const detail::power_vec>(x.data()), eig::Map<detail::power_vec>(g.data()));
+      auto t_1 = clock::now();
+      for (uint i = 0; i < n_evals; ++i)
+        sink += f_ad(eig::Map<const detail::power_vec>(x.data()), eig::Map<detail::power_vec>(g.data()));
+      auto t_2 = clock::now();
+      
+      // Indirect mismatch solve with an objective series of this order
+      IndirectColrSystem isys = { .cmfs = models::cmfs_cie_xyz };
+      for (uint p = 0; p < order; ++p)
+        isys.powers.push_back(illm * std::pow(.6f, static_cast<float>(p + 1)));
+      IndirectMismatchSolidInfo info = { .nlinear_objectives = { isys },
+                                         .linear_constraints = {{ csys, csys.apply(r) }},
+                                         .basis              = test::test_basis(),
+                                         .n_samples          = 32 };
+      auto t_3   = clock::now();
+      auto coefs = solve_mismatch_solid_coef(info);
+      auto t_4   = clock::now();
+      
+      fmt::print("  order {}: analytic {:.2f} us/eval, autodiff {:.2f} us/eval, solve {:.1f} us/sample\n",
+        order, us(t_0, t_1) / n_evals, us(t_1, t_2) / n_evals, us(t_3, t_4) / info.n_samples);
+      met_test_check(std::isfinite(sink));
+      met_test_check(!coefs.empty());
+    } // for (uint order)
+  }
+} // namespace met
\ No newline at end of file
@@ -0,0 +1,131 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <metameric/core/distribution.hpp>
+#include <metameric/core/ranges.hpp>
+#include <metameric/scene/detail/scheduler.hpp>
+#include <test.hpp>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace met {
+  namespace detail {
+    // Stand-in for a metamer builder with a known per-sample solve cost, which only becomes
+    // visible to the scheduler after its first job, as a measurement would
+    struct FakeBuilder {
+      float cost;
+      float measured    = 0.f;
+      uint  last_served = 0;
+      uint  n_jobs      = 0;
+    };
+
+    // Outcome of a single simulated frame
+    struct FrameRecord {
+      float work;        // Submitted solver time in ms
+      uint  n_jobs;      // Nr. of submitted jobs
+      bool  is_saturated; // Every builder was served at the maximum job size
+      bool  is_measured; // Every builder's cost was measured before the frame
+    };
+
+    constexpr BudgetScheduler::DispatchInfo test_dispatch_info(float budget) {
+      return { .budget = budget, .n_min = 4, .n_max = 64 };
+    }
+
+    // Run a nr. of frames over builders that always await a job, as jobs finish instantly;
+    // the first n_edited builders are flagged as being edited
+    std::vector<FrameRecord> simulate(std::vector<FakeBuilder> &builders, float budget, uint n_frames, uint n_edited = 0) {
+      BudgetScheduler scheduler;
+      std::vector<FrameRecord> frames;
+      for (uint f = 0; f < n_frames; ++f) {
+        FrameRecord frame = { .work = 0.f, .n_jobs = 0, .is_saturated = true, 
+                              .is_measured = rng::all_of(builders, [](const auto &b) { return b.measured > 0.f; }) };
+        std::vector<BudgetScheduler::Request> requests;
+        for (uint i = 0; i < builders.size(); ++i) {
+          auto &b = builders[i];
+          requests.push_back({ .sample_cost = b.measured, 
+                               .last_served = b.last_served, 
+                               .is_edited   = i < n_edited,
+                               .submit      = [&b, &frame](uint n, uint frame_i) {
+            frame.work  += static_cast<float>(n) * b.cost;
+            frame.n_jobs++;
+            b.measured    = b.cost;
+            b.last_served = frame_i;
+            b.n_jobs++;
+          }});
+        }
+        scheduler.dispatch(requests, test_dispatch_info(budget));
+        frame.is_saturated = frame.n_jobs == builders.size() 
+                          && frame.work >= .999f * rng::fold_left(builders | vws::transform(&FakeBuilder::cost), 0.f, std::plus<float>()) * 64.f;
+        frames.push_back(frame);
+      }
+      return frames;
+    }
+
+    std::vector<FakeBuilder> gen_builders(uint n, float cost_min, float cost_max, uint seed) {
+      UniformSampler<PCGEngine> sampler(cost_min, cost_max, seed);
+      std::vector<FakeBuilder> builders(n);
+      for (auto &b : builders)
+        b.cost = sampler.next_1d();
+      return builders;
+    }
+  } // namespace detail
+
+  // Once costs are measured, submitted work per frame stays within 10% of the budget, 
+  // independent of the nr. of builders, unless there is too little work to fill it
+  met_test_case(scheduler_stays_within_budget) {
+    for (float budget : { 2.f, 8.f, 32.f }) {
+      for (uint n_builders : { 4u, 32u, 256u }) {
+        auto builders = detail::gen_builders(n_builders, .02f, .1f, n_builders);
+        auto frames   = detail::simulate(builders, budget, 2048);
+
+        float work_min = std::numeric_limits<float>::max(), work_max = 0.f;
+        uint  n_checked = 0;
+        for (const auto &frame : frames) {
+          guard_continue(frame.is_measured && !frame.is_saturated);
+          work_min = std::min(work_min, frame.work);
+          work_max = std::max(work_max, frame.work);
+          n_checked++;
+        }
+        met_test_check(rng::all_of(builders, [](const auto &b) { return b.measured > 0.f; }));
+        guard_continue(n_checked > 0);
+        fmt::print("  budget {:4.1f} ms, {:3} builders: {:4} frames checked, work in [{:.3f}, {:.3f}] ms\n", 
+          budget, n_builders, n_checked, work_min, work_max);
+        met_test_check(work_min >= .9f * budget);
+        met_test_check(work_max <= 1.1f * budget);
+      }
+    }
+  }
+
+  // Builders are served round-robin; over enough frames, job counts even out, as the nr. of jobs
+  // per frame varies with the served builders' costs
+  met_test_case(scheduler_serves_round_robin) {
+    auto builders = detail::gen_builders(64, .02f, .1f, 4);
+    detail::simulate(builders, 8.f, 1024);
+    auto [min_jobs, max_jobs] = rng::minmax(builders | vws::transform(&detail::FakeBuilder::n_jobs));
+    fmt::print("  jobs per builder in [{}, {}]\n", min_jobs, max_jobs);
+    met_test_check(min_jobs > 0);
+    met_test_check(max_jobs <= min_jobs * 1.1f);
+  }
+
+  // Edited builders are served on every frame, even if they exceed the budget on their own
+  met_test_case(scheduler_serves_edited) {
+    auto builders = detail::gen_builders(64, .02f, .1f, 8);
+    builders[0].cost = builders[1].cost = 1.f;
+    detail::simulate(builders, 2.f, 256, 2);
+    met_test_check(builders[0].n_jobs == 256);
+    met_test_check(builders[1].n_jobs == 256);
+  }
+} // namespace met
\ No newline at end of file
@@ -0,0 +1,248 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <metameric/core/distribution.hpp>
+#include <metameric/core/metamer.hpp>
+#include <metameric/core/ranges.hpp>
+#include <spectral.hpp>
+#include <test.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace met {
+  namespace detail {
+    // Objective shared by both backends; ||Bx - mean||^2, with mean the target's clamped luminance
+    double direct_objective(const DirectSpectrumInfo &info, const Basis::vec_type &x) {
+      Spec mean = Spec(luminance(info.linear_constraints[0].second)).cwiseMin(1.f);
+      return (info.basis.func * x - mean.matrix()).cast<double>().squaredNorm();
+    }
+
+    // Largest error in reproducing the constraint colors
+    double direct_roundtrip_error(const DirectSpectrumInfo &info, const Basis::vec_type &x) {
+      double err = 0.0;
+      for (const auto &[csys, colr] : info.linear_constraints) {
+        Colr c = csys.finalize(false).transpose() * (info.basis.func * x);
+        err = std::max<double>(err, (c - lrgb_to_xyz(colr)).abs().maxCoeff());
+      }
+      return err;
+    }
+    // Random coefficients, some of which exceed the basis' [0, 1] range, s.t. clamping is exercised
+    std::vector<Basis::vec_type> gen_coefs(uint n, uint seed) {
+      UniformSampler<PCGEngine> sampler(-1.f, 1.f, seed);
+      std::vector<Basis::vec_type> cs(n);
+      for (auto &c : cs)
+        c = sampler.template next_nd<wavelength_bases>().matrix();
+      return cs;
+    }
+  } // namespace detail
+
+  // The QP backend must find the same boundary spectra as NLopt's SLSQP, which it replaces; it 
+  // solves exactly, so it reproduces constraints at least as well and is never worse in objective
+  met_test_case(direct_qp_matches_nlopt) {
+    using clock = std::chrono::steady_clock;
+    
+    const auto &basis = test::test_basis();
+    double t_qp = 0.0, t_nlopt = 0.0;
+    uint   n_solves = 0;
+    for (uint seed = 0; seed < 16; ++seed) {
+      for (uint n_cstr = 1; n_cstr <= 2; ++n_cstr) {
+        // Constraints are the colors of a single reference reflectance, s.t. they are feasible
+        auto r = test::test_reflectance(seed);
+        DirectSpectrumInfo info = { .basis = basis };
+        for (uint i = 0; i < n_cstr; ++i) {
+          auto csys = test::test_csys(seed + i);
+          info.linear_constraints.push_back({ csys, csys.apply(r) });
+        }
+
+        auto start = clock::now();
+        info.backend = DirectSpectrumInfo::Backend::eQP;
+        auto x_qp    = solve_spectrum_coef(info);
+        auto mid     = clock::now();
+        info.backend = DirectSpectrumInfo::Backend::eNLopt;
+        auto x_nlopt = solve_spectrum_coef(info);
+        t_qp    += std::chrono::duration<double, std::micro>(mid - start).count();
+        t_nlopt += std::chrono::duration<double, std::micro>(clock::now() - mid).count();
+        n_solves++;
+
+        // Both produce valid reflectances that reproduce the constraints
+        Spec s_qp = basis.func * x_qp, s_nlopt = basis.func * x_nlopt;
+        met_test_check((s_qp >= -1e-4f).all() && (s_qp <= 1.f + 1e-4f).all());
+        met_test_check(detail::direct_roundtrip_error(info, x_qp) <= 1e-4);
+        met_test_check(detail::direct_roundtrip_error(info, x_nlopt) <= 1e-2);
+
+        // Same boundary point up to NLopt's tolerances, and never worse in objective
+        met_test_check((s_qp - s_nlopt).abs().maxCoeff() <= 2e-2f);
+        met_test_check(detail::direct_objective(info, x_qp) <= detail::direct_objective(info, x_nlopt) + 1e-4);
+      } // for (uint n_cstr)
+    } // for (uint seed)
+
+    fmt::print("  qp {:.1f} us/solve, nlopt {:.1f} us/solve\n", t_qp / n_solves, t_nlopt / n_solves);
+  }
+  // The batched solver must match per-color solves of the eQP backend, which it accelerates; colors 
+  // are mixed and scaled reference reflectances, s.t. part of them lies near the solid's boundary
+  // and takes the QP path instead of the closed form
+  met_test_case(direct_batch_matches_qp) {
+    using clock = std::chrono::steady_clock;
+    constexpr uint n_colrs = 4096;
+
+    const auto &basis = test::test_basis();
+    auto csys = test::test_csys(0);
+    std::vector<Colr> colrs(n_colrs);
+    for (uint i = 0; i < n_colrs; ++i) {
+      float t = static_cast<float>(i % 97) / 96.f, 
+            a = .5f + .4f * static_cast<float>(i % 13);
+      colrs[i] = csys.apply(a * ((1.f - t) * test::test_reflectance(i) + t * test::test_reflectance(i / 7)));
+    }
+    
+    auto start   = clock::now();
+    auto x_batch = solve_spectrum_coef(DirectSpectrumBatchInfo { .csys = csys, .colrs = colrs, .basis = basis });
+    auto mid     = clock::now();
+    std::vector<Basis::vec_type> x_qp(n_colrs);
+    for (uint i = 0; i < n_colrs; ++i)
+      x_qp[i] = solve_spectrum_coef(DirectSpectrumInfo { .linear_constraints = {{ csys, colrs[i] }}, .basis = basis });
+    auto end = clock::now();
+
+    met_test_check(x_batch.size() == n_colrs);
+    guard(x_batch.size() == n_colrs);
+    float err = 0.f;
+    for (uint i = 0; i < n_colrs; ++i)
+      err = std::max(err, (basis.func * x_batch[i] - basis.func * x_qp[i]).array().abs().maxCoeff());
+    met_test_check(err <= 1e-4f);
+
+    auto us = [](auto a, auto b) { return std::chrono::duration<double, std::micro>(b - a).count() / n_colrs; };
+    fmt::print("  batch {:.1f} us/color, per-color qp {:.1f} us/color, max. spectral error {:.1e}\n",
+      us(start, mid), us(mid, end), err);
+  }
+
+  // An observer with linearly dependent channels makes the batched solver's KKT system singular;
+  // it must then skip the closed form, and agree with per-color solves
+  met_test_case(direct_batch_degenerate_csys) {
+    constexpr uint n_colrs = 64;
+
+    const auto &basis = test::test_basis();
+    auto csys = test::test_csys(0);
+    csys.cmfs.col(2) = csys.cmfs.col(1);
+    std::vector<Colr> colrs(n_colrs);
+    for (uint i = 0; i < n_colrs; ++i)
+      colrs[i] = csys.apply(test::test_reflectance(i));
+
+    auto x_batch = solve_spectrum_coef(DirectSpectrumBatchInfo { .csys = csys, .colrs = colrs, .basis = basis });
+    met_test_check(x_batch.size() == n_colrs);
+    guard(x_batch.size() == n_colrs);
+    for (uint i = 0; i < n_colrs; ++i) {
+      auto x_single = solve_spectrum_coef(DirectSpectrumInfo { .linear_constraints = {{ csys, colrs[i] }}, .basis = basis });
+      met_test_check(x_batch[i].array().isFinite().all());
+      met_test_check((basis.func * x_batch[i] - basis.func * x_single).array().abs().maxCoeff() <= 1e-4f);
+    }
+  }
+
+  // Batched and span applies must match per-spectrum applies, column by column and in order; 
+  // duplicated inputs must yield duplicated outputs, as the span overloads no longer collapse them
+  met_test_case(batch_apply_matches_single) {
+    const auto &basis = test::test_basis();
+    auto cs = detail::gen_coefs(1031, 4);         // Not a multiple of any block size
+    std::copy_n(cs.begin(), 16, cs.end() - 16); // Duplicates at the tail
+
+    // Basis; span, float and double batches
+    auto sd = basis.apply(cs);
+    eig::MatrixXf cs_f(wavelength_bases, cs.size()), sd_f(wavelength_samples, cs.size());
+    for (uint i = 0; i < cs.size(); ++i)
+      cs_f.col(i) = cs[i];
+    eig::MatrixXd cs_d = cs_f.cast<double>(), sd_d(wavelength_samples, cs.size());
+    basis.apply(cs_f, sd_f);
+    basis.apply(cs_d, sd_d);
+    met_test_check(sd.size() == cs.size());
+    float err_basis = 0.f;
+    for (uint i = 0; i < cs.size(); ++i) {
+      Spec s = basis.apply(cs[i]);
+      err_basis = std::max({ err_basis, (sd[i] - s).abs().maxCoeff(),
+                                        (sd_f.col(i).array() - s).abs().maxCoeff(),
+                                        (sd_d.col(i).cast<float>().array() - s).abs().maxCoeff() });
+    }
+    met_test_check(err_basis <= 1e-5f);
+
+    // Color systems; span, float and double batches, as rgb and as xyz
+    float err_csys = 0.f, err_ind = 0.f;
+    for (bool as_rgb : { true, false }) {
+      auto csys = test::test_csys(1);
+      auto cl   = csys.apply(sd, as_rgb);
+      eig::MatrixXf cl_f(3, sd.size());
+      eig::MatrixXd cl_d(3, sd.size());
+      csys.apply(sd_f, cl_f, as_rgb);
+      csys.apply(sd_f.cast<double>().eval(), cl_d, as_rgb);
+      met_test_check(cl.size() == sd.size());
+      met_test_check(rng::equal(cl.end() - 16, cl.end(), cl.begin(), cl.begin() + 16, 
+                                [](const Colr &a, const Colr &b) { return (a == b).all(); }));
+      for (uint i = 0; i < sd.size(); ++i) {
+        Colr c = csys.apply(sd[i], as_rgb);
+        float scale = std::max(c.abs().maxCoeff(), 1e-3f);
+        err_csys = std::max({ err_csys, (cl[i] - c).abs().maxCoeff() / scale,
+                                        (cl_f.col(i).array() - c).abs().maxCoeff() / scale,
+                                        (cl_d.col(i).cast<float>().array() - c).abs().maxCoeff() / scale });
+      }
+
+      IndirectColrSystem ind = { .cmfs = csys.cmfs, .powers = { csys.illuminant, .5f * csys.illuminant, .25f * csys.illuminant } };
+      auto ci = ind.apply(sd, as_rgb);
+      met_test_check(ci.size() == sd.size());
+      for (uint i = 0; i < sd.size(); ++i) {
+        Colr c = ind.apply(sd[i], as_rgb);
+        err_ind = std::max(err_ind, (ci[i] - c).abs().maxCoeff() / std::max(c.abs().maxCoeff(), 1e-3f));
+      }
+    }
+    met_test_check(err_csys <= 1e-5f);
+    met_test_check(err_ind  <= 1e-5f);
+    
+    fmt::print("  max. error; basis {:.1e}, color system {:.1e}, indirect {:.1e}\n", err_basis, err_csys, err_ind);
+  }
+
+  // Throughput of batched applies against per-spectrum applies; large batches are streamed through
+  // fixed-size buffers, s.t. the 10M case fits in memory
+  met_test_case(batch_apply_timing) {
+    using clock = std::chrono::steady_clock;
+    constexpr uint n_chunk = 1u << 20;
+    
+    const auto &basis = test::test_basis();
+    auto csys = test::test_csys(0);
+    for (uint n : { 1'000u, 100'000u, 10'000'000u }) {
+      uint n_buffer = std::min(n, n_chunk);
+      eig::MatrixXf cs(wavelength_bases, n_buffer), sd(wavelength_samples, n_buffer), cl(3, n_buffer);
+      cs.setRandom();
+
+      double t_basis = 0.0, t_csys = 0.0, t_single = 0.0, checksum = 0.0;
+      for (uint offs = 0; offs < n; offs += n_buffer) {
+        uint n_block = std::min(n_buffer, n - offs);
+        auto start = clock::now();
+        basis.apply(cs.leftCols(n_block), sd.leftCols(n_block));
+        auto mid   = clock::now();
+        csys.apply(sd.leftCols(n_block), cl.leftCols(n_block));
+        auto end   = clock::now();
+        for (uint i = 0; i < n_block; ++i)
+          cl.col(i) = csys.apply(basis.apply(cs.col(i))).matrix();
+        auto end_single = clock::now();
+
+        checksum += cl.leftCols(n_block).sum();
+        t_basis  += std::chrono::duration<double, std::milli>(mid - start).count();
+        t_csys   += std::chrono::duration<double, std::milli>(end - mid).count();
+        t_single += std::chrono::duration<double, std::milli>(end_single - end).count();
+      }
+
+      met_test_check(std::isfinite(checksum));
+      fmt::print("  n = {:8}: batched basis {:8.2f} ms, batched color system {:8.2f} ms, per-spectrum both {:8.2f} ms\n",
+        n, t_basis, t_csys, t_single);
+    }
+  }
+} // namespace met
\ No newline at end of file
@@ -0,0 +1,116 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <metameric/core/metamer.hpp>
+#include <metameric/core/ranges.hpp>
+#include <spectral.hpp>
+#include <test.hpp>
+#include <omp.h>
+#include <bit>
+#include <cstdint>
+
+namespace met {
+  namespace detail {
+    // FNV-1a hash over the bit patterns of all coefficients, in output order
+    uint64_t hash_coefs(std::span<const Basis::vec_type> coefs) {
+      uint64_t h = 0xcbf29ce484222325ull;
+      for (const auto &c : coefs) {
+        for (float f : c) {
+          h ^= std::bit_cast<uint32_t>(f);
+          h *= 0x100000001b3ull;
+        }
+      }
+      return h;
+    }
+
+    // Run a solve under 1, 2, and 8 threads; outputs must be bitwise identical, in the same order
+    void check_thread_invariance(std::string_view name, auto solve) {
+      int n_threads_prev = omp_get_max_threads();
+      std::vector<uint64_t> hashes;
+      for (int n_threads : { 1, 2, 8 }) {
+        omp_set_num_threads(n_threads);
+        auto coefs = solve();
+        hashes.push_back(hash_coefs(coefs));
+        fmt::print("  {}: {} threads, {} outputs, hash {:016x}\n", name, n_threads, coefs.size(), hashes.back());
+        met_test_check(!coefs.empty());
+      }
+      omp_set_num_threads(n_threads_prev);
+      met_test_check(rng::all_of(hashes, [&](uint64_t h) { return h == hashes.front(); }));
+    }
+  } // namespace detail
+
+  // Parallel solves write output by direction index, and draw no random numbers; their output must 
+  // not depend on the nr. of threads, or on how directions are scheduled across them
+  met_test_case(color_solid_thread_invariant) {
+    ColorSolidInfo info = { .direct_objective = test::test_csys(0), .basis = test::test_basis(), .n_samples = 256 };
+    detail::check_thread_invariance("color solid", [&] { return solve_color_solid_coef(info); });
+  }
+
+  met_test_case(mismatch_solid_thread_invariant) {
+    auto r      = test::test_reflectance(1);
+    auto csys_i = test::test_csys(0), csys_j = test::test_csys(1);
+    DirectMismatchSolidInfo info = { .linear_objectives  = { csys_i, csys_j },
+                                     .linear_constraints = {{ csys_i, csys_i.apply(r) }},
+                                     .basis              = test::test_basis(),
+                                     .n_samples          = 256 };
+    
+    info.backend = DirectMismatchSolidInfo::Backend::eLP;
+    detail::check_thread_invariance("direct lp", [&] { return solve_mismatch_solid_coef(info); });
+    detail::check_thread_invariance("direct exact", [&] { return solve_mismatch_solid_exact_coef(info); });
+    info.backend   = DirectMismatchSolidInfo::Backend::eNLopt;
+    info.n_samples = 64;
+    detail::check_thread_invariance("direct nlopt", [&] { return solve_mismatch_solid_coef(info); });
+  }
+
+  // Nonlinear solves are warm-started from their predecessor within a run; as runs are sized by
+  // the nr. of directions only, the solver's work must not depend on the nr. of threads either
+  met_test_case(mismatch_solid_warm_start_thread_invariant) {
+    auto r      = test::test_reflectance(3);
+    auto csys_i = test::test_csys(1), csys_j = test::test_csys(2);
+    MismatchSolveStats stats;
+    DirectMismatchSolidInfo info = { .linear_objectives  = { csys_i, csys_j },
+                                     .linear_constraints = {{ csys_i, csys_i.apply(r) }},
+                                     .basis              = test::test_basis(),
+                                     .n_samples          = 256,
+                                     .backend            = DirectMismatchSolidInfo::Backend::eNLopt,
+                                     .stats              = &stats };
+
+    int n_threads_prev = omp_get_max_threads();
+    std::vector<uint> evals;
+    for (int n_threads : { 1, 2, 8 }) {
+      omp_set_num_threads(n_threads);
+      solve_mismatch_solid_coef(info);
+      evals.push_back(stats.n_evals);
+      fmt::print("  {} threads, {} evaluations\n", n_threads, stats.n_evals);
+    }
+    omp_set_num_threads(n_threads_prev);
+    met_test_check(evals.front() > 0);
+    met_test_check(rng::all_of(evals, [&](uint i) { return i == evals.front(); }));
+  }
+
+  met_test_case(indirect_mismatch_solid_thread_invariant) {
+    auto r    = test::test_reflectance(2);
+    auto csys = test::test_csys(0);
+    
+    Spec illm = csys.illuminant / csys.illuminant.maxCoeff();
+    IndirectColrSystem isys = { .cmfs = models::cmfs_cie_xyz, .powers = { illm * .6f, illm * .36f, illm * .216f } };
+    IndirectMismatchSolidInfo info = { .nlinear_objectives = { isys },
+                                       .linear_constraints = {{ csys, csys.apply(r) }},
+                                       .basis              = test::test_basis(),
+                                       .n_samples          = 64 };
+    detail::check_thread_invariance("indirect", [&] { return solve_mismatch_solid_coef(info); });
+  }
+} // namespace met
\ No newline at end of file
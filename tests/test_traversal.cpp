@@ -0,0 +1,112 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <metameric/core/distribution.hpp>
+#include <metameric/scene/detail/bvh.hpp>
+#include <metameric/scene/detail/traversal.hpp>
+#include <test.hpp>
+
+namespace met {
+  namespace detail {
+    // Random rays through the unit cube; some start inside, and some miss it entirely
+    std::vector<RayRecord> gen_rays(uint n, uint seed) {
+      UniformSampler<PCGEngine> sampler(seed);
+      std::vector<RayRecord> rays(n);
+      for (auto &ray : rays) {
+        eig::Array3f o = sampler.next_nd<3>() * 3.f - 1.f,
+                     p = sampler.next_nd<3>();
+        ray = { .o = o, .t = std::numeric_limits<float>::max(), .d = (p - o).matrix().normalized() };
+      }
+      return rays;
+    }
+
+    // Random triangle soup inside the unit cube
+    Mesh gen_mesh(uint n, uint seed) {
+      UniformSampler<PCGEngine> sampler(seed);
+      Mesh mesh;
+      for (uint i = 0; i < n; ++i) {
+        eig::Array3f c = sampler.next_nd<3>() * .9f + .05f;
+        for (uint j = 0; j < 3; ++j)
+          mesh.verts.push_back(c + (sampler.next_nd<3>() - .5f) * .1f);
+        mesh.elems.push_back(eig::Array3u(3 * i, 3 * i + 1, 3 * i + 2));
+      }
+      return mesh;
+    }
+
+    // Random node with 1-8 children inside the unit cube, as packed nodes expect
+    BVH<8>::Node gen_node(UniformSampler<PCGEngine> &sampler) {
+      BVH<8>::Node node = { .type = false, .offset = 0, .size = 1 + static_cast<uint>(sampler.next_1d() * 8.f) % 8 };
+      for (uint i = 0; i < node.size; ++i) {
+        eig::Array3f a = sampler.next_nd<3>(), b = sampler.next_nd<3>();
+        node.child_aabb[i] = { .minb = a.min(b), .maxb = a.max(b) };
+        node.child_mask[i] = false;
+      }
+      return node;
+    }
+  } // namespace detail
+
+  // Child box tests must flag the same children with and without AVX2, for unpacked and packed nodes
+  met_test_case(traversal_avx2_matches_scalar_masks) {
+    if (!detail::traversal_supports_avx2()) {
+      fmt::print("  skipped; AVX2 is not supported by this build or cpu\n");
+      return;
+    }
+
+    UniformSampler<PCGEngine> sampler(1);
+    auto rays = detail::gen_rays(256, 2);
+    uint n_hits = 0;
+    for (uint i = 0; i < 256; ++i) {
+      auto node = detail::gen_node(sampler);
+      auto pack = detail::pack(node);
+      for (auto ray : rays) {
+        ray.t = sampler.next_1d() * 4.f; // Also test against partial ray extents
+        uint mask = detail::ray_intersect_aabb_mask(ray, node, detail::TraversalISA::eScalar);
+        met_test_check(mask == detail::ray_intersect_aabb_mask(ray, node, detail::TraversalISA::eAVX2));
+        met_test_check(detail::ray_intersect_aabb_mask(ray, pack, detail::TraversalISA::eScalar)
+                    == detail::ray_intersect_aabb_mask(ray, pack, detail::TraversalISA::eAVX2));
+        n_hits += std::popcount(mask);
+      }
+    }
+    met_test_check(n_hits > 0);
+  }
+
+  // Closest-hit and any-hit traversal must find the same hits with and without AVX2
+  met_test_case(traversal_avx2_matches_scalar_hits) {
+    if (!detail::traversal_supports_avx2()) {
+      fmt::print("  skipped; AVX2 is not supported by this build or cpu\n");
+      return;
+    }
+
+    auto mesh = detail::gen_mesh(4096, 3);
+    auto rays = detail::gen_rays(4096, 4);
+    detail::BVH<8> bvh = {{ .mesh = mesh }};
+    
+    uint n_hits = 0;
+    for (const auto &ray : rays) {
+      RayRecord ray_scalar = ray, ray_avx2 = ray;
+      bool hit_scalar = detail::ray_intersect(ray_scalar, bvh, mesh, detail::TraversalISA::eScalar),
+           hit_avx2   = detail::ray_intersect(ray_avx2,   bvh, mesh, detail::TraversalISA::eAVX2);
+      met_test_check(hit_scalar == hit_avx2);
+      met_test_check(ray_scalar.t == ray_avx2.t);
+      met_test_check(ray_scalar.record.data == ray_avx2.record.data);
+      met_test_check(detail::ray_intersect_any(ray, bvh, mesh, detail::TraversalISA::eScalar) 
+                  == detail::ray_intersect_any(ray, bvh, mesh, detail::TraversalISA::eAVX2));
+      n_hits += hit_scalar;
+    }
+    fmt::print("  {} of {} rays hit\n", n_hits, rays.size());
+    met_test_check(n_hits > 0);
+  }
+} // namespace met
\ No newline at end of file
@@ -0,0 +1,139 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <metameric/core/worker.hpp>
+#include <test.hpp>
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <stdexcept>
+
+namespace met {
+  namespace detail {
+    // Spin until the predicate holds, or give up after a generous timeout
+    bool wait_for(auto &&pred, std::chrono::milliseconds timeout = std::chrono::seconds(10)) {
+      auto t_end = std::chrono::steady_clock::now() + timeout;
+      while (!pred()) {
+        guard(std::chrono::steady_clock::now() < t_end, false);
+        std::this_thread::yield();
+      }
+      return true;
+    }
+  } // namespace detail
+
+  met_test_case(worker_runs_all_jobs) {
+    std::atomic<uint> n = 0;
+    WorkerPool pool(4);
+    for (uint i = 0; i < 1000; ++i)
+      pool.submit([&n] { n++; });
+    met_test_check(detail::wait_for([&] { return n == 1000; }));
+    met_test_check(pool.n_queued() == 0);
+  }
+
+  met_test_case(worker_survives_throwing_job) {
+    std::atomic<uint> n = 0;
+    WorkerPool pool(1);
+    pool.submit([]   { throw std::runtime_error("expected failure"); });
+    pool.submit([&n] { n++; });
+    met_test_check(detail::wait_for([&] { return n == 1; }));
+  }
+
+  met_test_case(worker_destroy_drops_pending) {
+    std::atomic<bool> started = false, release = false;
+    std::atomic<uint> n = 0;
+    {
+      WorkerPool pool(1);
+      pool.submit([&] { started = true; while (!release) std::this_thread::yield(); });
+      for (uint i = 0; i < 100; ++i)
+        pool.submit([&n] { n++; });
+      met_test_check(detail::wait_for([&] { return started.load(); }));
+
+      // Release the running job only once the destructor is underway
+      std::jthread releaser([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        release = true;
+      });
+    } // releaser joins first, then the pool
+    met_test_check(n == 0);
+  }
+
+  met_test_case(worker_move_assign_joins_old_threads) {
+    std::atomic<bool> release = false;
+    std::atomic<uint> n_old = 0, n_new = 0;
+
+    WorkerPool pool(2);
+    for (uint i = 0; i < 2; ++i)
+      pool.submit([&] { while (!release) std::this_thread::yield(); n_old++; });
+    for (uint i = 0; i < 100; ++i)
+      pool.submit([&] { n_old++; });
+    
+    // Move-assign while the old workers are busy; old jobs finish, old queue is dropped
+    std::jthread releaser([&] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      release = true;
+    });
+    pool = WorkerPool(2);
+    met_test_check(n_old == 2);
+
+    // The replacement pool is fully functional
+    for (uint i = 0; i < 100; ++i)
+      pool.submit([&] { n_new++; });
+    met_test_check(detail::wait_for([&] { return n_new == 100; }));
+    met_test_check(n_old == 2);
+    
+    // Moved-from pools are inert
+    WorkerPool other = std::move(pool);
+    met_test_check(pool.n_threads() == 0);
+    met_test_check(pool.n_queued()  == 0);
+    met_test_check(other.n_threads() == 2);
+  }
+
+  met_test_case(worker_drops_stale_jobs) {
+    // Mirrors MetamerBuilder's mailbox; jobs capture the generation at submission, and 
+    // skip their work or result if the generation moved on in the meantime
+    struct Mailbox {
+      std::mutex              mutex;
+      std::atomic<uint>       generation = 0;
+      std::optional<uint>     ready;
+    } mailbox;
+    std::atomic<bool> release = false;
+    std::atomic<uint> n_done  = 0, n_work = 0;
+
+    WorkerPool pool(1);
+    pool.submit([&] { while (!release) std::this_thread::yield(); });
+    for (uint i = 0; i < 16; ++i) {
+      {
+        std::lock_guard lock(mailbox.mutex);
+        mailbox.generation++;
+        mailbox.ready = std::nullopt;
+      }
+      pool.submit([&mailbox, &n_done, &n_work, generation = mailbox.generation.load(), i] {
+        if (mailbox.generation == generation) {
+          n_work++;
+          std::lock_guard lock(mailbox.mutex);
+          if (mailbox.generation == generation)
+            mailbox.ready = i;
+        }
+        n_done++;
+      });
+    }
+    release = true;
+
+    met_test_check(detail::wait_for([&] { return n_done == 16; }));
+    met_test_check(n_work == 1);
+    met_test_check(mailbox.ready && *mailbox.ready == 15);
+  }
+} // namespace met
\ No newline at end of file
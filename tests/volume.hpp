@@ -0,0 +1,68 @@
+// Copyright (C) 2024 Mark van de Ruit, Delft University of Technology.
+// 
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <metameric/core/convex.hpp>
+#include <metameric/core/mesh.hpp>
+#include <cmath>
+
+namespace met::test {
+  // Volume enclosed by a closed, outward-oriented triangle mesh
+  template <typename Vt>
+  double hull_volume(const MeshBase<Vt, eig::Array3u> &mesh) {
+    double v = 0.0;
+    for (const auto &el : mesh.elems) {
+      eig::Vector3d a = mesh.verts[el[0]].matrix().template cast<double>(), 
+                    b = mesh.verts[el[1]].matrix().template cast<double>(), 
+                    c = mesh.verts[el[2]].matrix().template cast<double>();
+      v += a.dot(b.cross(c)) / 6.0;
+    }
+    return v;
+  }
+
+  // Volume covered by a tetrahedral mesh
+  template <typename Vt>
+  double deln_volume(const MeshBase<Vt, eig::Array4u> &mesh) {
+    double v = 0.0;
+    for (const auto &el : mesh.elems) {
+      eig::Vector3d d = mesh.verts[el[3]].matrix().template cast<double>();
+      eig::Matrix3d m;
+      for (uint k = 0; k < 3; ++k)
+        m.col(k) = mesh.verts[el[k]].matrix().template cast<double>() - d;
+      v += std::abs(m.determinant()) / 6.0;
+    }
+    return v;
+  }
+
+  // Volume of the convex hull over a set of points, through qhull; zero for degenerate sets
+  inline double point_hull_volume(std::span<const Colr> points) {
+    guard(points.size() >= 4, 0.0);
+    ConvexHull hull = {{ .data = points, .options = ConvexHull::CreateInfo::BuildOptions::eHull }};
+    return hull_volume(hull.hull);
+  }
+
+  // Test whether a point lies inside a closed, outward-oriented triangle mesh, up to tolerance
+  template <typename Vt>
+  bool is_enclosed(const MeshBase<Vt, eig::Array3u> &mesh, const eig::Array3f &p, float tol = 1e-4f) {
+    for (const auto &el : mesh.elems) {
+      eig::Vector3f a = mesh.verts[el[0]], b = mesh.verts[el[1]], c = mesh.verts[el[2]];
+      eig::Vector3f n = (b - a).cross(c - a).normalized();
+      guard(n.dot(p.matrix() - a) <= tol, false);
+    }
+    return true;
+  }
+} // namespace met::test
\ No newline at end of file